@@ -136,7 +136,7 @@ static void huge _pascal CgiCliFunction(rpCgiPtr CgiRequest){
             else if(rw == 'r'){
                 CO_SDOclient_return_t ret;
                 CO_SDOclient_setup(SDO_C, 0, 0, nodeId);
-                CO_SDOclientUploadInitiate(SDO_C, idx, sidx, data, CgiCli->SDOBufSize, 1);
+                CO_SDOclientUploadInitiate(SDO_C, idx, sidx, data, CgiCli->SDOBufSize, 1, 0);
                 do{
                     uint16_t dt = 50;
                     ret = CO_SDOclientUpload(SDO_C, dt, 500, &dataLen, &SDOabortCode);
@@ -174,7 +174,7 @@ static void huge _pascal CgiCliFunction(rpCgiPtr CgiRequest){
             else if(rw == 'w'){
                 CO_SDOclient_return_t ret;
                 CO_SDOclient_setup(SDO_C, 0, 0, nodeId);
-                CO_SDOclientDownloadInitiate(SDO_C, idx, sidx, data, dataLen, 1);
+                CO_SDOclientDownloadInitiate(SDO_C, idx, sidx, data, dataLen, 1, 0);
                 do{
                     uint16_t dt = 2;
                     ret = CO_SDOclientDownload(SDO_C, dt, 500, &SDOabortCode);
@@ -175,7 +175,7 @@ int main (void){
 
 
         /* initialize eeprom - part 2 */
-        CO_EE_init_2(&CO_EEO, eeStatus, CO->SDO, CO->em);
+        CO_EE_init_2(&CO_EEO, eeStatus, CO->SDO[0], CO->em);
 
 
         communicationReset();
@@ -206,10 +206,10 @@ int main (void){
         timer1msPrevious = CO_timer1ms;
         printf("\nCANopenNode - running ...");
 
-        /* Prepare function, which will wake this task after CAN SDO response is */
-        /* received (inside CAN receive interrupt). */
-        CO->SDO->pFunctSignal = wakeUpTask;    /* will wake from RTX_Sleep_Time() */
-        CO->SDO->functArg = RTX_Get_TaskID();  /* id of this task */
+        /* Prepare function, which will wake this task after CAN SDO request is */
+        /* received or SDO block upload can continue (inside CAN interrupt). */
+        CO->SDO[0]->pFunctSignal = wakeUpTask;    /* will wake from RTX_Sleep_Time() */
+        CO->SDO[0]->functArg = RTX_Get_TaskID();  /* id of this task */
 
 
         while(reset == CO_RESET_NOT){
@@ -246,12 +246,7 @@ int main (void){
                 OD_performance[ODA_performance_mainCycleMaxTime] = ticks;
 
 
-            if(CO->SDO->state == CO_SDO_ST_UPLOAD_BL_SUBBLOCK) {
-                RTX_Sleep_Time(2);
-            }
-            else {
-                RTX_Sleep_Time(50);
-            }
+            RTX_Sleep_Time(50);
 
 
             CO_EE_process(&CO_EEO);
@@ -325,7 +320,26 @@ static void TaskTimer(void){
 #ifdef USE_CAN_CALLBACKS
 /* CAN callback function ******************************************************/
 int CAN1callback(CanEvent event, const CanMsg *msg){
-    return CO_CANinterrupt(CO->CANmodule[0], event, msg);
+    int ret;
+    uint16_t i;
+    CO_bool_t wasFull[CO_NO_SDO_SERVER];
+
+    for(i=0; i<CO_NO_SDO_SERVER; i++){
+        wasFull[i] = CO->SDO[i]->CANtxBuff->bufferFull;
+    }
+
+    ret = CO_CANinterrupt(CO->CANmodule[0], event, msg);
+
+    /* Wake SDO server, if its transmit buffer was freed (block upload continues) */
+    for(i=0; i<CO_NO_SDO_SERVER; i++){
+        CO_SDO_t *SDO = CO->SDO[i];
+
+        if(wasFull[i] && !SDO->CANtxBuff->bufferFull && (SDO->pFunctSignal != NULL)){
+            SDO->pFunctSignal(SDO->functArg);
+        }
+    }
+
+    return ret;
 }
 
 int CAN2callback(CanEvent event, const CanMsg *msg){
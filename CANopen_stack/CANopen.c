@@ -28,6 +28,7 @@
 
 
 #include "CANopen.h"
+#include <string.h> /* for memcpy, memset */
 
 
 /* If defined, global variables will be used, otherwise CANopen objects will
@@ -37,13 +38,14 @@
 
 #ifndef CO_USE_GLOBALS
     #include <stdlib.h> /*  for malloc, free */
-    static uint32_t CO_memoryUsed = 0; /* informative */
 #endif
 
 
 /* Global variables ***********************************************************/
     extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];  /* Object Dictionary array */
-    static CO_t COO;
+#ifdef CO_OD_INDEX_PAGES
+    extern const CO_ODindex_t CO_OD_index;      /* Direct index into Object Dictionary */
+#endif
     CO_t *CO = NULL;
 
 #if defined(__dsPIC33F__) || defined(__PIC24H__) \
@@ -63,27 +65,19 @@
 #endif
 #endif
 
-    static CO_CANrx_t          *CO_CANmodule_rxArray0;
-    static CO_CANtx_t          *CO_CANmodule_txArray0;
-  #if CO_NO_CAN_MODULES >= 2
-    static CO_CANrx_t          *CO_CANmodule_rxArray1;
-    static CO_CANtx_t          *CO_CANmodule_txArray1;
-  #endif
-    static CO_OD_extension_t   *CO_SDO_ODExtensions;
-    static CO_HBconsNode_t     *CO_HBcons_monitoredNodes;
-
 
 /* Verify features from CO_OD *************************************************/
     /* generate error, if features are not corectly configured for this project */
     #if        CO_NO_NMT_MASTER                           >  1     \
             || CO_NO_SYNC                                 != 1     \
             || CO_NO_EMERGENCY                            != 1     \
-            || CO_NO_SDO_SERVER                           != 1     \
+            || (CO_NO_SDO_SERVER < 1 || CO_NO_SDO_SERVER > 128)    \
             || (CO_NO_SDO_CLIENT != 0 && CO_NO_SDO_CLIENT != 1)    \
             || (CO_NO_RPDO < 1 || CO_NO_RPDO > 0x200)              \
             || (CO_NO_TPDO < 1 || CO_NO_TPDO > 0x200)              \
             || ODL_consumerHeartbeatTime_arrayLength      == 0     \
-            || ODL_errorStatusBits_stringLength           < 10
+            || ODL_errorStatusBits_stringLength           < 10     \
+            || (CO_NO_CAN_MODULES < 1 || CO_NO_CAN_MODULES > 4)
         #error Features from CO_OD.h file are not corectly configured for this project!
     #endif
 
@@ -95,14 +89,26 @@
         #define CO_NO_HB_CONS   0
     #endif
 
+    #ifdef ODL_objectScannerList_arrayLength
+        #define CO_NO_MPDO_SCANNER      ODL_objectScannerList_arrayLength
+    #else
+        #define CO_NO_MPDO_SCANNER      0
+    #endif
+    #ifdef ODL_objectDispatcherList_arrayLength
+        #define CO_NO_MPDO_DISPATCHER   ODL_objectDispatcherList_arrayLength
+    #else
+        #define CO_NO_MPDO_DISPATCHER   0
+    #endif
+
     #define CO_RXCAN_NMT       0                                      /*  index for NMT message */
     #define CO_RXCAN_SYNC      1                                      /*  index for SYNC message */
     #define CO_RXCAN_RPDO     (CO_RXCAN_SYNC+CO_NO_SYNC)              /*  start index for RPDO messages */
-    #define CO_RXCAN_SDO_SRV  (CO_RXCAN_RPDO+CO_NO_RPDO)              /*  start index for SDO server message (request) */
+    #define CO_RXCAN_TPDO     (CO_RXCAN_RPDO+CO_NO_RPDO)              /*  start index for TPDO remote transmission requests */
+    #define CO_RXCAN_SDO_SRV  (CO_RXCAN_TPDO+CO_NO_TPDO)              /*  start index for SDO server message (request) */
     #define CO_RXCAN_SDO_CLI  (CO_RXCAN_SDO_SRV+CO_NO_SDO_SERVER)     /*  start index for SDO client message (response) */
     #define CO_RXCAN_CONS_HB  (CO_RXCAN_SDO_CLI+CO_NO_SDO_CLIENT)     /*  start index for Heartbeat Consumer messages */
     /* total number of received CAN messages */
-    #define CO_RXCAN_NO_MSGS (1+CO_NO_SYNC+CO_NO_RPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+CO_NO_HB_CONS)
+    #define CO_RXCAN_NO_MSGS (1+CO_NO_SYNC+CO_NO_RPDO+CO_NO_TPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+CO_NO_HB_CONS)
 
     #define CO_TXCAN_NMT       0                                      /*  index for NMT master message */
     #define CO_TXCAN_SYNC      CO_TXCAN_NMT+CO_NO_NMT_MASTER          /*  index for SYNC message */
@@ -116,14 +122,17 @@
 
 
 #ifdef CO_USE_GLOBALS
+    static CO_t                 COO;
     static CO_CANmodule_t       COO_CANmodule[CO_NO_CAN_MODULES];
     static CO_CANrx_t           COO_CANmodule_rxArray0[CO_RXCAN_NO_MSGS];
     static CO_CANtx_t           COO_CANmodule_txArray0[CO_TXCAN_NO_MSGS];
   #if CO_NO_CAN_MODULES >= 2
-    static CO_CANrx_t           COO_CANmodule_rxArray1[2];
-    static CO_CANtx_t           COO_CANmodule_txArray1[2];
+    /* other CAN modules may have PDOs only */
+    static CO_CANrx_t           COO_CANmodule_rxArrays[CO_NO_CAN_MODULES-1][CO_NO_RPDO+CO_NO_TPDO];
+    static CO_CANtx_t           COO_CANmodule_txArrays[CO_NO_CAN_MODULES-1][CO_NO_TPDO];
   #endif
-    static CO_SDO_t             COO_SDO;
+    static CO_timerWheel_t      COO_timers;
+    static CO_SDO_t             COO_SDO[CO_NO_SDO_SERVER];
     static CO_OD_extension_t    COO_SDO_ODExtensions[CO_OD_NoOfElements];
     static CO_EM_t              COO_EM;
     static CO_EMpr_t            COO_EMpr;
@@ -131,6 +140,14 @@
     static CO_SYNC_t            COO_SYNC;
     static CO_RPDO_t            COO_RPDO[CO_NO_RPDO];
     static CO_TPDO_t            COO_TPDO[CO_NO_TPDO];
+    static CO_MPDO_t            COO_MPDO;
+  #if CO_NO_MPDO_DISPATCHER > 0
+    static CO_MPDOdispatch_t    COO_MPDOdispatch[CO_NO_MPDO_DISPATCHER];
+  #endif
+  #ifdef CO_TPDO_CHANGE_DRIVEN
+    static CO_TPDOnotify_t      COO_TPDOnotify;
+    static CO_TPDOmapRef_t     *COO_TPDOmapRef[CO_OD_NoOfElements];
+  #endif
     static CO_HBconsumer_t      COO_HBcons;
     static CO_HBconsNode_t      COO_HBcons_monitoredNodes[CO_NO_HB_CONS];
 #if CO_NO_SDO_CLIENT == 1
@@ -141,16 +158,15 @@
 
 /******************************************************************************/
 #if CO_NO_NMT_MASTER == 1
-    CO_CANtx_t *NMTM_txBuff = 0;
     /* Helper function for using: */
     uint8_t CO_sendNMTcommand(CO_t *CO, uint8_t command, uint8_t nodeID){
-        if(NMTM_txBuff == 0){
+        if(CO->NMTM_txBuff == 0){
             /* error, CO_CANtxBufferInit() was not called for this buffer. */
             return CO_ERROR_TX_UNCONFIGURED; /* -11 */
         }
-        NMTM_txBuff->data[0] = command;
-        NMTM_txBuff->data[1] = nodeID;
-        return CO_CANsend(CO->CANmodule[0], NMTM_txBuff); /* 0 = success */
+        CO->NMTM_txBuff->data[0] = command;
+        CO->NMTM_txBuff->data[1] = nodeID;
+        return CO_CANsend(CO->CANmodule[0], CO->NMTM_txBuff); /* 0 = success */
     }
 #endif
 
@@ -205,17 +221,85 @@ static CO_SDO_abortCode_t CO_ODF_bitRate(CO_ODF_arg_t *ODF_arg){
 }
 
 
+/* Number of PDOs on CAN module *********************************************/
+/* If _count_ is index of PDO, returned value is also index of that PDO among
+ * PDOs on the same CAN module. */
+static uint16_t CO_PDOcount(const uint8_t PDOCANmodule[], int16_t count, uint8_t module){
+    uint16_t n = 0U;
+    int16_t i;
+
+    for(i=0; i<count; i++){
+        if(PDOCANmodule[i] == module) n++;
+    }
+
+    return n;
+}
+
+
+/* Status LEDs timer ********************************************************/
+/* Expires each 50 ms, object is CANopen object. */
+static void CO_LEDtimerExpired(void *object){
+    CO_t *co = (CO_t*)object;
+
+    CO_NMT_blinkingProcess50ms(co->NMT);
+    CO_timer_start(co->timers, &co->LEDtimer, 50);
+}
+
+
 /******************************************************************************/
 CO_ReturnError_t CO_init(){
+    CO_config_t config;
+    int16_t i;
 
+    /* Read CANopen Node-ID and CAN bit-rate from object dictionary */
+    memset(&config, 0, sizeof(config));
+    config.nodeId = OD_CANNodeID; if(config.nodeId<1 || config.nodeId>127) config.nodeId = 0x10;
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        config.CANbitRate[i] = OD_CANBitRate;/* in kbps */
+    }
+    config.CANbaseAddress[0] = ADDR_CAN1;
+#if CO_NO_CAN_MODULES >= 2
+    config.CANbaseAddress[1] = ADDR_CAN2;
+    for(i=4; i<CO_NO_RPDO; i++){
+        config.RPDOCANmodule[i] = 1U;
+    }
+#endif
+#if CO_NO_CAN_MODULES >= 3
+    config.CANbaseAddress[2] = ADDR_CAN3;
+#endif
+#if CO_NO_CAN_MODULES >= 4
+    config.CANbaseAddress[3] = ADDR_CAN4;
+#endif
+
+    return CO_initInstance(&CO, &config);
+}
+
+
+/******************************************************************************/
+void CO_delete(){
+    CO_deleteInstance(&CO);
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_initInstance(CO_t **ppCO, const CO_config_t *config){
+
+    CO_t *CO;
     int16_t i;
     uint8_t nodeId;
-    uint16_t CANBitRate;
+    CO_bool_t created = CO_false;
     CO_ReturnError_t err;
+    uint16_t CANrxSize[CO_NO_CAN_MODULES];
+    uint16_t CANtxSize[CO_NO_CAN_MODULES];
+    uint16_t rxShift, txShift;  /* number of PDOs moved from first CAN module */
 #ifndef CO_USE_GLOBALS
     uint16_t errCnt;
 #endif
 
+    if((ppCO == NULL) || (config == NULL) || (config->nodeId < 1U) || (config->nodeId > 127U)){
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
     /* Verify parameters from CO_OD */
     if(   sizeof(OD_TPDOCommunicationParameter_t) != sizeof(CO_TPDOCommPar_t)
        || sizeof(OD_TPDOMappingParameter_t) != sizeof(CO_TPDOMapPar_t)
@@ -231,21 +315,55 @@ CO_ReturnError_t CO_init(){
     }
     #endif
 
+    /* Size CAN buffers. First CAN module has all objects except PDOs, which
+     * are configured to other CAN modules. Buffer indexes on first CAN module
+     * stay in the same order as CO_RXCAN_ and CO_TXCAN_ defines. */
+    for(i=0; i<CO_NO_RPDO; i++){
+        if(config->RPDOCANmodule[i] >= CO_NO_CAN_MODULES) return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+    for(i=0; i<CO_NO_TPDO; i++){
+        if(config->TPDOCANmodule[i] >= CO_NO_CAN_MODULES) return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        CANrxSize[i] = CO_PDOcount(config->RPDOCANmodule, CO_NO_RPDO, (uint8_t)i)
+                     + CO_PDOcount(config->TPDOCANmodule, CO_NO_TPDO, (uint8_t)i);
+        CANtxSize[i] = CO_PDOcount(config->TPDOCANmodule, CO_NO_TPDO, (uint8_t)i);
+    }
+    rxShift = CO_NO_RPDO + CO_NO_TPDO - CANrxSize[0];
+    txShift = CO_NO_TPDO - CANtxSize[0];
+    CANrxSize[0] = CO_RXCAN_NO_MSGS - rxShift;
+    CANtxSize[0] = CO_TXCAN_NO_MSGS - txShift;
+
 
     /* Initialize CANopen object */
 #ifdef CO_USE_GLOBALS
-    CO = &COO;
+    /* Only one instance is possible */
+    if(*ppCO == NULL){
+        if(COO.SDO[0] != NULL){
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+        created = CO_true;
+    }
+    CO = *ppCO = &COO;
 
     CO->CANmodule[0]                    = &COO_CANmodule[0];
-    CO_CANmodule_rxArray0               = &COO_CANmodule_rxArray0[0];
-    CO_CANmodule_txArray0               = &COO_CANmodule_txArray0[0];
+    CO->CANrx[0]                        = &COO_CANmodule_rxArray0[0];
+    CO->CANtx[0]                        = &COO_CANmodule_txArray0[0];
   #if CO_NO_CAN_MODULES >= 2
-    CO->CANmodule[1]                    = &COO_CANmodule[1];
-    CO_CANmodule_rxArray1               = &COO_CANmodule_rxArray1[0];
-    CO_CANmodule_txArray1               = &COO_CANmodule_txArray1[0];
+    for(i=1; i<CO_NO_CAN_MODULES; i++){
+        CO->CANmodule[i]                = &COO_CANmodule[i];
+        CO->CANrx[i]                    = &COO_CANmodule_rxArrays[i-1][0];
+        CO->CANtx[i]                    = &COO_CANmodule_txArrays[i-1][0];
+    }
   #endif
-    CO->SDO                             = &COO_SDO;
-    CO_SDO_ODExtensions                 = &COO_SDO_ODExtensions[0];
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        CO->CANrxSize[i]                = CANrxSize[i];
+        CO->CANtxSize[i]                = CANtxSize[i];
+    }
+    CO->timers                          = &COO_timers;
+    for(i=0; i<CO_NO_SDO_SERVER; i++)
+        CO->SDO[i]                      = &COO_SDO[i];
+    CO->ODExtensions                    = &COO_SDO_ODExtensions[0];
     CO->em                              = &COO_EM;
     CO->emPr                            = &COO_EMpr;
     CO->NMT                             = &COO_NMT;
@@ -254,25 +372,42 @@ CO_ReturnError_t CO_init(){
         CO->RPDO[i]                     = &COO_RPDO[i];
     for(i=0; i<CO_NO_TPDO; i++)
         CO->TPDO[i]                     = &COO_TPDO[i];
+  #ifdef CO_TPDO_CHANGE_DRIVEN
+    CO->TPDOnotify                      = &COO_TPDOnotify;
+    CO->TPDOmapRef                      = &COO_TPDOmapRef[0];
+  #endif
+    CO->MPDO                            = &COO_MPDO;
+  #if CO_NO_MPDO_DISPATCHER > 0
+    CO->MPDOdispatch                    = &COO_MPDOdispatch[0];
+  #else
+    CO->MPDOdispatch                    = NULL;
+  #endif
     CO->HBcons                          = &COO_HBcons;
-    CO_HBcons_monitoredNodes            = &COO_HBcons_monitoredNodes[0];
+    CO->HBconsMonitoredNodes            = &COO_HBcons_monitoredNodes[0];
   #if CO_NO_SDO_CLIENT == 1
     CO->SDOclient                       = &COO_SDOclient;
   #endif
 
 #else
-    if(CO == NULL){    /* Use malloc only once */
-        CO = &COO;
-        CO->CANmodule[0]                    = (CO_CANmodule_t *)    malloc(sizeof(CO_CANmodule_t));
-        CO_CANmodule_rxArray0               = (CO_CANrx_t *)        malloc(sizeof(CO_CANrx_t) * CO_RXCAN_NO_MSGS);
-        CO_CANmodule_txArray0               = (CO_CANtx_t *)        malloc(sizeof(CO_CANtx_t) * CO_TXCAN_NO_MSGS);
-      #if CO_NO_CAN_MODULES >= 2
-        CO->CANmodule[1]                    = (CO_CANmodule_t *)    malloc(sizeof(CO_CANmodule_t));
-        CO_CANmodule_rxArray1               = (CO_CANrx_t *)        malloc(sizeof(CO_CANrx_t) * 2);
-        CO_CANmodule_txArray1               = (CO_CANtx_t *)        malloc(sizeof(CO_CANtx_t) * 2);
-      #endif
-        CO->SDO                             = (CO_SDO_t *)          malloc(sizeof(CO_SDO_t));
-        CO_SDO_ODExtensions                 = (CO_OD_extension_t*)  malloc(sizeof(CO_OD_extension_t) * CO_OD_NoOfElements);
+    if(*ppCO == NULL){    /* Use malloc only once */
+        CO = (CO_t *) calloc(1, sizeof(CO_t));
+        if(CO == NULL){
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+        *ppCO = CO;
+        created = CO_true;
+        for(i=0; i<CO_NO_CAN_MODULES; i++){
+            CO->CANmodule[i]                = (CO_CANmodule_t *)    malloc(sizeof(CO_CANmodule_t));
+            CO->CANrx[i]                    = (CO_CANrx_t *)        malloc(sizeof(CO_CANrx_t) * CANrxSize[i]);
+            CO->CANtx[i]                    = (CO_CANtx_t *)        malloc(sizeof(CO_CANtx_t) * CANtxSize[i]);
+            CO->CANrxSize[i]                = CANrxSize[i];
+            CO->CANtxSize[i]                = CANtxSize[i];
+        }
+        CO->timers                          = (CO_timerWheel_t *)   malloc(sizeof(CO_timerWheel_t));
+        for(i=0; i<CO_NO_SDO_SERVER; i++){
+            CO->SDO[i]                      = (CO_SDO_t *)          malloc(sizeof(CO_SDO_t));
+        }
+        CO->ODExtensions                    = (CO_OD_extension_t*)  malloc(sizeof(CO_OD_extension_t) * CO_OD_NoOfElements);
         CO->em                              = (CO_EM_t *)           malloc(sizeof(CO_EM_t));
         CO->emPr                            = (CO_EMpr_t *)         malloc(sizeof(CO_EMpr_t));
         CO->NMT                             = (CO_NMT_t *)          malloc(sizeof(CO_NMT_t));
@@ -283,22 +418,33 @@ CO_ReturnError_t CO_init(){
         for(i=0; i<CO_NO_TPDO; i++){
             CO->TPDO[i]                     = (CO_TPDO_t *)         malloc(sizeof(CO_TPDO_t));
         }
+      #ifdef CO_TPDO_CHANGE_DRIVEN
+        CO->TPDOnotify                      = (CO_TPDOnotify_t *)   malloc(sizeof(CO_TPDOnotify_t));
+        CO->TPDOmapRef                      = (CO_TPDOmapRef_t **)  malloc(sizeof(CO_TPDOmapRef_t *) * CO_OD_NoOfElements);
+      #endif
+        CO->MPDO                            = (CO_MPDO_t *)         malloc(sizeof(CO_MPDO_t));
+      #if CO_NO_MPDO_DISPATCHER > 0
+        CO->MPDOdispatch                    = (CO_MPDOdispatch_t *) malloc(sizeof(CO_MPDOdispatch_t) * CO_NO_MPDO_DISPATCHER);
+      #endif
         CO->HBcons                          = (CO_HBconsumer_t *)   malloc(sizeof(CO_HBconsumer_t));
-        CO_HBcons_monitoredNodes            = (CO_HBconsNode_t *)   malloc(sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS);
+        CO->HBconsMonitoredNodes            = (CO_HBconsNode_t *)   malloc(sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS);
       #if CO_NO_SDO_CLIENT == 1
         CO->SDOclient                       = (CO_SDOclient_t *)    malloc(sizeof(CO_SDOclient_t));
       #endif
     }
+    CO = *ppCO;
 
-    CO_memoryUsed = sizeof(CO_CANmodule_t)
-                  + sizeof(CO_CANrx_t) * CO_RXCAN_NO_MSGS
-                  + sizeof(CO_CANtx_t) * CO_TXCAN_NO_MSGS
-  #if CO_NO_CAN_MODULES >= 2
-                  + sizeof(CO_CANmodule_t)
-                  + sizeof(CO_CANrx_t) * 2
-                  + sizeof(CO_CANtx_t) * 2
-  #endif
-                  + sizeof(CO_SDO_t)
+    /* buffers are allocated only once, so CAN modules of PDOs can't change */
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        if(CO->CANrxSize[i] != CANrxSize[i] || CO->CANtxSize[i] != CANtxSize[i]){
+            CO_deleteInstance(ppCO);
+            return CO_ERROR_ILLEGAL_ARGUMENT;
+        }
+    }
+
+    CO->memoryUsed = sizeof(CO_t)
+                  + sizeof(CO_timerWheel_t)
+                  + sizeof(CO_SDO_t) * CO_NO_SDO_SERVER
                   + sizeof(CO_OD_extension_t) * CO_OD_NoOfElements
                   + sizeof(CO_EM_t)
                   + sizeof(CO_EMpr_t)
@@ -306,24 +452,36 @@ CO_ReturnError_t CO_init(){
                   + sizeof(CO_SYNC_t)
                   + sizeof(CO_RPDO_t) * CO_NO_RPDO
                   + sizeof(CO_TPDO_t) * CO_NO_TPDO
+  #ifdef CO_TPDO_CHANGE_DRIVEN
+                  + sizeof(CO_TPDOnotify_t)
+                  + sizeof(CO_TPDOmapRef_t *) * CO_OD_NoOfElements
+  #endif
+                  + sizeof(CO_MPDO_t)
+                  + sizeof(CO_MPDOdispatch_t) * CO_NO_MPDO_DISPATCHER
                   + sizeof(CO_HBconsumer_t)
                   + sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS
   #if CO_NO_SDO_CLIENT == 1
                   + sizeof(CO_SDOclient_t)
   #endif
                   + 0;
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        CO->memoryUsed += sizeof(CO_CANmodule_t)
+                        + sizeof(CO_CANrx_t) * CANrxSize[i]
+                        + sizeof(CO_CANtx_t) * CANtxSize[i];
+    }
 
     errCnt = 0;
-    if(CO->CANmodule[0]                 == NULL) errCnt++;
-    if(CO_CANmodule_rxArray0            == NULL) errCnt++;
-    if(CO_CANmodule_txArray0            == NULL) errCnt++;
-  #if CO_NO_CAN_MODULES >= 2
-    if(CO->CANmodule[1]                 == NULL) errCnt++;
-    if(CO_CANmodule_rxArray1            == NULL) errCnt++;
-    if(CO_CANmodule_txArray1            == NULL) errCnt++;
-  #endif
-    if(CO->SDO                          == NULL) errCnt++;
-    if(CO_SDO_ODExtensions              == NULL) errCnt++;
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        if(CO->CANmodule[i]             == NULL) errCnt++;
+        /* CAN module without PDOs may have no buffers */
+        if(CO->CANrx[i] == NULL && CANrxSize[i] != 0U) errCnt++;
+        if(CO->CANtx[i] == NULL && CANtxSize[i] != 0U) errCnt++;
+    }
+    if(CO->timers                       == NULL) errCnt++;
+    for(i=0; i<CO_NO_SDO_SERVER; i++){
+        if(CO->SDO[i]                   == NULL) errCnt++;
+    }
+    if(CO->ODExtensions                 == NULL) errCnt++;
     if(CO->em                           == NULL) errCnt++;
     if(CO->emPr                         == NULL) errCnt++;
     if(CO->NMT                          == NULL) errCnt++;
@@ -334,26 +492,59 @@ CO_ReturnError_t CO_init(){
     for(i=0; i<CO_NO_TPDO; i++){
         if(CO->TPDO[i]                  == NULL) errCnt++;
     }
+  #ifdef CO_TPDO_CHANGE_DRIVEN
+    if(CO->TPDOnotify                   == NULL) errCnt++;
+    if(CO->TPDOmapRef                   == NULL) errCnt++;
+  #endif
+    if(CO->MPDO                         == NULL) errCnt++;
+  #if CO_NO_MPDO_DISPATCHER > 0
+    if(CO->MPDOdispatch                 == NULL) errCnt++;
+  #endif
     if(CO->HBcons                       == NULL) errCnt++;
-    if(CO_HBcons_monitoredNodes         == NULL) errCnt++;
+    if(CO->HBconsMonitoredNodes         == NULL) errCnt++;
   #if CO_NO_SDO_CLIENT == 1
     if(CO->SDOclient                    == NULL) errCnt++;
   #endif
 
-    if(errCnt != 0) return CO_ERROR_OUT_OF_MEMORY;
+    if(errCnt != 0){CO_deleteInstance(ppCO); return CO_ERROR_OUT_OF_MEMORY;}
 #endif
 
 
-    CO_CANsetConfigurationMode(ADDR_CAN1);
+    /* Object dictionary images of this instance. Object dictionary (CO_OD)
+     * and default values are shared, images are copied when instance is created. */
+    CO->ODimagesCount = 0U;
+    if(config->ODRAM != NULL){
+        CO->ODimages[CO->ODimagesCount].defaultImage = &CO_OD_RAM;
+        CO->ODimages[CO->ODimagesCount].image = config->ODRAM;
+        CO->ODimages[CO->ODimagesCount++].size = sizeof(CO_OD_RAM);
+    }
+    if(config->ODEEPROM != NULL){
+        CO->ODimages[CO->ODimagesCount].defaultImage = &CO_OD_EEPROM;
+        CO->ODimages[CO->ODimagesCount].image = config->ODEEPROM;
+        CO->ODimages[CO->ODimagesCount++].size = sizeof(CO_OD_EEPROM);
+    }
+    if(config->ODROM != NULL){
+        CO->ODimages[CO->ODimagesCount].defaultImage = &CO_OD_ROM;
+        CO->ODimages[CO->ODimagesCount].image = config->ODROM;
+        CO->ODimages[CO->ODimagesCount++].size = sizeof(CO_OD_ROM);
+    }
+    if(created){
+        for(i=0; i<CO->ODimagesCount; i++){
+            memcpy(CO->ODimages[i].image, CO->ODimages[i].defaultImage, CO->ODimages[i].size);
+        }
+    }
+
+    nodeId = config->nodeId;
+
+    /* all timers are stopped, objects start them again */
+    CO_timerWheel_init(CO->timers);
 
-    /* Read CANopen Node-ID and CAN bit-rate from object dictionary */
-    nodeId = OD_CANNodeID; if(nodeId<1 || nodeId>127) nodeId = 0x10;
-    CANBitRate = OD_CANBitRate;/* in kbps */
 
+    CO_CANsetConfigurationMode(config->CANbaseAddress[0]);
 
     err = CO_CANmodule_init(
             CO->CANmodule[0],
-            ADDR_CAN1,
+            config->CANbaseAddress[0],
 #if defined(__dsPIC33F__) || defined(__PIC24H__) \
     || defined(__dsPIC33E__) || defined(__PIC24E__)
             ADDR_DMA0,
@@ -365,92 +556,130 @@ CO_ReturnError_t CO_init(){
             __builtin_dmapage(&CO_CANmsg[0]),
 #endif
 #endif
-            CO_CANmodule_rxArray0,
-            CO_RXCAN_NO_MSGS,
-            CO_CANmodule_txArray0,
-            CO_TXCAN_NO_MSGS,
-            CANBitRate);
+            CO->CANrx[0],
+            CANrxSize[0],
+            CO->CANtx[0],
+            CANtxSize[0],
+            config->CANbitRate[0]);
 
-    if(err){CO_delete(); return err;}
+    if(err){CO_deleteInstance(ppCO); return err;}
 
 
 #if CO_NO_CAN_MODULES >= 2
-    CO_CANsetConfigurationMode(ADDR_CAN2);
-    err = CO_CANmodule_init(
-            CO->CANmodule[1],
-            ADDR_CAN2,
+    for(i=1; i<CO_NO_CAN_MODULES; i++){
+        CO_CANsetConfigurationMode(config->CANbaseAddress[i]);
+        err = CO_CANmodule_init(
+                CO->CANmodule[i],
+                config->CANbaseAddress[i],
 #if defined(__dsPIC33F__) || defined(__PIC24H__) \
     || defined(__dsPIC33E__) || defined(__PIC24E__)
-            ADDR_DMA2,
-            ADDR_DMA3,
-            &CO_CAN2msg[0],
-            CO_CANmsgBuffSize,
-            __builtin_dmaoffset(&CO_CAN2msg[0]),
+                /* dsPIC has two CAN modules */
+                ADDR_DMA2,
+                ADDR_DMA3,
+                &CO_CAN2msg[0],
+                CO_CANmsgBuffSize,
+                __builtin_dmaoffset(&CO_CAN2msg[0]),
 #if defined(__HAS_EDS__)
-            __builtin__dmapage(&CO_CANmsg2[0]),
+                __builtin__dmapage(&CO_CANmsg2[0]),
 #endif
 #endif
-            CO_CANmodule_rxArray1,
-            2,
-            CO_CANmodule_txArray1,
-            2,
-            250);
+                CO->CANrx[i],
+                CANrxSize[i],
+                CO->CANtx[i],
+                CANtxSize[i],
+                config->CANbitRate[i]);
 
-    if(err){CO_delete(); return err;}
+        if(err){CO_deleteInstance(ppCO); return err;}
+    }
 #endif
 
 
     err = CO_SDO_init(
-            CO->SDO,
+            CO->SDO[0],
             CO_CAN_ID_RSDO + nodeId,
             CO_CAN_ID_TSDO + nodeId,
             OD_H1200_SDO_SERVER_PARAM,
             0,
            &CO_OD[0],
             CO_OD_NoOfElements,
-            CO_SDO_ODExtensions,
+            CO->ODExtensions,
+            CO->timers,
             nodeId,
             CO->CANmodule[0],
-            CO_RXCAN_SDO_SRV,
+            CO_RXCAN_SDO_SRV-rxShift,
             CO->CANmodule[0],
-            CO_TXCAN_SDO_SRV);
+            CO_TXCAN_SDO_SRV-txShift);
+
+    if(err){CO_deleteInstance(ppCO); return err;}
+
+#ifdef CO_OD_INDEX_PAGES
+    /* From now on CO_OD_find() uses direct index */
+    CO->SDO[0]->ODindex = &CO_OD_index;
+#endif
+
+    /* From now on CO_OD_VAR() and CO_OD_getDataPointer() use own images */
+    if(CO->ODimagesCount > 0U){
+        CO->SDO[0]->ODimages = CO->ODimages;
+        CO->SDO[0]->ODimagesCount = CO->ODimagesCount;
+    }
 
-    if(err){CO_delete(); return err;}
+    /* additional SDO servers share Object dictionary of the first one */
+    for(i=1; i<CO_NO_SDO_SERVER; i++){
+        err = CO_SDO_init(
+                CO->SDO[i],
+                CO_OD_VAR(CO, uint32_t, OD_SDOServerParameter[i].COB_IDClientToServer),
+                CO_OD_VAR(CO, uint32_t, OD_SDOServerParameter[i].COB_IDServerToClient),
+                OD_H1200_SDO_SERVER_PARAM+i,
+                CO->SDO[0],
+               &CO_OD[0],
+                CO_OD_NoOfElements,
+                CO->ODExtensions,
+                CO->timers,
+                nodeId,
+                CO->CANmodule[0],
+                CO_RXCAN_SDO_SRV-rxShift+i,
+                CO->CANmodule[0],
+                CO_TXCAN_SDO_SRV-txShift+i);
+
+        if(err){CO_deleteInstance(ppCO); return err;}
+    }
 
 
     err = CO_EM_init(
             CO->em,
             CO->emPr,
-            CO->SDO,
-           &OD_errorStatusBits[0],
+            CO->SDO[0],
+            CO->timers,
+           &CO_OD_VAR(CO, uint8_t, OD_errorStatusBits[0]),
             ODL_errorStatusBits_stringLength,
-           &OD_errorRegister,
-           &OD_preDefinedErrorField[0],
+           &CO_OD_VAR(CO, uint8_t, OD_errorRegister),
+           &CO_OD_VAR(CO, uint32_t, OD_preDefinedErrorField[0]),
             ODL_preDefinedErrorField_arrayLength,
             CO->CANmodule[0],
             CO_TXCAN_EMERG,
             CO_CAN_ID_EMERGENCY + nodeId);
 
-    if(err){CO_delete(); return err;}
+    if(err){CO_deleteInstance(ppCO); return err;}
 
 
     err = CO_NMT_init(
             CO->NMT,
             CO->emPr,
+            CO->timers,
             nodeId,
             500,
             CO->CANmodule[0],
             CO_RXCAN_NMT,
             CO_CAN_ID_NMT_SERVICE,
             CO->CANmodule[0],
-            CO_TXCAN_HB,
+            CO_TXCAN_HB-txShift,
             CO_CAN_ID_HEARTBEAT + nodeId);
 
-    if(err){CO_delete(); return err;}
+    if(err){CO_deleteInstance(ppCO); return err;}
 
 
 #if CO_NO_NMT_MASTER == 1
-    NMTM_txBuff = CO_CANtxBufferInit(/* return pointer to 8-byte CAN data buffer, which should be populated */
+    CO->NMTM_txBuff = CO_CANtxBufferInit(/* return pointer to 8-byte CAN data buffer, which should be populated */
             CO->CANmodule[0], /* pointer to CAN module used for sending this message */
             CO_TXCAN_NMT,     /* index of specific buffer inside CAN module */
             0x0000,           /* CAN identifier */
@@ -463,126 +692,203 @@ CO_ReturnError_t CO_init(){
     err = CO_SYNC_init(
             CO->SYNC,
             CO->em,
-            CO->SDO,
+            CO->SDO[0],
            &CO->NMT->operatingState,
-            OD_COB_ID_SYNCMessage,
-            OD_communicationCyclePeriod,
-            OD_synchronousCounterOverflowValue,
+            CO_OD_VAR(CO, uint32_t, OD_COB_ID_SYNCMessage),
+            CO_OD_VAR(CO, uint32_t, OD_communicationCyclePeriod),
+            CO_OD_VAR(CO, uint8_t, OD_synchronousCounterOverflowValue),
             CO->CANmodule[0],
             CO_RXCAN_SYNC,
             CO->CANmodule[0],
             CO_TXCAN_SYNC);
 
-    if(err){CO_delete(); return err;}
+    if(err){CO_deleteInstance(ppCO); return err;}
 
 
     for(i=0; i<CO_NO_RPDO; i++){
-        CO_CANmodule_t *CANdevRx = CO->CANmodule[0];
-        uint16_t CANdevRxIdx = CO_RXCAN_RPDO + i;
+        uint8_t CANmodule = config->RPDOCANmodule[i];
+        uint16_t CANdevRxIdx = CO_PDOcount(config->RPDOCANmodule, i, CANmodule);
 
-#if CO_NO_CAN_MODULES >= 2
-        if(i >= 4){
-            CANdevRx = CO->CANmodule[1];
-            CANdevRxIdx = i-4;
-        }
-#endif
+        if(CANmodule == 0U) CANdevRxIdx += CO_RXCAN_RPDO;
 
         err = CO_RPDO_init(
                 CO->RPDO[i],
                 CO->em,
-                CO->SDO,
+                CO->SDO[0],
+                CO->SYNC,
                &CO->NMT->operatingState,
                 nodeId,
                 ((i<4) ? (CO_CAN_ID_RPDO_1+i*0x100) : 0),
                 0,
-                (CO_RPDOCommPar_t*) &OD_RPDOCommunicationParameter[i],
-                (CO_RPDOMapPar_t*) &OD_RPDOMappingParameter[i],
+               &CO_OD_VAR(CO, CO_RPDOCommPar_t, OD_RPDOCommunicationParameter[i]),
+               &CO_OD_VAR(CO, CO_RPDOMapPar_t, OD_RPDOMappingParameter[i]),
+#ifdef ODL_RPDOOverflowCounter_arrayLength
+               &CO_OD_VAR(CO, uint32_t, OD_RPDOOverflowCounter[i]),
+#else
+                NULL,
+#endif
                 OD_H1400_RXPDO_1_PARAM+i,
                 OD_H1600_RXPDO_1_MAPPING+i,
-                CANdevRx,
+                CO->CANmodule[CANmodule],
                 CANdevRxIdx);
 
-        if(err){CO_delete(); return err;}
+        if(err){CO_deleteInstance(ppCO); return err;}
     }
 
 
     for(i=0; i<CO_NO_TPDO; i++){
+        uint8_t CANmodule = config->TPDOCANmodule[i];
+        uint16_t CANdevTxIdx = CO_PDOcount(config->TPDOCANmodule, i, CANmodule);
+        /* RTR buffers follow RPDO buffers of the same CAN module */
+        uint16_t CANdevRxIdx = CO_PDOcount(config->RPDOCANmodule, CO_NO_RPDO, CANmodule) + CANdevTxIdx;
+
+        if(CANmodule == 0U){
+            CANdevTxIdx += CO_TXCAN_TPDO;
+            CANdevRxIdx += CO_RXCAN_RPDO;
+        }
+
         err = CO_TPDO_init(
                 CO->TPDO[i],
                 CO->em,
-                CO->SDO,
+                CO->SDO[0],
                &CO->NMT->operatingState,
                 nodeId,
                 ((i<4) ? (CO_CAN_ID_TPDO_1+i*0x100) : 0),
                 0,
-                (CO_TPDOCommPar_t*) &OD_TPDOCommunicationParameter[i],
-                (CO_TPDOMapPar_t*) &OD_TPDOMappingParameter[i],
+               &CO_OD_VAR(CO, CO_TPDOCommPar_t, OD_TPDOCommunicationParameter[i]),
+               &CO_OD_VAR(CO, CO_TPDOMapPar_t, OD_TPDOMappingParameter[i]),
                 OD_H1800_TXPDO_1_PARAM+i,
                 OD_H1A00_TXPDO_1_MAPPING+i,
-                CO->CANmodule[0],
-                CO_TXCAN_TPDO+i);
+                CO->CANmodule[CANmodule],
+                CANdevRxIdx,
+                CO->CANmodule[CANmodule],
+                CANdevTxIdx);
+
+        if(err){CO_deleteInstance(ppCO); return err;}
+    }
 
-        if(err){CO_delete(); return err;}
+    err = CO_MPDO_init(
+            CO->MPDO,
+            CO->SDO[0],
+#if CO_NO_MPDO_SCANNER > 0
+           &CO_OD_VAR(CO, uint32_t, OD_objectScannerList[0]),
+#else
+            NULL,
+#endif
+            CO_NO_MPDO_SCANNER,
+#if CO_NO_MPDO_DISPATCHER > 0
+           &CO_OD_VAR(CO, uint64_t, OD_objectDispatcherList[0]),
+#else
+            NULL,
+#endif
+            CO_NO_MPDO_DISPATCHER,
+            OD_H1FD0_MPDO_DISPATCHER_LIST,
+            CO->MPDOdispatch);
+
+    if(err){CO_deleteInstance(ppCO); return err;}
+
+    for(i=0; i<CO_NO_RPDO; i++){
+        CO->RPDO[i]->MPDO = CO->MPDO;
+    }
+    for(i=0; i<CO_NO_TPDO; i++){
+        CO->TPDO[i]->MPDO = CO->MPDO;
     }
 
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    CO_TPDOnotify_init(
+            CO->TPDOnotify,
+            CO->TPDO,
+            CO_NO_TPDO,
+            CO->SDO[0],
+            CO->TPDOmapRef,
+           &CO->NMT->operatingState);
+
+    for(i=0; i<CO_NO_RPDO; i++){
+        CO->RPDO[i]->TPDOnotify = CO->TPDOnotify;
+    }
+
+    /* variables written by additional SDO servers are notified too */
+    for(i=1; i<CO_NO_SDO_SERVER; i++){
+        CO->SDO[i]->pFunctWritten = CO->SDO[0]->pFunctWritten;
+        CO->SDO[i]->functWrittenObject = CO->SDO[0]->functWrittenObject;
+    }
+#endif
+
 
     err = CO_HBconsumer_init(
             CO->HBcons,
             CO->em,
-            CO->SDO,
-           &OD_consumerHeartbeatTime[0],
-            CO_HBcons_monitoredNodes,
+            CO->SDO[0],
+            CO->timers,
+           &CO_OD_VAR(CO, uint32_t, OD_consumerHeartbeatTime[0]),
+            CO->HBconsMonitoredNodes,
             CO_NO_HB_CONS,
             CO->CANmodule[0],
-            CO_RXCAN_CONS_HB);
+            CO_RXCAN_CONS_HB-rxShift);
 
-    if(err){CO_delete(); return err;}
+    if(err){CO_deleteInstance(ppCO); return err;}
 
 
 #if CO_NO_SDO_CLIENT == 1
     err = CO_SDOclient_init(
             CO->SDOclient,
-            CO->SDO,
-            (CO_SDOclientPar_t*) &OD_SDOClientParameter[0],
+            CO->SDO[0],
+           &CO_OD_VAR(CO, CO_SDOclientPar_t, OD_SDOClientParameter[0]),
             CO->CANmodule[0],
-            CO_RXCAN_SDO_CLI,
+            CO_RXCAN_SDO_CLI-rxShift,
             CO->CANmodule[0],
-            CO_TXCAN_SDO_CLI);
+            CO_TXCAN_SDO_CLI-txShift);
 
-    if(err){CO_delete(); return err;}
+    if(err){CO_deleteInstance(ppCO); return err;}
 #endif
 
 
     /* Configure Object dictionary entry at index 0x2101 and 0x2102 */
-    CO_OD_configure(CO->SDO, 0x2101, CO_ODF_nodeId, 0, 0, 0);
-    CO_OD_configure(CO->SDO, 0x2102, CO_ODF_bitRate, 0, 0, 0);
+    CO_OD_configure(CO->SDO[0], 0x2101, CO_ODF_nodeId, 0, 0, 0);
+    CO_OD_configure(CO->SDO[0], 0x2102, CO_ODF_bitRate, 0, 0, 0);
+
+    /* status LEDs */
+    CO_timer_init(&CO->LEDtimer, CO_LEDtimerExpired, (void*)CO);
+    CO_timer_start(CO->timers, &CO->LEDtimer, 50);
 
     return CO_ERROR_NO;
 }
 
 
 /******************************************************************************/
-void CO_delete(){
-#ifndef CO_USE_GLOBALS
+void CO_deleteInstance(CO_t **ppCO){
+    CO_t *CO;
     int16_t i;
-#endif
 
-    CO_CANsetConfigurationMode(ADDR_CAN1);
-    CO_CANmodule_disable(CO->CANmodule[0]);
-#if CO_NO_CAN_MODULES >= 2
-    CO_CANsetConfigurationMode(ADDR_CAN2);
-    CO_CANmodule_disable(CO->CANmodule[1]);
-#endif
+    if((ppCO == NULL) || (*ppCO == NULL)){
+        return;
+    }
+    CO = *ppCO;
+
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        if(CO->CANmodule[i] != NULL){
+            CO_CANsetConfigurationMode(CO->CANmodule[i]->CANbaseAddress);
+            CO_CANmodule_disable(CO->CANmodule[i]);
+        }
+    }
 
 #ifndef CO_USE_GLOBALS
   #if CO_NO_SDO_CLIENT == 1
     free(CO->SDOclient);
   #endif
-    free(CO_HBcons_monitoredNodes);
+    free(CO->HBconsMonitoredNodes);
     free(CO->HBcons);
     for(i=0; i<CO_NO_RPDO; i++){
         free(CO->RPDO[i]);
     }
+  #ifdef CO_TPDO_CHANGE_DRIVEN
+    free(CO->TPDOmapRef);
+    free(CO->TPDOnotify);
+  #endif
+  #if CO_NO_MPDO_DISPATCHER > 0
+    free(CO->MPDOdispatch);
+  #endif
+    free(CO->MPDO);
     for(i=0; i<CO_NO_TPDO; i++){
         free(CO->TPDO[i]);
     }
@@ -590,17 +896,18 @@ void CO_delete(){
     free(CO->NMT);
     free(CO->emPr);
     free(CO->em);
-    free(CO_SDO_ODExtensions);
-    free(CO->SDO);
-    free(CO_CANmodule_txArray0);
-    free(CO_CANmodule_rxArray0);
-    free(CO->CANmodule[0]);
-  #if CO_NO_CAN_MODULES >= 2
-    free(CO_CANmodule_txArray1);
-    free(CO_CANmodule_rxArray1);
-    free(CO->CANmodule[1]);
-  #endif
-    CO = NULL;
+    free(CO->ODExtensions);
+    for(i=0; i<CO_NO_SDO_SERVER; i++){
+        free(CO->SDO[i]);
+    }
+    free(CO->timers);
+    for(i=0; i<CO_NO_CAN_MODULES; i++){
+        free(CO->CANtx[i]);
+        free(CO->CANrx[i]);
+        free(CO->CANmodule[i]);
+    }
+    free(CO);
+    *ppCO = NULL;
 #endif
 }
 
@@ -612,67 +919,86 @@ CO_NMT_reset_cmd_t CO_process(
 {
     CO_bool_t NMTisPreOrOperational = CO_false;
     CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
-    static uint8_t ms50 = 0;
+
+    /* expired timers send Heartbeat, report Heartbeat consumer timeout, ... */
+    CO_timerWheel_process(CO->timers, timeDifference_ms);
 
     if(CO->NMT->operatingState == CO_NMT_PRE_OPERATIONAL || CO->NMT->operatingState == CO_NMT_OPERATIONAL)
         NMTisPreOrOperational = CO_true;
 
-    ms50 += timeDifference_ms;
-    if(ms50 >= 50){
-        ms50 = 0;
-        CO_NMT_blinkingProcess50ms(CO->NMT);
-    }
 
-
-    CO_SDO_process(
-            CO->SDO,
-            NMTisPreOrOperational,
-            timeDifference_ms,
-            1000);
+    CO_process_SDO(CO);
 
 
     CO_EM_process(
             CO->emPr,
             NMTisPreOrOperational,
-            timeDifference_ms * 10,
-            OD_inhibitTimeEMCY);
+            CO_OD_VAR(CO, uint16_t, OD_inhibitTimeEMCY));
 
 
     reset = CO_NMT_process(
             CO->NMT,
-            timeDifference_ms,
-            OD_producerHeartbeatTime,
-            OD_NMTStartup,
-            OD_errorRegister,
-            OD_errorBehavior);
+            CO_OD_VAR(CO, uint16_t, OD_producerHeartbeatTime),
+            CO_OD_VAR(CO, uint32_t, OD_NMTStartup),
+            CO_OD_VAR(CO, uint8_t, OD_errorRegister),
+           &CO_OD_VAR(CO, uint8_t, OD_errorBehavior[0]));
 
 
     CO_HBconsumer_process(
             CO->HBcons,
-            NMTisPreOrOperational,
-            timeDifference_ms);
+            NMTisPreOrOperational);
 
 
     return reset;
 }
 
 
+/******************************************************************************/
+int8_t CO_process_SDO(CO_t *CO){
+    CO_bool_t NMTisPreOrOperational = CO_false;
+    int8_t ret = 0;
+    int16_t i;
+
+    if(CO->NMT->operatingState == CO_NMT_PRE_OPERATIONAL || CO->NMT->operatingState == CO_NMT_OPERATIONAL)
+        NMTisPreOrOperational = CO_true;
+
+    for(i=0; i<CO_NO_SDO_SERVER; i++){
+        int8_t r = CO_SDO_process(
+                CO->SDO[i],
+                NMTisPreOrOperational,
+                1000);
+
+        if(r < 0 || (r > 0 && ret == 0)) ret = r;
+    }
+
+    return ret;
+}
+
+
 /******************************************************************************/
 void CO_process_RPDO(CO_t *CO){
     uint8_t SYNCret;
     int16_t i;
 
-    SYNCret = CO_SYNC_process(CO->SYNC, 1000L, OD_synchronousWindowLength);
-    if(SYNCret == 2) CO_CANclearPendingSyncPDOs(CO->CANmodule[0]);
+    SYNCret = CO_SYNC_process(CO->SYNC, 1000L, CO_OD_VAR(CO, uint32_t, OD_synchronousWindowLength));
+    if(SYNCret == 2){
+        for(i=0; i<CO_NO_CAN_MODULES; i++){
+            CO_CANclearPendingSyncPDOs(CO->CANmodule[i]);
+        }
+    }
 
     for(i=0; i<CO_NO_RPDO; i++){
-        CO_RPDO_process(CO->RPDO[i]);
+        CO_RPDO_process(CO->RPDO[i], (SYNCret == 1) ? CO_true : CO_false);
     }
 }
 
 
 /******************************************************************************/
 void CO_process_TPDO(CO_t *CO){
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    /* Process only TPDOs with written variables, running timers or SYNC */
+    CO_TPDOnotify_process(CO->TPDOnotify, CO->SYNC, 1);
+#else
     int16_t i;
 
     /* Verify PDO Change Of State and process PDOs */
@@ -680,4 +1006,15 @@ void CO_process_TPDO(CO_t *CO){
         if(!CO->TPDO[i]->sendRequest) CO->TPDO[i]->sendRequest = CO_TPDOisCOS(CO->TPDO[i]);
         CO_TPDO_process(CO->TPDO[i], CO->SYNC, 10, 1);
     }
+#endif
+}
+
+
+/******************************************************************************/
+void CO_process_TPDO_RTR(CO_t *CO){
+    int16_t i;
+
+    for(i=0; i<CO_NO_TPDO; i++){
+        CO_TPDO_processRTR(CO->TPDO[i]);
+    }
 }
@@ -55,6 +55,7 @@
 
 
     #include "CO_driver.h"
+    #include "CO_timer.h"
     #include "CO_OD.h"
     #include "CO_SDO.h"
     #include "CO_Emergency.h"
@@ -95,22 +96,54 @@ typedef enum{
 
 
 /**
- * Number of CAN modules in use.
+ * Number of CAN modules in use, 1 to 4.
  *
- * If constant is set globaly to 2, second CAN module is initialized and fifth
- * and sixth RPDO (if exist) are configured to it.
+ * NMT, SYNC, Emergency, SDO and Heartbeat objects are always on the first CAN
+ * module. Each PDO may be configured to any CAN module, see CO_config_t.
+ * Receive and transmit buffers of each CAN module are sized by number of
+ * objects on it.
  */
 #ifndef CO_NO_CAN_MODULES
     #define CO_NO_CAN_MODULES 1
 #endif
 
 
+/**
+ * Configuration of one CANopen device, see CO_initInstance().
+ *
+ * Object dictionary (CO_OD[] array, generated in CO_OD.c) is shared by all
+ * devices. Each device may have own copy of the variables, stored in the
+ * default images CO_OD_RAM, CO_OD_EEPROM and CO_OD_ROM.
+ */
+typedef struct{
+    uint8_t             nodeId;         /**< CANopen Node-ID, 1 to 127 */
+    /** CAN bit rates of CAN modules in kbps */
+    uint16_t            CANbitRate[CO_NO_CAN_MODULES];
+    /** Base addresses of CAN modules (ADDR_CAN1, ...) */
+    uint16_t            CANbaseAddress[CO_NO_CAN_MODULES];
+    /** CAN module of each RPDO, index into _CANbaseAddress_. Must not change,
+    when existing instance is initialized again. */
+    uint8_t             RPDOCANmodule[CO_NO_RPDO];
+    /** CAN module of each TPDO, same as above */
+    uint8_t             TPDOCANmodule[CO_NO_TPDO];
+    /** Own image of CO_OD_RAM or NULL, if default image is used. It is
+    initialized from default image, when instance is created. */
+    struct sCO_OD_RAM  *ODRAM;
+    /** Own image of CO_OD_EEPROM or NULL, same as above. Default image may
+    be shared read-only by many instances, see CO_initInstance(). */
+    struct sCO_OD_EEPROM *ODEEPROM;
+    /** Own image of CO_OD_ROM or NULL, same as for _ODEEPROM_ */
+    struct sCO_OD_ROM  *ODROM;
+}CO_config_t;
+
+
 /**
  * CANopen stack object combines pointers to all CANopen objects.
  */
 typedef struct{
     CO_CANmodule_t     *CANmodule[CO_NO_CAN_MODULES];/**< CAN module objects */
-    CO_SDO_t           *SDO;            /**< SDO object */
+    CO_timerWheel_t    *timers;         /**< Timers of objects processed by CO_process() */
+    CO_SDO_t           *SDO[CO_NO_SDO_SERVER];/**< SDO server objects, first is default SDO */
     CO_EM_t            *em;             /**< Emergency report object */
     CO_EMpr_t          *emPr;           /**< Emergency process object */
     CO_NMT_t           *NMT;            /**< NMT object */
@@ -121,13 +154,47 @@ typedef struct{
 #if CO_NO_SDO_CLIENT == 1
     CO_SDOclient_t     *SDOclient;      /**< SDO client object */
 #endif
+    CO_CANrx_t         *CANrx[CO_NO_CAN_MODULES];/**< Receive buffers of CAN modules */
+    CO_CANtx_t         *CANtx[CO_NO_CAN_MODULES];/**< Transmit buffers of CAN modules */
+    uint16_t            CANrxSize[CO_NO_CAN_MODULES];/**< Number of receive buffers of CAN modules */
+    uint16_t            CANtxSize[CO_NO_CAN_MODULES];/**< Number of transmit buffers of CAN modules */
+    CO_OD_extension_t  *ODExtensions;   /**< Object dictionary extensions of SDO object */
+    CO_HBconsNode_t    *HBconsMonitoredNodes;/**< Monitored nodes of Heartbeat consumer */
+    CO_MPDO_t          *MPDO;           /**< MPDO object, see CO_MPDO_init() */
+    CO_MPDOdispatch_t  *MPDOdispatch;   /**< Dispatch table of MPDO or NULL, if there is no _object dispatcher list_ */
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    CO_TPDOnotify_t    *TPDOnotify;     /**< Change driven TPDO processing, see CO_TPDOnotify_init() */
+    CO_TPDOmapRef_t   **TPDOmapRef;     /**< Array of size CO_OD_NoOfElements, used by TPDOnotify */
+#endif
+#if CO_NO_NMT_MASTER == 1
+    CO_CANtx_t         *NMTM_txBuff;    /**< CAN transmit buffer for CO_sendNMTcommand() */
+#endif
+    CO_ODimage_t        ODimages[3];    /**< Own Object dictionary images, from CO_config_t */
+    uint8_t             ODimagesCount;  /**< Number of used _ODimages_ */
+    CO_timer_t          LEDtimer;       /**< Periodic timer for CO_NMT_blinkingProcess50ms() */
+    uint32_t            memoryUsed;     /**< Memory allocated by CO_initInstance(), informative */
 }CO_t;
 
 
-/** CANopen object */
+/** CANopen object, used by CO_init() and CO_delete() */
     extern CO_t *CO;
 
 
+/**
+ * Access Object dictionary variable of CANopen device.
+ *
+ * OD_ macros from CO_OD.h access default images. If device has own images
+ * (see CO_config_t), variable must be accessed through this macro, for
+ * example CO_OD_VAR(CO, uint8_t, OD_errorRegister). Address of array element
+ * is &CO_OD_VAR(CO, uint32_t, OD_preDefinedErrorField[0]).
+ *
+ * @param CO CANopen object.
+ * @param type Type of the variable.
+ * @param var Variable from CO_OD.h (OD_ macro).
+ */
+#define CO_OD_VAR(CO, type, var) (*(type*)CO_OD_getInstancePointer((CO)->SDO[0], &(var)))
+
+
 /**
  * Function CO_sendNMTcommand() is simple function, which sends CANopen message.
  * This part of code is an example of custom definition of simple CANopen
@@ -149,7 +216,11 @@ typedef struct{
 /**
  * Initialize CANopen stack.
  *
- * Function must be called in the communication reset section.
+ * Function must be called in the communication reset section. It initializes
+ * global CANopen object _CO_* with CO_initInstance(). Node-ID and CAN bit rate
+ * are read from Object dictionary, CAN modules are ADDR_CAN1 (, ADDR_CAN2, ...),
+ * default Object dictionary images are used. If there are more CAN modules,
+ * fifth and further RPDOs are configured to second CAN module.
  *
  * @return #CO_ReturnError_t: CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT,
  * CO_ERROR_OUT_OF_MEMORY, CO_ERROR_ILLEGAL_BAUDRATE
@@ -163,12 +234,49 @@ CO_ReturnError_t CO_init(void);
 void CO_delete(void);
 
 
+/**
+ * Initialize one instance of CANopen stack.
+ *
+ * Function must be called in the communication reset section of each
+ * instance. Many instances (CANopen devices) may exist in one program, each
+ * with own CAN modules, see CO_config_t. RAM image must be own for each
+ * instance, only one instance may use default CO_OD_RAM. EEPROM and ROM
+ * images may be shared by many instances (default images are used, if they
+ * are NULL), if they are used read-only: value written into shared image by
+ * SDO or by application is seen by all instances, which share it. If
+ * CO_USE_GLOBALS is defined, only one instance is possible.
+ *
+ * @param ppCO Pointer to CANopen object. If *ppCO is NULL, new instance is
+ * created and *ppCO is set. Otherwise existing instance is initialized again.
+ * @param config Configuration of the instance.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT,
+ * CO_ERROR_OUT_OF_MEMORY, CO_ERROR_ILLEGAL_BAUDRATE. On error instance is
+ * deleted.
+ */
+CO_ReturnError_t CO_initInstance(CO_t **ppCO, const CO_config_t *config);
+
+
+/**
+ * Delete instance of CANopen stack and free memory.
+ *
+ * @param ppCO Pointer to CANopen object, set to NULL.
+ */
+void CO_deleteInstance(CO_t **ppCO);
+
+
 /**
  * Process CANopen objects.
  *
  * Function must be called cyclically. It processes all "asynchronous" CANopen
  * objects. Function returns value from CO_NMT_process().
  *
+ * Timeouts of SDO server, Emergency, Heartbeat producer and consumer are
+ * timers in _CO->timers_ wheel, which is processed first. If there is no new
+ * CAN message, function does not need to be called before
+ * CO_timerWheel_nextDeadline(CO->timers) milliseconds elapse. Application
+ * may use this to sleep longer than 1 ms.
+ *
  * @param CO This object
  * @param timeDifference_ms Time difference from previous function call in [milliseconds].
  *
@@ -179,6 +287,27 @@ CO_NMT_reset_cmd_t CO_process(
         uint16_t                timeDifference_ms);
 
 
+/**
+ * Process CANopen SDO servers.
+ *
+ * Function is called from CO_process(). Application may call it also
+ * immediately after SDO request is received, for example from the task
+ * woken by CO_SDO_t::pFunctSignal. Response is then sent without waiting
+ * for the next CO_process() and SDO transfer is limited by the CAN bus
+ * instead of the cycle time. CO_process() is still necessary for timeouts.
+ *
+ * All SDO server channels are processed. Function must be called from the
+ * same thread as CO_process(), so SDO servers access Object dictionary one
+ * at a time.
+ *
+ * @param CO This object
+ *
+ * @return -1, if SDO abort just occurred on any channel, else 1, if any
+ * channel is in transfer state, else 0. See CO_SDO_process().
+ */
+int8_t CO_process_SDO(CO_t *CO);
+
+
 /**
  * Process CANopen SYNC and RPDO objects.
  *
@@ -196,10 +325,28 @@ void CO_process_RPDO(CO_t *CO);
  * Function must be called cyclically from synchronous 1ms task. It processes
  * transmit PDO CANopen objects.
  *
+ * If CO_TPDO_CHANGE_DRIVEN is defined, only TPDOs with something to do are
+ * processed, see CO_TPDOnotify_process(). Application must then report
+ * directly written mapped variables with CO_TPDOnotify_written().
+ *
  * @param CO This object
  */
 void CO_process_TPDO(CO_t *CO);
 
 
+/**
+ * Send TPDOs with transmission type 253, which received Remote Transmission
+ * Request.
+ *
+ * Function may be called from external task, which is signaled by
+ * CO_TPDO_t::pFunctSignal, so TPDO is sent right after reception of RTR and
+ * not on next CO_process_TPDO(). It must be called from the same thread as
+ * CO_process_TPDO().
+ *
+ * @param CO This object
+ */
+void CO_process_TPDO_RTR(CO_t *CO);
+
+
 /** @} */
 #endif
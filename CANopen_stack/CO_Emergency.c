@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 
@@ -106,6 +107,7 @@ CO_ReturnError_t CO_EM_init(
         CO_EM_t                *em,
         CO_EMpr_t              *emPr,
         CO_SDO_t               *SDO,
+        CO_timerWheel_t        *timers,
         uint8_t                *errorStatusBits,
         uint8_t                 errorStatusBitsSize,
         uint8_t                *errorRegister,
@@ -136,7 +138,8 @@ CO_ReturnError_t CO_EM_init(
     emPr->preDefErr             = preDefErr;
     emPr->preDefErrSize         = preDefErrSize;
     emPr->preDefErrNoOfErrors   = 0U;
-    emPr->inhibitEmTimer        = 0U;
+    emPr->timers                = timers;
+    CO_timer_init(&emPr->inhibitEmTimer, NULL, NULL);
 
     /* clear error status bits */
     for(i=0U; i<errorStatusBitsSize; i++){
@@ -166,7 +169,6 @@ CO_ReturnError_t CO_EM_init(
 void CO_EM_process(
         CO_EMpr_t              *emPr,
         CO_bool_t               NMTisPreOrOperational,
-        uint16_t                timeDifference_100us,
         uint16_t                emInhTime)
 {
 
@@ -193,15 +195,10 @@ void CO_EM_process(
     }
     *emPr->errorRegister = (*emPr->errorRegister & 0xEEU) | errorRegister;
 
-    /* inhibit time */
-    if(emPr->inhibitEmTimer < emInhTime){
-        emPr->inhibitEmTimer += timeDifference_100us;
-    }
-
     /* send Emergency message. */
     if(     NMTisPreOrOperational &&
-            !emPr->CANtxBuff->bufferFull &&
-            emPr->inhibitEmTimer >= emInhTime &&
+            !CO_FLAG_READ(emPr->CANtxBuff->bufferFull) &&
+            !CO_timer_isRunning(&emPr->inhibitEmTimer) &&
             (em->bufReadPtr != em->bufWritePtr || em->bufFull))
     {
         uint32_t preDEF;    /* preDefinedErrorField */
@@ -214,11 +211,13 @@ void CO_EM_process(
         CO_memcpy((uint8_t*)&preDEF, em->bufReadPtr, 4U);
         em->bufReadPtr += 8;
 
-        /* Update read buffer pointer and reset inhibit timer */
+        /* Update read buffer pointer and start inhibit timer */
         if(em->bufReadPtr == em->bufEnd){
             em->bufReadPtr = em->buf;
         }
-        emPr->inhibitEmTimer = 0U;
+        if(emInhTime != 0U){
+            CO_timer_start(emPr->timers, &emPr->inhibitEmTimer, ((uint32_t)emInhTime + 9U) / 10U);
+        }
 
         /* verify message buffer overflow, then clear full flag */
         if(em->bufFull == 2U){
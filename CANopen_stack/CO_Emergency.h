@@ -29,6 +29,8 @@
 #ifndef CO_EMERGENCY_H
 #define CO_EMERGENCY_H
 
+#include "CO_timer.h"
+
 
 /**
  * @defgroup CO_Emergency Emergency
@@ -323,7 +325,8 @@ typedef struct{
     uint32_t           *preDefErr;      /**< From CO_EM_init() */
     uint8_t             preDefErrSize;  /**< From CO_EM_init() */
     uint8_t             preDefErrNoOfErrors;/**< Number of active errors in preDefErr */
-    uint16_t            inhibitEmTimer; /**< Internal timer for emergency message */
+    CO_timer_t          inhibitEmTimer; /**< Runs during inhibit time after emergency message is sent */
+    CO_timerWheel_t    *timers;         /**< From CO_EM_init() */
     CO_EM_t            *em;             /**< CO_EM_t sub object is included here */
     CO_CANmodule_t     *CANdev;         /**< From CO_EM_init() */
     CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer */
@@ -339,6 +342,7 @@ typedef struct{
  * @param em Emergency object defined separately. Will be included in emPr and
  * initialized too.
  * @param SDO SDO server object.
+ * @param timers Timer wheel processed by CO_process().
  * @param errorStatusBits Pointer to _Error Status Bits_ array from Object Dictionary
  * (manufacturer specific section). See @ref CO_EM_errorStatusBits.
  * @param errorStatusBitsSize Total size of the above array. Must be >= 6.
@@ -356,6 +360,7 @@ CO_ReturnError_t CO_EM_init(
         CO_EM_t                *em,
         CO_EMpr_t              *emPr,
         CO_SDO_t               *SDO,
+        CO_timerWheel_t        *timers,
         uint8_t                *errorStatusBits,
         uint8_t                 errorStatusBitsSize,
         uint8_t                *errorRegister,
@@ -375,13 +380,12 @@ CO_ReturnError_t CO_EM_init(
  *
  * @param emPr This object.
  * @param NMTisPreOrOperational True if this node is NMT_PRE_OPERATIONAL or NMT_OPERATIONAL.
- * @param timeDifference_100us Time difference from previous function call in [100 * microseconds].
  * @param emInhTime _Inhibit time EMCY_ (object dictionary, index 0x1015).
+ * It is rounded up to whole milliseconds.
  */
 void CO_EM_process(
         CO_EMpr_t              *emPr,
         CO_bool_t               NMTisPreOrOperational,
-        uint16_t                timeDifference_100us,
         uint16_t                emInhTime);
 
 
@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
@@ -46,14 +47,38 @@ static void CO_HBcons_receive(void *object, const CO_CANrxMsg_t *msg){
     HBconsNode = (CO_HBconsNode_t*) object; /* this is the correct pointer type of the first argument */
 
     /* verify message length and message overflow (previous message was not processed yet) */
-    if((msg->DLC == 1) && !HBconsNode->CANrxNew){
+    if((msg->DLC == 1) && !CO_FLAG_READ(HBconsNode->CANrxNew)){
         /* copy data and set 'new message' flag */
         HBconsNode->NMTstate = msg->data[0];
-        HBconsNode->CANrxNew = CO_true;
+#ifdef CO_CAN_RX_TIMESTAMP
+        HBconsNode->timestamp = CO_CANrxMsg_readTimestamp(msg);
+#endif
+        CO_FLAG_SET(HBconsNode->CANrxNew);
     }
 }
 
 
+/*
+ * Report Heartbeat consumer timeout.
+ *
+ * Function is called by the timer wheel, when timeoutTimer of the monitored
+ * node expires. CO_process() processes the timer wheel before
+ * CO_HBconsumer_process(), so heartbeat may be received, but not processed
+ * yet. It is not a timeout then, CO_HBconsumer_process() restarts the timer.
+ *
+ * @param object Pointer to monitored node.
+ */
+static void CO_HBcons_timeout(void *object){
+    CO_HBconsNode_t *monitoredNode = (CO_HBconsNode_t*)object;
+
+    if(CO_FLAG_READ(monitoredNode->CANrxNew) && monitoredNode->NMTstate != 0){
+        return;
+    }
+    CO_errorReport(monitoredNode->em, CO_EM_HEARTBEAT_CONSUMER, CO_EMC_HEARTBEAT, monitoredNode->index);
+    monitoredNode->NMTstate = 0;
+}
+
+
 /*
  * Configure one monitored node.
  */
@@ -73,6 +98,7 @@ static void CO_HBcons_monitoredNodeConfig(
     monitoredNode->time = (uint16_t)HBconsTime;
     monitoredNode->NMTstate = 0;
     monitoredNode->monStarted = 0;
+    CO_timer_stop(&monitoredNode->timeoutTimer);
 
     /* is channel used */
     if(NodeID && monitoredNode->time){
@@ -150,6 +176,7 @@ int16_t CO_HBconsumer_init(
         CO_HBconsumer_t        *HBcons,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_timerWheel_t        *timers,
         const uint32_t          HBconsTime[],
         CO_HBconsNode_t         monitoredNodes[],
         uint8_t                 numberOfMonitoredNodes,
@@ -160,6 +187,7 @@ int16_t CO_HBconsumer_init(
 
     /* Configure object variables */
     HBcons->em = em;
+    HBcons->timers = timers;
     HBcons->HBconsTime = HBconsTime;
     HBcons->monitoredNodes = monitoredNodes;
     HBcons->numberOfMonitoredNodes = numberOfMonitoredNodes;
@@ -167,8 +195,12 @@ int16_t CO_HBconsumer_init(
     HBcons->CANdevRx = CANdevRx;
     HBcons->CANdevRxIdxStart = CANdevRxIdxStart;
 
-    for(i=0; i<HBcons->numberOfMonitoredNodes; i++)
+    for(i=0; i<HBcons->numberOfMonitoredNodes; i++){
+        monitoredNodes[i].index = i;
+        monitoredNodes[i].em = em;
+        CO_timer_init(&monitoredNodes[i].timeoutTimer, CO_HBcons_timeout, (void*)&monitoredNodes[i]);
         CO_HBcons_monitoredNodeConfig(HBcons, i, HBcons->HBconsTime[i]);
+    }
 
     /* Configure Object dictionary entry at index 0x1016 */
     CO_OD_configure(SDO, OD_H1016_CONSUMER_HB_TIME, CO_ODF_1016, (void*)HBcons, 0, 0);
@@ -180,8 +212,7 @@ int16_t CO_HBconsumer_init(
 /******************************************************************************/
 void CO_HBconsumer_process(
         CO_HBconsumer_t        *HBcons,
-        CO_bool_t               NMTisPreOrOperational,
-        uint16_t                timeDifference_ms)
+        CO_bool_t               NMTisPreOrOperational)
 {
     uint8_t i;
     uint8_t AllMonitoredOperationalCopy;
@@ -194,21 +225,30 @@ void CO_HBconsumer_process(
         for(i=0; i<HBcons->numberOfMonitoredNodes; i++){
             if(monitoredNode->time){/* is node monitored */
                 /* Verify if new Consumer Heartbeat message received */
-                if(monitoredNode->CANrxNew){
+                if(CO_FLAG_READ(monitoredNode->CANrxNew)){
                     if(monitoredNode->NMTstate){
-                        /* not a bootup message */
+                        /* not a bootup message, restart timer */
+                        uint16_t elapsed_ms = 0;
+
                         monitoredNode->monStarted = 1;
-                        monitoredNode->timeoutTimer = 0;  /* reset timer */
-                        timeDifference_ms = 0;
+#ifdef CO_CAN_RX_TIMESTAMP
+                        /* count timeout from reception, not from processing time */
+                        if(monitoredNode->timestamp != 0U){
+                            uint64_t now = CO_CANtimestampNow();
+                            if(now > monitoredNode->timestamp){
+                                uint64_t age_ms = (now - monitoredNode->timestamp) / 1000000U;
+                                elapsed_ms = (age_ms < monitoredNode->time) ? (uint16_t)age_ms : monitoredNode->time;
+                            }
+                        }
+#endif
+                        CO_timer_start(HBcons->timers, &monitoredNode->timeoutTimer, monitoredNode->time - elapsed_ms);
                     }
-                    monitoredNode->CANrxNew = CO_false;
+                    CO_FLAG_CLEAR(monitoredNode->CANrxNew);
                 }
-                /* Verify timeout */
-                if(monitoredNode->timeoutTimer < monitoredNode->time) monitoredNode->timeoutTimer += timeDifference_ms;
 
                 if(monitoredNode->monStarted){
-                    if(monitoredNode->timeoutTimer >= monitoredNode->time){
-                        CO_errorReport(HBcons->em, CO_EM_HEARTBEAT_CONSUMER, CO_EMC_HEARTBEAT, i);
+                    if(!CO_timer_isRunning(&monitoredNode->timeoutTimer)){
+                        /* timeout, reported by timer */
                         monitoredNode->NMTstate = 0;
                     }
                     else if(monitoredNode->NMTstate == 0){
@@ -225,8 +265,9 @@ void CO_HBconsumer_process(
     else{ /* not in (pre)operational state */
         for(i=0; i<HBcons->numberOfMonitoredNodes; i++){
             monitoredNode->NMTstate = 0;
-            monitoredNode->CANrxNew = CO_false;
+            CO_FLAG_CLEAR(monitoredNode->CANrxNew);
             monitoredNode->monStarted = 0;
+            CO_timer_stop(&monitoredNode->timeoutTimer);
             monitoredNode++;
         }
         AllMonitoredOperationalCopy = 0;
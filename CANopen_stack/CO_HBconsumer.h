@@ -29,6 +29,8 @@
 #ifndef CO_HB_CONS_H
 #define CO_HB_CONS_H
 
+#include "CO_timer.h"
+
 
 /**
  * @defgroup CO_HBconsumer Heartbeat consumer
@@ -53,9 +55,16 @@
 typedef struct{
     uint8_t             NMTstate;       /**< Of the remote node */
     uint8_t             monStarted;     /**< True after reception of the first Heartbeat mesage */
-    uint16_t            timeoutTimer;   /**< Time since last heartbeat received */
+    CO_timer_t          timeoutTimer;   /**< Started on each heartbeat received, expires on heartbeat timeout */
     uint16_t            time;           /**< Consumer heartbeat time from OD */
-    CO_bool_t           CANrxNew;       /**< True if new Heartbeat message received from the CAN bus */
+    uint8_t             index;          /**< Index of this node in CO_HBconsumer_t, used in emergency message */
+    CO_EM_t            *em;             /**< From CO_HBconsumer_init() */
+    CO_FLAG_t           CANrxNew;       /**< True if new Heartbeat message received from the CAN bus */
+#ifdef CO_CAN_RX_TIMESTAMP
+    /** Reception time of the last Heartbeat message in [nanoseconds], see
+    CO_CANrxMsg_readTimestamp(). Timeout is counted from this time. */
+    uint64_t            timestamp;
+#endif
 }CO_HBconsNode_t;
 
 
@@ -67,6 +76,7 @@ typedef struct{
  */
 typedef struct{
     CO_EM_t            *em;             /**< From CO_HBconsumer_init() */
+    CO_timerWheel_t    *timers;         /**< From CO_HBconsumer_init() */
     const uint32_t     *HBconsTime;     /**< From CO_HBconsumer_init() */
     CO_HBconsNode_t    *monitoredNodes; /**< From CO_HBconsumer_init() */
     uint8_t             numberOfMonitoredNodes; /**< From CO_HBconsumer_init() */
@@ -86,6 +96,7 @@ typedef struct{
  * @param HBcons This object will be initialized.
  * @param em Emergency object.
  * @param SDO SDO server object.
+ * @param timers Timer wheel processed by CO_process().
  * @param HBconsTime Pointer to _Consumer Heartbeat Time_ array
  * from Object Dictionary (index 0x1016). Size of array is equal to numberOfMonitoredNodes.
  * @param monitoredNodes Pointer to the externaly defined array of the same size
@@ -101,6 +112,7 @@ int16_t CO_HBconsumer_init(
         CO_HBconsumer_t        *HBcons,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_timerWheel_t        *timers,
         const uint32_t          HBconsTime[],
         CO_HBconsNode_t         monitoredNodes[],
         uint8_t                 numberOfMonitoredNodes,
@@ -111,16 +123,16 @@ int16_t CO_HBconsumer_init(
 /**
  * Process Heartbeat consumer object.
  *
- * Function must be called cyclically.
+ * Function must be called cyclically. It starts the timeout timer of each
+ * node, from which Heartbeat was received. Timeout is reported by the timer,
+ * when _timers_ from CO_HBconsumer_init() are processed.
  *
  * @param HBcons This object.
  * @param NMTisPreOrOperational True if this node is NMT_PRE_OPERATIONAL or NMT_OPERATIONAL.
- * @param timeDifference_ms Time difference from previous function call in [milliseconds].
  */
 void CO_HBconsumer_process(
         CO_HBconsumer_t        *HBcons,
-        CO_bool_t               NMTisPreOrOperational,
-        uint16_t                timeDifference_ms);
+        CO_bool_t               NMTisPreOrOperational);
 
 
 /** @} */
@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
@@ -72,10 +73,30 @@ static void CO_NMT_receive(void *object, const CO_CANrxMsg_t *msg){
 }
 
 
+/*
+ * Send Heartbeat message and start the timer for the next one.
+ *
+ * Function is called by the timer wheel, when HBproducerTimer expires.
+ *
+ * @param object Pointer to NMT object.
+ */
+static void CO_NMT_HBproducerExpired(void *object){
+    CO_NMT_t *NMT = (CO_NMT_t*)object;
+
+    NMT->HB_TXbuff->data[0] = NMT->operatingState;
+    CO_CANsend(NMT->HB_CANdev, NMT->HB_TXbuff);
+
+    if(NMT->HBtime != 0U){
+        CO_timer_start(NMT->timers, &NMT->HBproducerTimer, NMT->HBtime);
+    }
+}
+
+
 /******************************************************************************/
 int16_t CO_NMT_init(
         CO_NMT_t               *NMT,
         CO_EMpr_t              *emPr,
+        CO_timerWheel_t        *timers,
         uint8_t                 nodeId,
         uint16_t                firstHBTime,
         CO_CANmodule_t         *NMT_CANdev,
@@ -101,8 +122,10 @@ int16_t CO_NMT_init(
     NMT->nodeId                 = nodeId;
     NMT->firstHBTime            = firstHBTime;
     NMT->resetCommand           = 0;
-    NMT->HBproducerTimer        = 0xFFFF;
+    NMT->HBtime                 = 0;
     NMT->emPr                   = emPr;
+    NMT->timers                 = timers;
+    CO_timer_init(&NMT->HBproducerTimer, CO_NMT_HBproducerExpired, (void*)NMT);
 
     /* configure NMT CAN reception */
     CO_CANrxBufferInit(
@@ -166,7 +189,6 @@ void CO_NMT_blinkingProcess50ms(CO_NMT_t *NMT){
 /******************************************************************************/
 CO_NMT_reset_cmd_t CO_NMT_process(
         CO_NMT_t               *NMT,
-        uint16_t                timeDifference_ms,
         uint16_t                HBtime,
         uint32_t                NMTstartup,
         uint8_t                 errorRegister,
@@ -174,21 +196,29 @@ CO_NMT_reset_cmd_t CO_NMT_process(
 {
     uint8_t CANpassive;
 
-    NMT->HBproducerTimer += timeDifference_ms;
-
-    /* Heartbeat producer message & Bootup message */
-    if((HBtime && NMT->HBproducerTimer >= HBtime) || NMT->operatingState == CO_NMT_INITIALIZING){
-
-        NMT->HBproducerTimer = NMT->HBproducerTimer - HBtime;
-
+    /* Bootup message */
+    if(NMT->operatingState == CO_NMT_INITIALIZING){
         NMT->HB_TXbuff->data[0] = NMT->operatingState;
         CO_CANsend(NMT->HB_CANdev, NMT->HB_TXbuff);
 
-        if(NMT->operatingState == CO_NMT_INITIALIZING){
-            if(HBtime > NMT->firstHBTime) NMT->HBproducerTimer = HBtime - NMT->firstHBTime;
+        NMT->HBtime = HBtime;
+        if(HBtime != 0U){
+            CO_timer_start(NMT->timers, &NMT->HBproducerTimer,
+                (HBtime > NMT->firstHBTime) ? NMT->firstHBTime : HBtime);
+        }
+
+        if((NMTstartup & 0x04) == 0) NMT->operatingState = CO_NMT_OPERATIONAL;
+        else                         NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
+    }
 
-            if((NMTstartup & 0x04) == 0) NMT->operatingState = CO_NMT_OPERATIONAL;
-            else                         NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
+    /* Heartbeat producer time changed, restart the timer */
+    else if(HBtime != NMT->HBtime){
+        NMT->HBtime = HBtime;
+        if(HBtime != 0U){
+            CO_timer_start(NMT->timers, &NMT->HBproducerTimer, HBtime);
+        }
+        else{
+            CO_timer_stop(&NMT->HBproducerTimer);
         }
     }
 
@@ -272,8 +302,8 @@ CO_NMT_reset_cmd_t CO_NMT_process(
             }
 
             /* if operational state is lost, send HB immediatelly. */
-            if(NMT->operatingState != CO_NMT_OPERATIONAL)
-                NMT->HBproducerTimer = HBtime;
+            if(NMT->operatingState != CO_NMT_OPERATIONAL && HBtime != 0U)
+                CO_timer_start(NMT->timers, &NMT->HBproducerTimer, 0);
         }
     }
 
@@ -29,6 +29,8 @@
 #ifndef CO_NMT_HEARTBEAT_H
 #define CO_NMT_HEARTBEAT_H
 
+#include "CO_timer.h"
+
 
 /**
  * @defgroup CO_NMT_Heartbeat NMT and Heartbeat
@@ -140,9 +142,11 @@ typedef struct{
 
     uint8_t             resetCommand;   /**< If different than zero, device will reset */
     uint8_t             nodeId;         /**< CANopen Node ID of this device */
-    uint16_t            HBproducerTimer;/**< Internal timer for HB producer */
+    CO_timer_t          HBproducerTimer;/**< Timer for HB producer, expires, when next HB has to be sent */
+    uint16_t            HBtime;         /**< _Producer Heartbeat time_ from previous CO_NMT_process() */
     uint16_t            firstHBTime;    /**< From CO_NMT_init() */
     CO_EMpr_t          *emPr;           /**< From CO_NMT_init() */
+    CO_timerWheel_t    *timers;         /**< From CO_NMT_init() */
     CO_CANmodule_t     *HB_CANdev;      /**< From CO_NMT_init() */
     CO_CANtx_t         *HB_TXbuff;      /**< CAN transmit buffer */
 }CO_NMT_t;
@@ -155,6 +159,7 @@ typedef struct{
  *
  * @param NMT This object will be initialized.
  * @param emPr Emergency main object.
+ * @param timers Timer wheel processed by CO_process().
  * @param nodeId CANopen Node ID of this device.
  * @param firstHBTime Time between bootup and first heartbeat message in milliseconds.
  * If firstHBTime is greater than _Producer Heartbeat time_
@@ -171,6 +176,7 @@ typedef struct{
 int16_t CO_NMT_init(
         CO_NMT_t               *NMT,
         CO_EMpr_t              *emPr,
+        CO_timerWheel_t        *timers,
         uint8_t                 nodeId,
         uint16_t                firstHBTime,
         CO_CANmodule_t         *NMT_CANdev,
@@ -194,10 +200,10 @@ void CO_NMT_blinkingProcess50ms(CO_NMT_t *NMT);
 /**
  * Process received NMT and produce Heartbeat messages.
  *
- * Function must be called cyclically.
+ * Function must be called cyclically. Heartbeat messages are sent by the
+ * timer of this object, when _timers_ from CO_NMT_init() are processed.
  *
  * @param NMT This object.
- * @param timeDifference_ms Time difference from previous function call in [milliseconds].
  * @param HBtime _Producer Heartbeat time_ (object dictionary, index 0x1017).
  * @param NMTstartup _NMT startup behavior_ (object dictionary, index 0x1F80).
  * @param errorRegister _Error register_ (object dictionary, index 0x1001).
@@ -209,7 +215,6 @@ void CO_NMT_blinkingProcess50ms(CO_NMT_t *NMT);
  */
 CO_NMT_reset_cmd_t CO_NMT_process(
         CO_NMT_t               *NMT,
-        uint16_t                timeDifference_ms,
         uint16_t                HBtime,
         uint32_t                NMTstartup,
         uint8_t                 errorRegister,
@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
@@ -34,6 +35,14 @@
 #include "CO_PDO.h"
 #include <string.h>
 
+
+#if CO_RPDO_BUFFER_SIZE < 2 || CO_RPDO_BUFFER_SIZE > 128 || (CO_RPDO_BUFFER_SIZE & (CO_RPDO_BUFFER_SIZE - 1)) != 0
+    #error Wrong CO_RPDO_BUFFER_SIZE.
+#endif
+
+#define CO_RPDO_BUFFER_MASK     (CO_RPDO_BUFFER_SIZE - 1U)
+
+
 /*
  * Read received message from CAN module.
  *
@@ -48,24 +57,81 @@ static void CO_PDO_receive(void *object, const CO_CANrxMsg_t *msg){
 
     if( (RPDO->valid) &&
         (*RPDO->operatingState == CO_NMT_OPERATIONAL) &&
-        (msg->DLC >= RPDO->dataLength) &&
-        (!RPDO->CANrxNew))
+        (msg->DLC >= RPDO->dataLength))
     {
-        /* copy data and set 'new message' flag */
-        RPDO->CANrxData[0] = msg->data[0];
-        RPDO->CANrxData[1] = msg->data[1];
-        RPDO->CANrxData[2] = msg->data[2];
-        RPDO->CANrxData[3] = msg->data[3];
-        RPDO->CANrxData[4] = msg->data[4];
-        RPDO->CANrxData[5] = msg->data[5];
-        RPDO->CANrxData[6] = msg->data[6];
-        RPDO->CANrxData[7] = msg->data[7];
+        uint8_t used = (uint8_t)(RPDO->CANrxHead - RPDO->CANrxTail);
+        uint8_t last = (uint8_t)(RPDO->CANrxHead - 1U) & CO_RPDO_BUFFER_MASK;
+        CO_bool_t toggle = CO_false;
+        CO_bool_t overwrite;
+        uint8_t *data;
+
+        /* MPDO in other address mode or DAM MPDO for other node */
+        if(RPDO->MPDOmode == CO_MPDO_DAM){
+            uint8_t nodeId = msg->data[0] & 0x7FU;
+
+            if((msg->data[0] & 0x80U) == 0U || (nodeId != 0U && nodeId != RPDO->nodeId)) return;
+        }
+        else if(RPDO->MPDOmode == CO_MPDO_SAM && (msg->data[0] & 0x80U) != 0U){
+            return;
+        }
+
+        if(RPDO->RPDOCommPar->transmissionType <= 240U){
+            /* synchronous PDO: the latest message in each SYNC period */
+            toggle = RPDO->SYNC->CANrxToggle;
+            overwrite = (RPDO->CANrxToggle[last] == toggle) ? CO_true : CO_false;
+        }
+        else{
+            overwrite = RPDO->fifo ? CO_false : CO_true;
+        }
+        /* each MPDO carries different object */
+        if(RPDO->MPDOmode != 0U) overwrite = CO_false;
+        if(used == 0U) overwrite = CO_false;
+        else if(used >= CO_RPDO_BUFFER_SIZE) overwrite = CO_true;
+
+        /* overwrite the newest buffered message or take new buffer */
+        if(overwrite){
+            data = RPDO->CANrxBuffer[last];
+            if(RPDO->overflowCounter != NULL) (*RPDO->overflowCounter)++;
+        }
+        else{
+            last = RPDO->CANrxHead & CO_RPDO_BUFFER_MASK;
+            data = RPDO->CANrxBuffer[last];
+        }
 
-        RPDO->CANrxNew = 1;
+#if CO_CAN_DATA_MAX > 8U
+        CO_memcpy(data, msg->data, RPDO->dataLength);
+#else
+        data[0] = msg->data[0];
+        data[1] = msg->data[1];
+        data[2] = msg->data[2];
+        data[3] = msg->data[3];
+        data[4] = msg->data[4];
+        data[5] = msg->data[5];
+        data[6] = msg->data[6];
+        data[7] = msg->data[7];
+#endif
+        RPDO->CANrxToggle[last] = toggle;
+#ifdef CO_CAN_RX_TIMESTAMP
+        RPDO->CANrxTimestamp[last] = CO_CANrxMsg_readTimestamp(msg);
+#endif
+
+        if(!overwrite) RPDO->CANrxHead++;
     }
 }
 
 
+/*
+ * Discard all buffered messages of RPDO.
+ *
+ * @param RPDO RPDO object.
+ */
+static void CO_RPDOclearBuffer(CO_RPDO_t *RPDO){
+    CO_DISABLE_INTERRUPTS();
+    RPDO->CANrxTail = RPDO->CANrxHead;
+    CO_ENABLE_INTERRUPTS();
+}
+
+
 /*
  * Configure RPDO Communication parameter.
  *
@@ -94,7 +160,7 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
     else{
         ID = 0;
         RPDO->valid = CO_false;
-        RPDO->CANrxNew = 0;
+        CO_RPDOclearBuffer(RPDO);
     }
     r = CO_CANrxBufferInit(
             RPDO->CANdevRx,         /* CAN device */
@@ -106,7 +172,86 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
             CO_PDO_receive);        /* this function will process received message */
     if(r != CO_ERROR_NO){
         RPDO->valid = CO_false;
-        RPDO->CANrxNew = 0;
+        CO_RPDOclearBuffer(RPDO);
+    }
+}
+
+
+/*
+ * Read received Remote Transmission Request for TPDO from CAN module.
+ *
+ * Function will be called (by CAN receive interrupt) every time, when CAN
+ * message with correct identifier will be received. Data sampled at SYNC are
+ * sent from here. Current data must be read from Object Dictionary, so type
+ * 253 TPDO is only marked here and signaled with pFunctSignal. It is sent by
+ * CO_TPDO_processRTR(). For more information
+ * and description of parameters see file CO_driver.h.
+ */
+static void CO_TPDO_receiveRTR(void *object, const CO_CANrxMsg_t *msg){
+    CO_TPDO_t *TPDO;
+
+    TPDO = (CO_TPDO_t*)object;   /* this is the correct pointer type of the first argument */
+    (void)msg;
+
+    if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL){
+        if(TPDO->TPDOCommPar->transmissionType == 253){
+            /* send current data from CO_TPDO_process() */
+            CO_FLAG_SET(TPDO->RTRreceived);
+#ifdef CO_TPDO_CHANGE_DRIVEN
+            CO_TPDOmarkDirty(TPDO);
+#endif
+            /* Optional signal to RTOS, which can resume task, which sends TPDO. */
+            if(TPDO->pFunctSignal != NULL){
+                TPDO->pFunctSignal(TPDO->functArg);
+            }
+        }
+        else if(TPDO->RTRsampled){
+            /* send data sampled at SYNC */
+            CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+        }
+    }
+}
+
+
+/*
+ * Configure reception of Remote Transmission Request for TPDO.
+ *
+ * Function is called from CO_TPDOconfigCom() or when transmission type
+ * changes. RTR is received only by valid TPDO with transmission type 252 or
+ * 253, if bit 30 of its COB-ID allows it. Otherwise CAN rx buffer is
+ * configured with identifier 0.
+ *
+ * @param TPDO TPDO object.
+ * @param COB_IDUsedByTPDO _TPDO communication parameter_, _COB-ID for PDO_ variable
+ * from Object dictionary (index 0x1800+, subindex 1).
+ * @param transmissionType _TPDO communication parameter_, _transmission type_
+ * variable from Object dictionary (index 0x1800+, subindex 2).
+ */
+static void CO_TPDOconfigRTR(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t transmissionType){
+    uint16_t ID = 0;
+    CO_ReturnError_t r;
+
+    TPDO->RTRsampled = CO_false;
+    CO_FLAG_CLEAR(TPDO->RTRreceived);
+    if(TPDO->CANdevRx == NULL) return;
+
+    if(TPDO->valid && (COB_IDUsedByTPDO & 0x40000000L) == 0 &&
+       (transmissionType == 252 || transmissionType == 253))
+    {
+        ID = (uint16_t)COB_IDUsedByTPDO & 0x7FF;
+        /* is used default COB-ID? */
+        if(ID == TPDO->defaultCOB_ID) ID += TPDO->nodeId;
+    }
+    r = CO_CANrxBufferInit(
+            TPDO->CANdevRx,         /* CAN device */
+            TPDO->CANdevRxIdx,      /* rx buffer index */
+            ID,                     /* CAN identifier */
+            0x7FF,                  /* mask */
+            1,                      /* rtr */
+            (void*)TPDO,            /* object passed to receive function */
+            CO_TPDO_receiveRTR);    /* this function will process received message */
+    if(r != CO_ERROR_NO){
+        TPDO->valid = CO_false;
     }
 }
 
@@ -117,8 +262,8 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
  * Function is called from commuincation reset or when parameter changes.
  *
  * Function configures following variable from CO_TPDO_t: _valid_. It also
- * configures CAN tx buffer. If configuration fails, emergency message is send
- * and device is not able to enter NMT operational.
+ * configures CAN tx buffer and CAN rx buffer for RTR. If configuration fails,
+ * emergency message is send and device is not able to enter NMT operational.
  *
  * @param TPDO TPDO object.
  * @param COB_IDUsedByTPDO _TPDO communication parameter_, _COB-ID for PDO_ variable
@@ -152,6 +297,8 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
     if(TPDO->CANtxBuff == 0){
         TPDO->valid = CO_false;
     }
+
+    CO_TPDOconfigRTR(TPDO, COB_IDUsedByTPDO, TPDO->TPDOCommPar->transmissionType);
 }
 
 
@@ -163,9 +310,12 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
  * @param SDO SDO object.
  * @param map PDO mapping parameter.
  * @param R_T 0 for RPDO map, 1 for TPDO map.
- * @param ppData Pointer to returning parameter: pointer to data of mapped variable.
- * @param pLength Pointer to returning parameter: *add* length of mapped variable.
- * @param pSendIfCOSFlags Pointer to returning parameter: sendIfCOSFlags variable.
+ * @param ppData Pointer to returning parameter: pointer to data of mapped variable,
+ * NULL for dummy entry in RPDO.
+ * @param pBitLength Pointer to returning parameter: *add* length of mapped
+ * variable in bits.
+ * @param pSendIfCOSMask Pointer to returning parameter: sendIfCOSMask byte
+ * array, bits of the variable are set if it detects COS. May be NULL.
  * @param pIsMultibyteVar Pointer to returning parameter: true for multibyte variable.
  *
  * @return 0 on success, otherwise SDO abort code.
@@ -175,45 +325,49 @@ static uint32_t CO_PDOfindMap(
         uint32_t                map,
         uint8_t                 R_T,
         uint8_t               **ppData,
-        uint8_t                *pLength,
-        uint8_t                *pSendIfCOSFlags,
+        uint16_t               *pBitLength,
+        uint8_t                *pSendIfCOSMask,
         uint8_t                *pIsMultibyteVar)
 {
     uint16_t entryNo;
     uint16_t index;
     uint8_t subIndex;
     uint8_t dataLen;
+    uint8_t dataBytes;
+    uint16_t startBit;
     uint8_t objectLen;
     uint8_t attr;
 
     index = (uint16_t)(map>>16);
     subIndex = (uint8_t)(map>>8);
     dataLen = (uint8_t) map;   /* data length in bits */
+    dataBytes = (dataLen + 7) >> 3;
+    startBit = *pBitLength;
+    *pBitLength += dataLen;
 
-    /* data length must be byte aligned */
-    if(dataLen&0x07) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
-
-    dataLen >>= 3;    /* new data length is in bytes */
-    *pLength += dataLen;
+    /* total PDO length can not be more than CAN message */
+    if(*pBitLength > CO_CAN_DATA_MAX*8) return CO_SDO_AB_MAP_LEN;  /* The number and length of the objects to be mapped would exceed PDO length. */
 
-    /* total PDO length can not be more than 8 bytes */
-    if(*pLength > 8) return CO_SDO_AB_MAP_LEN;  /* The number and length of the objects to be mapped would exceed PDO length. */
+    /* variable, which is not byte aligned, is packed inside 64-bit window */
+    if(((startBit | dataLen) & 0x07) && (startBit & 0x07) + dataLen > 64)
+        return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
 
     /* is there a reference to dummy entries */
     if(index <=7 && subIndex == 0){
-        static uint32_t dummyTX = 0;
-        static uint32_t dummyRX;
-        uint8_t dummySize = 4;
+        static const uint32_t dummyTX = 0;
+        uint8_t dummySize = 32;
 
-        if(index<2) dummySize = 0;
-        else if(index==2 || index==5) dummySize = 1;
-        else if(index==3 || index==6) dummySize = 2;
+        if(index<1) dummySize = 0;
+        else if(index==1) dummySize = 1;
+        else if(index==2 || index==5) dummySize = 8;
+        else if(index==3 || index==6) dummySize = 16;
 
         /* is size of variable big enough for map */
         if(dummySize < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
 
-        /* Data and ODE pointer */
-        if(R_T == 0) *ppData = (uint8_t*) &dummyRX;
+        /* Data and ODE pointer. Received data are written into RPDO object,
+         * see CO_RPDOconfigMap(), zeros are transmitted. */
+        if(R_T == 0) *ppData = NULL;
         else         *ppData = (uint8_t*) &dummyTX;
 
         return 0;
@@ -234,7 +388,7 @@ static uint32_t CO_PDOfindMap(
 
     /* is size of variable big enough for map */
     objectLen = CO_OD_getLength(SDO, entryNo, subIndex);
-    if(objectLen < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    if(objectLen < dataBytes) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
 
     /* mark multibyte variable */
     *pIsMultibyteVar = (attr&CO_ODA_MB_VALUE) ? 1 : 0;
@@ -244,15 +398,15 @@ static uint32_t CO_PDOfindMap(
 #ifdef CO_BIG_ENDIAN
     /* skip unused MSB bytes */
     if(*pIsMultibyteVar){
-        *ppData += objectLen - dataLen;
+        *ppData += objectLen - dataBytes;
     }
 #endif
 
-    /* setup change of state flags */
-    if(attr&CO_ODA_TPDO_DETECT_COS){
-        int16_t i;
-        for(i=*pLength-dataLen; i<*pLength; i++){
-            *pSendIfCOSFlags |= 1<<i;
+    /* setup change of state mask */
+    if(pSendIfCOSMask != NULL && (attr&CO_ODA_TPDO_DETECT_COS)){
+        uint16_t i;
+        for(i=startBit; i<*pBitLength; i++){
+            pSendIfCOSMask[i>>3] |= 1<<(i&7);
         }
     }
 
@@ -260,13 +414,269 @@ static uint32_t CO_PDOfindMap(
 }
 
 
+/*
+ * Add mapped variable to the PDO copy plan.
+ *
+ * Function is called from CO_R(T)PDOconfigMap. Variable is merged with the
+ * previous span, if it follows it directly in memory.
+ *
+ * @param span Array of spans.
+ * @param pSpanCount Pointer to number of used spans.
+ * @param pData Pointer to data of mapped variable.
+ * @param offset Offset of variable inside PDO.
+ * @param length Length of variable inside PDO.
+ * @param MBvar True for multibyte variable.
+ */
+static void CO_PDOaddSpan(
+        CO_PDOspan_t           *span,
+        uint8_t                *pSpanCount,
+        uint8_t                *pData,
+        uint8_t                 offset,
+        uint8_t                 length,
+        uint8_t                 MBvar)
+{
+#ifdef CO_BIG_ENDIAN
+    uint8_t swap = (MBvar && length > 1) ? 1 : 0;
+#else
+    uint8_t swap = 0;
+    (void)MBvar;
+#endif
+
+    /* merge with previous span, if variable follows it in memory and in PDO */
+    if(*pSpanCount > 0){
+        CO_PDOspan_t *prev = &span[*pSpanCount - 1];
+#ifdef CO_BIG_ENDIAN
+        uint8_t prevSwap = prev->swap;
+#else
+        uint8_t prevSwap = 0;
+#endif
+
+        if(!prevSwap && !swap && prev->pData + prev->length == pData
+                && prev->offset + prev->length == offset){
+            prev->length += length;
+            return;
+        }
+    }
+
+    span[*pSpanCount].pData = pData;
+    span[*pSpanCount].mask = 0;
+    span[*pSpanCount].offset = offset;
+    span[*pSpanCount].length = length;
+    span[*pSpanCount].shift = 0;
+#ifdef CO_BIG_ENDIAN
+    span[*pSpanCount].swap = swap;
+#endif
+    (*pSpanCount)++;
+}
+
+
+/*
+ * Add mapped variable, which is not byte aligned, to the PDO copy plan.
+ *
+ * Function is called from CO_R(T)PDOconfigMap. Bit spans are stored from the
+ * end of the span array. PDO window is moved back from the end of PDO data
+ * buffer, so all eight bytes can be loaded. CO_PDOfindMap verified, that
+ * variable fits into the window.
+ *
+ * @param span Array of 8 spans.
+ * @param pBitSpanCount Pointer to number of used bit spans.
+ * @param pData Pointer to data of mapped variable.
+ * @param startBit Bit offset of variable inside PDO.
+ * @param bitLength Length of variable inside PDO in bits.
+ * @param MBvar True for multibyte variable.
+ */
+static void CO_PDOaddBitSpan(
+        CO_PDOspan_t           *span,
+        uint8_t                *pBitSpanCount,
+        uint8_t                *pData,
+        uint16_t                startBit,
+        uint8_t                 bitLength,
+        uint8_t                 MBvar)
+{
+    CO_PDOspan_t *s;
+    uint8_t offset = (uint8_t)(startBit >> 3);
+
+    if(offset > CO_CAN_DATA_MAX - 8) offset = CO_CAN_DATA_MAX - 8;
+
+    (*pBitSpanCount)++;
+    s = &span[8 - *pBitSpanCount];
+
+    s->pData = pData;
+    s->offset = offset;
+    s->length = (bitLength + 7) >> 3;
+    s->shift = (uint8_t)(startBit - ((uint16_t)offset << 3));
+    s->mask = ((((uint64_t)2) << (bitLength - 1)) - 1) << s->shift;
+#ifdef CO_BIG_ENDIAN
+    s->swap = MBvar;
+#else
+    (void)MBvar;
+#endif
+}
+
+
+#if defined(RPDO_CALLS_EXTENSION) || defined(TPDO_CALLS_EXTENSION)
+/*
+ * Resolve mapped variable for calling its OD extension.
+ *
+ * Function is called from CO_R(T)PDOconfigMap after CO_PDOfindMap verified
+ * the map, so PDO processing does not need to search Object Dictionary.
+ * Pointer to the extension is stored, because CO_OD_configure() may register
+ * the function after PDO mapping is configured.
+ *
+ * @param SDO SDO object.
+ * @param map PDO mapping parameter.
+ * @param mapExt Pointer to returning parameter.
+ *
+ * @return 1 if mapExt is valid, 0 for dummy entry or if OD has no extensions.
+ */
+static uint8_t CO_PDOfindMapExt(
+        CO_SDO_t               *SDO,
+        uint32_t                map,
+        CO_PDOmapExt_t         *mapExt)
+{
+    uint16_t entryNo;
+    uint16_t index = (uint16_t)(map>>16);
+    uint8_t subIndex = (uint8_t)(map>>8);
+
+    if(SDO->ODExtensions == NULL || (index <=7 && subIndex == 0)) return 0;
+
+    entryNo = CO_OD_find(SDO, index);
+    mapExt->ext = &SDO->ODExtensions[entryNo];
+    mapExt->pData = CO_OD_getDataPointer(SDO, entryNo, subIndex);
+    mapExt->index = index;
+    mapExt->attribute = CO_OD_getAttribute(SDO, entryNo, subIndex);
+    mapExt->length = CO_OD_getLength(SDO, entryNo, subIndex);
+    mapExt->subIndex = subIndex;
+
+    return 1;
+}
+
+
+/*
+ * Call OD extensions of mapped variables.
+ *
+ * @param mapExt Array of variables, resolved by CO_PDOfindMapExt.
+ * @param count Number of variables in array.
+ * @param reading True for TPDO, false for RPDO.
+ */
+static void CO_PDOcallExt(
+        const CO_PDOmapExt_t   *mapExt,
+        uint8_t                 count,
+        CO_bool_t               reading)
+{
+    CO_ODF_arg_t ODF_arg;
+
+    for(; count>0; count--, mapExt++){
+        CO_OD_extension_t *ext = mapExt->ext;
+
+        if(ext->pODFunc == NULL) continue;
+
+        ODF_arg.object = ext->object;
+        ODF_arg.data = (uint8_t*) mapExt->pData;
+        ODF_arg.ODdataStorage = NULL;
+        ODF_arg.dataLength = mapExt->length;
+        ODF_arg.attribute = mapExt->attribute;
+        ODF_arg.pFlags = (ext->flags != NULL) ? &ext->flags[mapExt->subIndex] : NULL;
+        ODF_arg.index = mapExt->index;
+        ODF_arg.subIndex = mapExt->subIndex;
+        ODF_arg.reading = reading;
+        ODF_arg.firstSegment = CO_false;
+        ODF_arg.lastSegment = CO_false;
+        ODF_arg.dataLengthTotal = 0;
+        ext->pODFunc(&ODF_arg);
+    }
+}
+#endif
+
+
+#ifdef CO_TPDO_CHANGE_DRIVEN
+/*
+ * Add TPDO to the list of TPDOs, which will be processed in the next cycle.
+ */
+static void CO_TPDOnotify_mark(CO_TPDOnotify_t *notify, CO_TPDO_t *TPDO){
+    CO_DISABLE_INTERRUPTS();
+    if(!TPDO->dirty){
+        TPDO->dirty = CO_true;
+        TPDO->dirtyNext = notify->dirtyFirst;
+        notify->dirtyFirst = TPDO;
+    }
+    CO_ENABLE_INTERRUPTS();
+}
+
+
+/*
+ * Mark TPDO, when its timer expires.
+ *
+ * @param object TPDO object.
+ */
+static void CO_TPDOnotify_timerExpired(void *object){
+    CO_TPDO_t *TPDO = (CO_TPDO_t*)object;
+
+    CO_TPDOnotify_mark(TPDO->notify, TPDO);
+}
+
+
+/*
+ * Add references from mapped variables to TPDO to the lists in notify->mapRef
+ * or remove them from there.
+ *
+ * @param TPDO TPDO object with initialized _notify_.
+ * @param link True for adding, false for removing.
+ */
+static void CO_TPDOlinkMapRef(CO_TPDO_t *TPDO, CO_bool_t link){
+    CO_TPDOmapRef_t **mapRef = TPDO->notify->mapRef;
+    int16_t i;
+
+    CO_DISABLE_INTERRUPTS();
+    for(i=0; i<TPDO->mapRefCount; i++){
+        CO_TPDOmapRef_t *ref = &TPDO->mapRef[i];
+        CO_TPDOmapRef_t **pp = &mapRef[ref->entryNo];
+
+        if(link){
+            ref->next = *pp;
+            *pp = ref;
+        }
+        else{
+            while(*pp != NULL && *pp != ref) pp = &(*pp)->next;
+            if(*pp != NULL) *pp = ref->next;
+        }
+    }
+    CO_ENABLE_INTERRUPTS();
+}
+
+
+/*
+ * Mark TPDOs, which map written variable.
+ *
+ * @param notify TPDO notification object.
+ * @param entryNo OD entry of the variable, as returned from CO_OD_find().
+ * @param subIndex Sub-index of the variable.
+ */
+static void CO_TPDOnotify_entry(CO_TPDOnotify_t *notify, uint16_t entryNo, uint8_t subIndex){
+    CO_TPDOmapRef_t *ref;
+
+    for(ref = notify->mapRef[entryNo]; ref != NULL; ref = ref->next){
+        if(ref->subIndex == subIndex) CO_TPDOnotify_mark(notify, ref->TPDO);
+    }
+}
+
+
+/*
+ * Function is called from SDO server after OD variable is written.
+ */
+static void CO_TPDOnotify_SDOwritten(void *object, uint16_t entryNo, uint8_t subIndex){
+    CO_TPDOnotify_entry((CO_TPDOnotify_t*)object, entryNo, subIndex);
+}
+#endif
+
+
 /*
  * Configure RPDO Mapping parameter.
  *
  * Function is called from communication reset or when parameter changes.
  *
- * Function configures following variables from CO_RPDO_t: _dataLength_ and
- * _mapPointer_.
+ * Function configures following variables from CO_RPDO_t: _dataLength_,
+ * _span_, _mapExt_ and _mapEntryNo_.
  *
  * @param RPDO RPDO object.
  * @param noOfMappedObjects Number of mapped object (from OD).
@@ -275,15 +685,30 @@ static uint32_t CO_PDOfindMap(
  */
 static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
     int16_t i;
-    uint8_t length = 0;
+    uint16_t length = 0;
     uint32_t ret = 0;
     const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
 
+    RPDO->spanCount = 0;
+    RPDO->bitSpanCount = 0;
+#ifdef RPDO_CALLS_EXTENSION
+    RPDO->mapExtCount = 0;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    RPDO->mapCount = 0;
+#endif
+
+    /* MPDO has no copy plan, objects are addressed by message */
+    if(noOfMappedObjects == CO_MPDO_SAM || noOfMappedObjects == CO_MPDO_DAM){
+        RPDO->MPDOmode = noOfMappedObjects;
+        RPDO->dataLength = 8;
+        return 0;
+    }
+    RPDO->MPDOmode = 0;
+
     for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
         uint8_t* pData;
-        uint8_t dummy = 0;
-        uint8_t prevLength = length;
+        uint16_t prevLength = length;
         uint8_t MBvar;
         uint32_t map = *(pMap++);
 
@@ -294,33 +719,48 @@ static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
                 0,
                 &pData,
                 &length,
-                &dummy,
+                NULL,
                 &MBvar);
         if(ret){
             length = 0;
             CO_errorReport(RPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
             break;
         }
+#ifdef RPDO_CALLS_EXTENSION
+        if(CO_PDOfindMapExt(RPDO->SDO, map, &RPDO->mapExt[RPDO->mapExtCount]))
+            RPDO->mapExtCount++;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+        if(pData != NULL){
+            RPDO->mapEntryNo[RPDO->mapCount] = CO_OD_find(RPDO->SDO, (uint16_t)(map>>16));
+            RPDO->mapSubIndex[RPDO->mapCount] = (uint8_t)(map>>8);
+            RPDO->mapCount++;
+        }
+#endif
 
-        /* write PDO data pointers */
-#ifdef CO_BIG_ENDIAN
-        if(MBvar){
-            for(j=length-1; j>=prevLength; j--)
-                RPDO->mapPointer[j] = pData++;
+        /* add to copy plan, received data of dummy entries are discarded */
+        if(pData == NULL || length == prevLength){
+            continue;
         }
-        else{
-            for(j=prevLength; j<length; j++)
-                RPDO->mapPointer[j] = pData++;
+        else if(((prevLength | length) & 0x07) == 0){
+            CO_PDOaddSpan(RPDO->span, &RPDO->spanCount, pData, prevLength>>3, (length - prevLength)>>3, MBvar);
         }
-#else
-        for(j=prevLength; j<length; j++){
-            RPDO->mapPointer[j] = pData++;
+        else{
+            CO_PDOaddBitSpan(RPDO->span, &RPDO->bitSpanCount, pData, prevLength, length - prevLength, MBvar);
         }
-#endif
-
     }
 
-    RPDO->dataLength = length;
+    RPDO->dataLength = (length + 7) >> 3;
+    if(ret){
+        RPDO->spanCount = 0;
+        RPDO->bitSpanCount = 0;
+    }
+#ifdef RPDO_CALLS_EXTENSION
+    if(ret) RPDO->mapExtCount = 0;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    if(ret) RPDO->mapCount = 0;
+#endif
 
     return ret;
 }
@@ -332,7 +772,7 @@ static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
  * Function is called from communication reset or when parameter changes.
  *
  * Function configures following variables from CO_TPDO_t: _dataLength_,
- * _mapPointer_ and _sendIfCOSFlags_.
+ * _span_, _sendIfCOSMask_, _mapExt_ and _mapRef_.
  *
  * @param TPDO TPDO object.
  * @param noOfMappedObjects Number of mapped object (from OD).
@@ -341,16 +781,36 @@ static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
  */
 static uint32_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedObjects){
     int16_t i;
-    uint8_t length = 0;
+    uint16_t length = 0;
     uint32_t ret = 0;
     const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
 
-    TPDO->sendIfCOSFlags = 0;
+    TPDO->spanCount = 0;
+    TPDO->bitSpanCount = 0;
+    for(i=0; i<(int16_t)(sizeof(TPDO->sendIfCOSMask)/sizeof(TPDO->sendIfCOSMask[0])); i++){
+        TPDO->sendIfCOSMask[i] = 0;
+    }
+#ifdef TPDO_CALLS_EXTENSION
+    TPDO->mapExtCount = 0;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    if(TPDO->notify != NULL) CO_TPDOlinkMapRef(TPDO, CO_false);
+    TPDO->mapRefCount = 0;
+#endif
+
+    /* MPDO has no copy plan, objects are packed into message when sent */
+    TPDO->MPDOmode = 0;
+    TPDO->scanEntry = 0;
+    TPDO->scanOffset = 0;
+    if(noOfMappedObjects == CO_MPDO_SAM || noOfMappedObjects == CO_MPDO_DAM){
+        TPDO->MPDOmode = noOfMappedObjects;
+        noOfMappedObjects = 0;
+        length = 64;
+    }
 
     for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
         uint8_t* pData;
-        uint8_t prevLength = length;
+        uint16_t prevLength = length;
         uint8_t MBvar;
         uint32_t map = *(pMap++);
 
@@ -361,33 +821,61 @@ static uint32_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedObjects){
                 1,
                 &pData,
                 &length,
-                &TPDO->sendIfCOSFlags,
+                (uint8_t*) TPDO->sendIfCOSMask,
                 &MBvar);
         if(ret){
             length = 0;
             CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
             break;
         }
+#ifdef TPDO_CALLS_EXTENSION
+        if(CO_PDOfindMapExt(TPDO->SDO, map, &TPDO->mapExt[TPDO->mapExtCount]))
+            TPDO->mapExtCount++;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+        /* only written variables with Change of State detection matter */
+        {
+            CO_TPDOmapRef_t *ref = &TPDO->mapRef[TPDO->mapRefCount];
+
+            ref->TPDO = TPDO;
+            ref->entryNo = CO_OD_find(TPDO->SDO, (uint16_t)(map>>16));
+            ref->subIndex = (uint8_t)(map>>8);
+            if(CO_OD_getAttribute(TPDO->SDO, ref->entryNo, ref->subIndex) & CO_ODA_TPDO_DETECT_COS)
+                TPDO->mapRefCount++;
+        }
+#endif
 
-        /* write PDO data pointers */
-#ifdef CO_BIG_ENDIAN
-        if(MBvar){
-            for(j=length-1; j>=prevLength; j--)
-                TPDO->mapPointer[j] = pData++;
+        /* add to copy plan */
+        if(length == prevLength){
+            continue;
         }
-        else{
-            for(j=prevLength; j<length; j++)
-                TPDO->mapPointer[j] = pData++;
+        else if(((prevLength | length) & 0x07) == 0){
+            CO_PDOaddSpan(TPDO->span, &TPDO->spanCount, pData, prevLength>>3, (length - prevLength)>>3, MBvar);
         }
-#else
-        for(j=prevLength; j<length; j++){
-            TPDO->mapPointer[j] = pData++;
+        else{
+            CO_PDOaddBitSpan(TPDO->span, &TPDO->bitSpanCount, pData, prevLength, length - prevLength, MBvar);
         }
-#endif
-
     }
 
-    TPDO->dataLength = length;
+    TPDO->dataLength = (length + 7) >> 3;
+    if(ret){
+        TPDO->spanCount = 0;
+        TPDO->bitSpanCount = 0;
+    }
+    /* unused bits of the last byte are transmitted as zero */
+    if(TPDO->CANtxBuff != NULL){
+        memset(TPDO->CANtxBuff->data, 0, sizeof(TPDO->CANtxBuff->data));
+    }
+#ifdef TPDO_CALLS_EXTENSION
+    if(ret) TPDO->mapExtCount = 0;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    if(ret) TPDO->mapRefCount = 0;
+    if(TPDO->notify != NULL){
+        CO_TPDOlinkMapRef(TPDO, CO_true);
+        CO_TPDOnotify_mark(TPDO->notify, TPDO);
+    }
+#endif
 
     return ret;
 }
@@ -450,6 +938,9 @@ static CO_SDO_abortCode_t CO_ODF_RPDOcom(CO_ODF_arg_t *ODF_arg){
         /* values from 241...253 are not valid */
         if(*value >= 241 && *value <= 253)
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+
+        /* buffered messages were received with different transmission type */
+        CO_RPDOclearBuffer(RPDO);
     }
 
     return CO_SDO_AB_NONE;
@@ -513,11 +1004,12 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
     else if(ODF_arg->subIndex == 2){   /* Transmission_type */
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
-        /* values from 241...253 are not valid */
-        if(*value >= 241 && *value <= 253)
+        /* values from 241...251 are not valid */
+        if(*value >= 241 && *value <= 251)
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
         TPDO->CANtxBuff->syncFlag = (*value <= 240) ? 1 : 0;
         TPDO->syncCounter = 255;
+        CO_TPDOconfigRTR(TPDO, TPDO->TPDOCommPar->COB_IDUsedByTPDO, *value);
     }
     else if(ODF_arg->subIndex == 3){   /* Inhibit_Time */
         /* if PDO is valid, value can not be changed */
@@ -543,6 +1035,14 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
     }
 
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    /* transmission type may change, process TPDO with new parameters */
+    if(TPDO->notify != NULL){
+        TPDO->notify->syncListValid = CO_false;
+        CO_TPDOnotify_mark(TPDO->notify, TPDO);
+    }
+#endif
+
     return CO_SDO_AB_NONE;
 }
 
@@ -580,7 +1080,7 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
     if(ODF_arg->subIndex == 0){
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
-        if(*value > 8)
+        if(*value > 8 && *value != CO_MPDO_SAM && *value != CO_MPDO_DAM)
             return CO_SDO_AB_VALUE_HIGH;  /* Value of parameter written too high. */
 
         /* configure mapping */
@@ -591,8 +1091,7 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
     else{
         uint32_t *value = (uint32_t*) ODF_arg->data;
         uint8_t* pData;
-        uint8_t length = 0;
-        uint8_t dummy = 0;
+        uint16_t length = 0;
         uint8_t MBvar;
 
         if(RPDO->dataLength)
@@ -605,7 +1104,7 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
                 0,
                &pData,
                &length,
-               &dummy,
+                NULL,
                &MBvar);
     }
 
@@ -646,7 +1145,7 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
     if(ODF_arg->subIndex == 0){
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
-        if(*value > 8)
+        if(*value > 8 && *value != CO_MPDO_SAM && *value != CO_MPDO_DAM)
             return CO_SDO_AB_VALUE_HIGH;  /* Value of parameter written too high. */
 
         /* configure mapping */
@@ -657,8 +1156,7 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
     else{
         uint32_t *value = (uint32_t*) ODF_arg->data;
         uint8_t* pData;
-        uint8_t length = 0;
-        uint8_t dummy = 0;
+        uint16_t length = 0;
         uint8_t MBvar;
 
         if(TPDO->dataLength)
@@ -671,7 +1169,7 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
                 1,
                &pData,
                &length,
-               &dummy,
+                NULL,
                &MBvar);
     }
 
@@ -684,12 +1182,14 @@ int16_t CO_RPDO_init(
         CO_RPDO_t              *RPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_SYNC_t              *SYNC,
         uint8_t                *operatingState,
         uint8_t                 nodeId,
         uint16_t                defaultCOB_ID,
         uint8_t                 restrictionFlags,
         const CO_RPDOCommPar_t *RPDOCommPar,
         const CO_RPDOMapPar_t  *RPDOMapPar,
+        uint32_t               *overflowCounter,
         uint16_t                idx_RPDOCommPar,
         uint16_t                idx_RPDOMapPar,
         CO_CANmodule_t         *CANdevRx,
@@ -699,6 +1199,7 @@ int16_t CO_RPDO_init(
     /* Configure object variables */
     RPDO->em = em;
     RPDO->SDO = SDO;
+    RPDO->SYNC = SYNC;
     RPDO->RPDOCommPar = RPDOCommPar;
     RPDO->RPDOMapPar = RPDOMapPar;
     RPDO->operatingState = operatingState;
@@ -711,9 +1212,19 @@ int16_t CO_RPDO_init(
     CO_OD_configure(SDO, idx_RPDOMapPar, CO_ODF_RPDOmap, (void*)RPDO, 0, 0);
 
     /* configure communication and mapping */
-    RPDO->CANrxNew = 0;
+    RPDO->fifo = CO_false;
+    RPDO->CANrxHead = 0U;
+    RPDO->CANrxTail = 0U;
+    RPDO->overflowCounter = overflowCounter;
+#ifdef CO_CAN_RX_TIMESTAMP
+    RPDO->timestamp = 0U;
+#endif
     RPDO->CANdevRx = CANdevRx;
     RPDO->CANdevRxIdx = CANdevRxIdx;
+    RPDO->MPDO = NULL;
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    RPDO->TPDOnotify = NULL;
+#endif
 
     CO_RPDOconfigMap(RPDO, RPDOMapPar->numberOfMappedObjects);
     CO_RPDOconfigCom(RPDO, RPDOCommPar->COB_IDUsedByRPDO);
@@ -735,6 +1246,8 @@ int16_t CO_TPDO_init(
         const CO_TPDOMapPar_t  *TPDOMapPar,
         uint16_t                idx_TPDOCommPar,
         uint16_t                idx_TPDOMapPar,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx,
         CO_CANmodule_t         *CANdevTx,
         uint16_t                CANdevTxIdx)
 {
@@ -754,19 +1267,28 @@ int16_t CO_TPDO_init(
     CO_OD_configure(SDO, idx_TPDOMapPar, CO_ODF_TPDOmap, (void*)TPDO, 0, 0);
 
     /* configure communication and mapping */
+    TPDO->CANdevRx = CANdevRx;
+    TPDO->CANdevRxIdx = CANdevRxIdx;
     TPDO->CANdevTx = CANdevTx;
     TPDO->CANdevTxIdx = CANdevTxIdx;
+    TPDO->CANtxBuff = NULL;     /* set by CO_TPDOconfigCom() */
     TPDO->syncCounter = 255;
     TPDO->inhibitTimer = 0;
     TPDO->eventTimer = TPDOCommPar->eventTimer;
     TPDO->SYNCtimerPrevious = 0;
     if(TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
+    TPDO->MPDO = NULL;
+    TPDO->pFunctSignal = NULL;
+    TPDO->functArg = 0;
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    TPDO->notify = NULL;        /* set by CO_TPDOnotify_init() */
+#endif
 
     CO_TPDOconfigMap(TPDO, TPDOMapPar->numberOfMappedObjects);
     CO_TPDOconfigCom(TPDO, TPDOCommPar->COB_IDUsedByTPDO, ((TPDOCommPar->transmissionType<=240) ? 1 : 0));
 
     if((TPDOCommPar->transmissionType>240 &&
-         TPDOCommPar->transmissionType<254) ||
+         TPDOCommPar->transmissionType<252) ||
          TPDOCommPar->SYNCStartValue>240){
             TPDO->valid = CO_false;
     }
@@ -775,119 +1297,549 @@ int16_t CO_TPDO_init(
 }
 
 
-/******************************************************************************/
-uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
-
-    /* Prepare TPDO data automatically from Object Dictionary variables */
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
-
-    pPDOdataByte = &TPDO->CANtxBuff->data[TPDO->dataLength];
-    ppODdataByte = &TPDO->mapPointer[TPDO->dataLength];
-
-    switch(TPDO->dataLength){
-        case 8: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x80)) return 1;
-        case 7: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x40)) return 1;
-        case 6: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x20)) return 1;
-        case 5: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x10)) return 1;
-        case 4: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x08)) return 1;
-        case 3: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x04)) return 1;
-        case 2: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x02)) return 1;
-        case 1: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x01)) return 1;
+/*
+ * Copy one span of the PDO copy plan.
+ *
+ * Spans are short, so copy is made in fixed size chunks, which compile into
+ * single load and store. Variable length memcpy is expanded into slower code
+ * for such short lengths by some compilers.
+ */
+static void CO_PDOcopy(uint8_t *dest, const uint8_t *src, uint8_t length){
+    while(length >= 8){
+        memcpy(dest, src, 8);
+        dest += 8; src += 8; length -= 8;
+    }
+    if(length >= 4){
+        memcpy(dest, src, 4);
+        dest += 4; src += 4; length -= 4;
+    }
+    while(length > 0){
+        *(dest++) = *(src++);
+        length--;
     }
-
-    return 0;
 }
 
-//#define TPDO_CALLS_EXTENSION
-/******************************************************************************/
-int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
-    int16_t i;
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
-
-#ifdef TPDO_CALLS_EXTENSION
-    if(TPDO->SDO->ODExtensions){
-        /* for each mapped OD, check mapping to see if an OD extension is available, and call it if it is */
-        const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
-        CO_SDO_t *pSDO = TPDO->SDO;
-
-        for(i=TPDO->TPDOMapPar->numberOfMappedObjects; i>0; i--){
-            uint32_t map = *(pMap++);
-            uint16_t index = (uint16_t)(map>>16);
-            uint8_t subIndex = (uint8_t)(map>>8);
-            uint16_t entryNo = CO_OD_find(pSDO, index);
-            CO_OD_extension_t *ext = &pSDO->ODExtensions[entryNo];
-            if( ext->pODFunc == NULL) continue;
-            CO_ODF_arg_t ODF_arg;
-            memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
-            ODF_arg.reading = true;
-            ODF_arg.index = index;
-            ODF_arg.subIndex = subIndex;
-            ODF_arg.object = ext->object;
-            ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
-            ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
-            ODF_arg.data = pSDO->OD[entryNo].pData;
-            ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
-            ext->pODFunc(&ODF_arg);
-        }
-    }
-#endif
-    pPDOdataByte = &TPDO->CANtxBuff->data[0];
-    ppODdataByte = &TPDO->mapPointer[0];
-
-    for(i=TPDO->dataLength; i>0; i--)
-        *(pPDOdataByte++) = **(ppODdataByte++);
-
-    TPDO->sendRequest = 0;
 
-    return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+#ifdef CO_BIG_ENDIAN
+/*
+ * Reverse byte order of 64-bit word.
+ */
+static uint64_t CO_PDOswap64(uint64_t v){
+    v = ((v & 0x00FF00FF00FF00FFULL) << 8)  | ((v >> 8)  & 0x00FF00FF00FF00FFULL);
+    v = ((v & 0x0000FFFF0000FFFFULL) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFULL);
+    return (v << 32) | (v >> 32);
 }
+#endif
 
-//#define RPDO_CALLS_EXTENSION
-/******************************************************************************/
-void CO_RPDO_process(CO_RPDO_t *RPDO){
 
-    if(RPDO->CANrxNew && RPDO->valid && *RPDO->operatingState == CO_NMT_OPERATIONAL){
-        int16_t i;
-        uint8_t* pPDOdataByte;
-        uint8_t** ppODdataByte;
+/*
+ * Load 8-byte PDO window, PDO is little endian.
+ */
+static uint64_t CO_PDOloadWindow(const uint8_t *src){
+    uint64_t window;
 
-        pPDOdataByte = &RPDO->CANrxData[0];
-        ppODdataByte = &RPDO->mapPointer[0];
-        for(i=RPDO->dataLength; i>0; i--)
-            **(ppODdataByte++) = *(pPDOdataByte++);
+    memcpy(&window, src, sizeof(window));
+#ifdef CO_BIG_ENDIAN
+    window = CO_PDOswap64(window);
+#endif
+    return window;
+}
 
-#ifdef RPDO_CALLS_EXTENSION
-        if(RPDO->SDO->ODExtensions){
-            /* for each mapped OD, check mapping to see if an OD extension is available, and call it if it is */
-            const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
-            CO_SDO_t *pSDO = RPDO->SDO;
-
-            for(i=RPDO->RPDOMapPar->numberOfMappedObjects; i>0; i--){
-                uint32_t map = *(pMap++);
-                uint16_t index = (uint16_t)(map>>16);
-                uint8_t subIndex = (uint8_t)(map>>8);
-                uint16_t entryNo = CO_OD_find(pSDO, index);
-                CO_OD_extension_t *ext = &pSDO->ODExtensions[entryNo];
-                if( ext->pODFunc == NULL) continue;
-                CO_ODF_arg_t ODF_arg;
-                memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
-                ODF_arg.reading = false;
-                ODF_arg.index = index;
-                ODF_arg.subIndex = subIndex;
-                ODF_arg.object = ext->object;
-                ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
-                ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
-                ODF_arg.data = pSDO->OD[entryNo].pData;
-                ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
-                ext->pODFunc(&ODF_arg);
-            }
+
+/*
+ * Store 8-byte PDO window.
+ */
+static void CO_PDOstoreWindow(uint8_t *dest, uint64_t window){
+#ifdef CO_BIG_ENDIAN
+    window = CO_PDOswap64(window);
+#endif
+    memcpy(dest, &window, sizeof(window));
+}
+
+
+/*
+ * Load variable of bit span. On big endian machine multibyte variable is
+ * stored in native order, other variables (arrays) in PDO order.
+ */
+static uint64_t CO_PDOloadVar(const CO_PDOspan_t *span){
+    uint64_t value = 0;
+#ifdef CO_BIG_ENDIAN
+    uint64_t notSwap = (uint64_t)0 - (uint64_t)(span->swap == 0);
+
+    memcpy((uint8_t*)&value + (8 - span->length) * span->swap, span->pData, span->length);
+    value ^= (value ^ CO_PDOswap64(value)) & notSwap;
+#else
+    memcpy(&value, span->pData, span->length);
+#endif
+    return value;
+}
+
+
+/*
+ * Store variable of bit span, see CO_PDOloadVar.
+ */
+static void CO_PDOstoreVar(const CO_PDOspan_t *span, uint64_t value){
+#ifdef CO_BIG_ENDIAN
+    uint64_t notSwap = (uint64_t)0 - (uint64_t)(span->swap == 0);
+
+    value ^= (value ^ CO_PDOswap64(value)) & notSwap;
+    memcpy(span->pData, (uint8_t*)&value + (8 - span->length) * span->swap, span->length);
+#else
+    memcpy(span->pData, &value, span->length);
+#endif
+}
+
+
+/*
+ * Copy mapped objects into PDO data according to copy plan.
+ *
+ * @param TPDO TPDO object.
+ * @param data Destination, TPDO->dataLength bytes.
+ */
+static void CO_TPDOpack(const CO_TPDO_t *TPDO, uint8_t *data){
+    const CO_PDOspan_t *span = &TPDO->span[0];
+    int16_t i;
+
+    for(i=TPDO->spanCount; i>0; i--, span++){
+#ifdef CO_BIG_ENDIAN
+        if(span->swap){
+            int16_t j;
+            for(j=0; j<span->length; j++)
+                data[span->offset + j] = span->pData[span->length - 1 - j];
+            continue;
         }
 #endif
+        CO_PDOcopy(&data[span->offset], span->pData, span->length);
+    }
+
+    span = &TPDO->span[8 - TPDO->bitSpanCount];
+    for(i=TPDO->bitSpanCount; i>0; i--, span++){
+        uint64_t window = CO_PDOloadWindow(&data[span->offset]);
+
+        window = (window & ~span->mask) | ((CO_PDOloadVar(span) << span->shift) & span->mask);
+        CO_PDOstoreWindow(&data[span->offset], window);
+    }
+}
+
+
+/******************************************************************************/
+uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
+    uint64_t data[(CO_CAN_DATA_MAX+7U)/8U];
+    int16_t words = (TPDO->dataLength + 7) >> 3;
+    int16_t i;
+
+    /* skip, if no variable with Change of State detection is mapped */
+    for(i=0; i<words && TPDO->sendIfCOSMask[i] == 0; i++);
+    if(i == words) return 0;
+
+    /* prepare TPDO data from Object Dictionary variables and compare it
+     * with the last sent data */
+    data[words-1] = 0;
+    if(TPDO->bitSpanCount > 0){
+        /* PDO windows of bit spans may reach over dataLength */
+        memset(data, 0, sizeof(data));
+    }
+    CO_TPDOpack(TPDO, (uint8_t*) data);
+
+    for(; i<words; i++){
+        uint64_t sent;
+        memcpy(&sent, &TPDO->CANtxBuff->data[i*8], sizeof(sent));
+        if((data[i] ^ sent) & TPDO->sendIfCOSMask[i]) return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Copy data of MPDO object, reverse byte order of multibyte variable on big
+ * endian machine.
+ *
+ * @param dest Destination.
+ * @param src Source.
+ * @param length Length of the object, 1 to 4.
+ * @param MBvar True for multibyte variable.
+ */
+static void CO_MPDOcopy(uint8_t *dest, const uint8_t *src, uint16_t length, uint16_t MBvar){
+#ifdef CO_BIG_ENDIAN
+    if(MBvar){
+        uint16_t i;
+        for(i=0; i<length; i++) dest[i] = src[length - 1 - i];
+        return;
+    }
+#else
+    (void)MBvar;
+#endif
+    CO_PDOcopy(dest, src, (uint8_t)length);
+}
+
+
+/*
+ * Read object from Object Dictionary into data of SAM MPDO.
+ *
+ * @param SDO SDO object.
+ * @param index Index of the object.
+ * @param subIndex Sub-index of the object.
+ * @param data Four data bytes of MPDO. Unused bytes are set to zero.
+ *
+ * @return 1 on success, 0 if object does not exist, is not mappable to TPDO
+ * or is longer than four bytes.
+ */
+static uint8_t CO_MPDOread(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex, uint8_t *data){
+    uint16_t entryNo = CO_OD_find(SDO, index);
+    uint16_t attr;
+    uint16_t length;
+
+    if(entryNo == 0xFFFF || subIndex > SDO->OD[entryNo].maxSubIndex) return 0;
+    attr = CO_OD_getAttribute(SDO, entryNo, subIndex);
+    if(!(attr&CO_ODA_TPDO_MAPABLE && attr&CO_ODA_READABLE)) return 0;
+    length = CO_OD_getLength(SDO, entryNo, subIndex);
+    if(length == 0 || length > 4) return 0;
+
+#ifdef TPDO_CALLS_EXTENSION
+    {
+        CO_PDOmapExt_t mapExt;
+        if(CO_PDOfindMapExt(SDO, ((uint32_t)index<<16) | ((uint32_t)subIndex<<8), &mapExt))
+            CO_PDOcallExt(&mapExt, 1, CO_true);
+    }
+#endif
+    memset(data, 0, 4);
+    CO_MPDOcopy(data, (const uint8_t*) CO_OD_getDataPointer(SDO, entryNo, subIndex), length, attr&CO_ODA_MB_VALUE);
+
+    return 1;
+}
+
+
+/*
+ * Send the next object from the object scanner list as SAM MPDO.
+ *
+ * Objects, which can not be read by CO_MPDOread(), are skipped.
+ *
+ * @param TPDO TPDO object.
+ *
+ * @return Same as CO_CANsend(), CO_ERROR_NO if there is no object to send.
+ */
+static int16_t CO_TPDOsendSAM(CO_TPDO_t *TPDO){
+    const CO_MPDO_t *MPDO = TPDO->MPDO;
+    uint8_t *data = &TPDO->CANtxBuff->data[0];
+    uint16_t tries;
+
+    if(MPDO == NULL) return CO_ERROR_NO;
+
+    /* each sub-index of the list is tried at most once */
+    for(tries = (uint16_t)MPDO->scannerListSize * 256U; tries>0; tries--){
+        uint32_t entry;
+        uint8_t blockSize;
+        uint16_t index;
+        uint8_t subIndex;
+
+        if(TPDO->scanEntry >= MPDO->scannerListSize){
+            TPDO->scanEntry = 0;
+            TPDO->scanOffset = 0;
+        }
+        entry = MPDO->scannerList[TPDO->scanEntry];
+        blockSize = (uint8_t)(entry >> 24);
+        if(blockSize == 0) blockSize = 1;
+        index = (uint16_t)(entry >> 8);
+        subIndex = (uint8_t)(entry + TPDO->scanOffset);
+
+        /* advance to the next object */
+        if(entry == 0 || ++TPDO->scanOffset >= blockSize){
+            TPDO->scanEntry++;
+            TPDO->scanOffset = 0;
+        }
+
+        if(entry != 0 && CO_MPDOread(TPDO->SDO, index, subIndex, &data[4])){
+            data[0] = TPDO->nodeId & 0x7F;
+            data[1] = (uint8_t) index;
+            data[2] = (uint8_t)(index >> 8);
+            data[3] = subIndex;
+            return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+        }
     }
 
-    RPDO->CANrxNew = 0;
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
+
+    /* SAM MPDO sends the next scanned object, DAM MPDO is sent only by
+     * CO_TPDOsendDAM() */
+    if(TPDO->MPDOmode != 0U){
+        TPDO->sendRequest = 0;
+        return (TPDO->MPDOmode == CO_MPDO_SAM) ? CO_TPDOsendSAM(TPDO) : CO_ERROR_NO;
+    }
+
+#ifdef TPDO_CALLS_EXTENSION
+    /* call OD extensions of mapped objects, resolved by CO_TPDOconfigMap() */
+    CO_PDOcallExt(TPDO->mapExt, TPDO->mapExtCount, CO_true);
+#endif
+    CO_TPDOpack(TPDO, &TPDO->CANtxBuff->data[0]);
+
+    TPDO->sendRequest = 0;
+
+    return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+}
+
+/*
+ * Write data from CANrxData of RPDO to mapped objects according to copy plan.
+ *
+ * @param RPDO RPDO object.
+ */
+static void CO_RPDOwrite(CO_RPDO_t *RPDO){
+    const CO_PDOspan_t *span = &RPDO->span[0];
+    int16_t i;
+
+    for(i=RPDO->spanCount; i>0; i--, span++){
+#ifdef CO_BIG_ENDIAN
+        if(span->swap){
+            int16_t j;
+            for(j=0; j<span->length; j++)
+                span->pData[span->length - 1 - j] = RPDO->CANrxData[span->offset + j];
+            continue;
+        }
+#endif
+        CO_PDOcopy(span->pData, &RPDO->CANrxData[span->offset], span->length);
+    }
+
+    span = &RPDO->span[8 - RPDO->bitSpanCount];
+    for(i=RPDO->bitSpanCount; i>0; i--, span++){
+        uint64_t window = CO_PDOloadWindow(&RPDO->CANrxData[span->offset]);
+
+        CO_PDOstoreVar(span, (window & span->mask) >> span->shift);
+    }
+
+#ifdef RPDO_CALLS_EXTENSION
+    /* call OD extensions of mapped objects, resolved by CO_RPDOconfigMap() */
+    CO_PDOcallExt(RPDO->mapExt, RPDO->mapExtCount, CO_false);
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    /* mark TPDOs, which map the written variables */
+    if(RPDO->TPDOnotify != NULL){
+        for(i=0; i<RPDO->mapCount; i++)
+            CO_TPDOnotify_entry(RPDO->TPDOnotify, RPDO->mapEntryNo[i], RPDO->mapSubIndex[i]);
+    }
+#endif
+}
+
+
+/*
+ * Write object received by MPDO into Object Dictionary.
+ *
+ * Objects, which are not mappable to RPDO or are longer than four bytes, are
+ * not written.
+ *
+ * @param RPDO RPDO object.
+ * @param entryNo OD entry of the object, as returned from CO_OD_find().
+ * @param subIndex Sub-index of the object.
+ * @param data Four data bytes of MPDO.
+ */
+static void CO_MPDOwrite(CO_RPDO_t *RPDO, uint16_t entryNo, uint8_t subIndex, const uint8_t *data){
+    CO_SDO_t *SDO = RPDO->SDO;
+    uint16_t attr;
+    uint16_t length;
+
+    if(subIndex > SDO->OD[entryNo].maxSubIndex) return;
+    attr = CO_OD_getAttribute(SDO, entryNo, subIndex);
+    if(!(attr&CO_ODA_RPDO_MAPABLE && attr&CO_ODA_WRITEABLE)) return;
+    length = CO_OD_getLength(SDO, entryNo, subIndex);
+    if(length == 0 || length > 4) return;
+
+    CO_MPDOcopy((uint8_t*) CO_OD_getDataPointer(SDO, entryNo, subIndex), data, length, attr&CO_ODA_MB_VALUE);
+
+#ifdef RPDO_CALLS_EXTENSION
+    {
+        CO_PDOmapExt_t mapExt;
+        if(CO_PDOfindMapExt(SDO, ((uint32_t)SDO->OD[entryNo].index<<16) | ((uint32_t)subIndex<<8), &mapExt))
+            CO_PDOcallExt(&mapExt, 1, CO_false);
+    }
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    /* mark TPDOs, which map the written variable */
+    if(RPDO->TPDOnotify != NULL){
+        CO_TPDOnotify_entry(RPDO->TPDOnotify, entryNo, subIndex);
+    }
+#endif
+}
+
+
+/*
+ * Find local object for the object of SAM MPDO sender in dispatch table.
+ *
+ * @param MPDO MPDO object.
+ * @param sender Node-ID, index and sub-index of the sender object, see
+ * CO_MPDOdispatch_t::sender.
+ * @param pEntryNo Pointer to returning parameter: OD entry of local object.
+ * @param pSubIndex Pointer to returning parameter: sub-index of local object.
+ *
+ * @return True, if object was found.
+ */
+static CO_bool_t CO_MPDOdispatchFind(
+        CO_MPDO_t              *MPDO,
+        uint32_t                sender,
+        uint16_t               *pEntryNo,
+        uint8_t                *pSubIndex)
+{
+    CO_bool_t found = CO_false;
+    uint16_t min = 0;
+    uint16_t max;
+
+    CO_DISABLE_INTERRUPTS();
+    /* binary search for the last row, which starts at or before sender */
+    max = MPDO->dispatchCount;
+    while(min < max){
+        uint16_t cur = (min + max) >> 1;
+
+        if(MPDO->dispatch[cur].sender <= sender) min = cur + 1;
+        else                                     max = cur;
+    }
+    if(min > 0){
+        const CO_MPDOdispatch_t *row = &MPDO->dispatch[min - 1];
+        uint32_t offset = sender - row->sender;
+
+        /* the same node and index, sub-index inside block */
+        if((sender >> 8) == (row->sender >> 8) && offset < row->blockSize){
+            *pEntryNo = row->entryNo;
+            *pSubIndex = (uint8_t)(row->subIndex + offset);
+            found = CO_true;
+        }
+    }
+    CO_ENABLE_INTERRUPTS();
+
+    return found;
+}
+
+
+/*
+ * Write object from MPDO in CANrxData of RPDO into Object Dictionary.
+ *
+ * DAM MPDO writes object with the same index and sub-index, SAM MPDO writes
+ * object from dispatch table.
+ *
+ * @param RPDO RPDO object.
+ */
+static void CO_RPDOwriteMPDO(CO_RPDO_t *RPDO){
+    const uint8_t *data = &RPDO->CANrxData[0];
+    uint16_t index = (uint16_t)data[1] | ((uint16_t)data[2] << 8);
+    uint8_t subIndex = data[3];
+    uint16_t entryNo;
+
+    if(RPDO->MPDOmode == CO_MPDO_DAM){
+        entryNo = CO_OD_find(RPDO->SDO, index);
+        if(entryNo != 0xFFFF) CO_MPDOwrite(RPDO, entryNo, subIndex, &data[4]);
+    }
+    else if(RPDO->MPDO != NULL){
+        uint32_t sender = ((uint32_t)(data[0] & 0x7F) << 24) | ((uint32_t)index << 8) | subIndex;
+
+        if(CO_MPDOdispatchFind(RPDO->MPDO, sender, &entryNo, &subIndex))
+            CO_MPDOwrite(RPDO, entryNo, subIndex, &data[4]);
+    }
+}
+
+
+/******************************************************************************/
+void CO_RPDO_process(CO_RPDO_t *RPDO, CO_bool_t syncWas){
+    CO_bool_t synchronous = (RPDO->RPDOCommPar->transmissionType <= 240U) ? CO_true : CO_false;
+
+    if(!RPDO->valid || *RPDO->operatingState != CO_NMT_OPERATIONAL){
+        CO_RPDOclearBuffer(RPDO);
+        return;
+    }
+
+    /* synchronous PDO is processed after the SYNC */
+    if(synchronous && !syncWas) return;
+
+    for(;;){
+        uint8_t idx;
+
+        /* take the oldest buffered message. Messages of synchronous PDO,
+         * received after the SYNC, stay in buffer. */
+        CO_DISABLE_INTERRUPTS();
+        idx = RPDO->CANrxTail & CO_RPDO_BUFFER_MASK;
+        if(RPDO->CANrxTail == RPDO->CANrxHead ||
+           (synchronous && RPDO->CANrxToggle[idx] == RPDO->SYNC->CANrxToggle))
+        {
+            CO_ENABLE_INTERRUPTS();
+            break;
+        }
+        CO_PDOcopy(RPDO->CANrxData, RPDO->CANrxBuffer[idx], RPDO->dataLength);
+#ifdef CO_CAN_RX_TIMESTAMP
+        RPDO->timestamp = RPDO->CANrxTimestamp[idx];
+#endif
+        RPDO->CANrxTail++;
+        CO_ENABLE_INTERRUPTS();
+
+        if(RPDO->MPDOmode != 0U) CO_RPDOwriteMPDO(RPDO);
+        else                     CO_RPDOwrite(RPDO);
+    }
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDOsendDAM(
+        CO_TPDO_t              *TPDO,
+        uint8_t                 nodeId,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        const uint8_t          *data,
+        uint8_t                 length)
+{
+    uint8_t *CANdata = &TPDO->CANtxBuff->data[0];
+
+    if(!TPDO->valid || TPDO->MPDOmode != CO_MPDO_DAM ||
+       *TPDO->operatingState != CO_NMT_OPERATIONAL ||
+       nodeId > 127 || length == 0 || length > 4)
+    {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    CANdata[0] = 0x80 | nodeId;
+    CANdata[1] = (uint8_t) index;
+    CANdata[2] = (uint8_t)(index >> 8);
+    CANdata[3] = subIndex;
+    memset(&CANdata[4], 0, 4);
+    CO_PDOcopy(&CANdata[4], data, length);
+
+    return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+}
+
+
+/*
+ * Sample data of TPDO with transmission type 252 into its CAN tx buffer.
+ *
+ * Buffer is filled with disabled interrupts, so CO_TPDO_receiveRTR() never
+ * sends partially sampled data. Sampling is skipped, while buffer with
+ * previous data waits for transmission.
+ *
+ * @param TPDO TPDO object.
+ */
+static void CO_TPDOsample(CO_TPDO_t *TPDO){
+
+    if(CO_FLAG_READ(TPDO->CANtxBuff->bufferFull)){
+        return;
+    }
+#ifdef TPDO_CALLS_EXTENSION
+    /* call OD extensions of mapped objects, resolved by CO_TPDOconfigMap() */
+    CO_PDOcallExt(TPDO->mapExt, TPDO->mapExtCount, CO_true);
+#endif
+    CO_DISABLE_INTERRUPTS();
+    if(!CO_FLAG_READ(TPDO->CANtxBuff->bufferFull)){
+        CO_TPDOpack(TPDO, &TPDO->CANtxBuff->data[0]);
+        TPDO->RTRsampled = CO_true;
+    }
+    CO_ENABLE_INTERRUPTS();
+}
+
+
+/******************************************************************************/
+void CO_TPDO_processRTR(CO_TPDO_t *TPDO){
+    if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL &&
+       TPDO->TPDOCommPar->transmissionType == 253 && CO_FLAG_READ(TPDO->RTRreceived))
+    {
+        CO_FLAG_CLEAR(TPDO->RTRreceived);
+        CO_TPDOsend(TPDO);
+    }
 }
 
 
@@ -903,7 +1855,7 @@ void CO_TPDO_process(
     if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL){
 
         /* Send PDO by application request or by Event timer */
-        if(TPDO->TPDOCommPar->transmissionType >= 253){
+        if(TPDO->TPDOCommPar->transmissionType >= 254){
             if(TPDO->inhibitTimer == 0 && (TPDO->sendRequest || (TPDO->TPDOCommPar->eventTimer && TPDO->eventTimer == 0))){
                 if(CO_TPDOsend(TPDO) == CO_ERROR_NO){
                     /* successfully sent */
@@ -913,12 +1865,21 @@ void CO_TPDO_process(
             }
         }
 
+        /* Send PDO with current data on Remote Transmission Request */
+        else if(TPDO->TPDOCommPar->transmissionType == 253){
+            CO_TPDO_processRTR(TPDO);
+        }
+
         /* Synchronous PDOs */
         else if(SYNC && SYNC->running && SYNC->curentSyncTimeIsInsideWindow){
             /* detect SYNC message */
             if(SYNC->timer < TPDO->SYNCtimerPrevious){
+                /* sample data, which will be sent on RTR */
+                if(TPDO->TPDOCommPar->transmissionType == 252){
+                    CO_TPDOsample(TPDO);
+                }
                 /* send synchronous acyclic PDO */
-                if(TPDO->TPDOCommPar->transmissionType == 0){
+                else if(TPDO->TPDOCommPar->transmissionType == 0){
                     if(TPDO->sendRequest) CO_TPDOsend(TPDO);
                 }
                 /* send synchronous cyclic PDO */
@@ -951,6 +1912,8 @@ void CO_TPDO_process(
         /* Not operational or valid. Force TPDO first send after operational or valid. */
         if(TPDO->TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
         else                                         TPDO->sendRequest = 0;
+        TPDO->RTRsampled = CO_false;
+        CO_FLAG_CLEAR(TPDO->RTRreceived);
     }
 
     /* update timers */
@@ -964,3 +1927,298 @@ void CO_TPDO_process(
 
     TPDO->SYNCtimerPrevious = SYNC->timer;
 }
+
+
+/*
+ * Configure dispatch table of SAM MPDO consumer from object dispatcher list.
+ *
+ * Function is called from communication reset or when the list changes.
+ * Entries with not existing local object are skipped.
+ *
+ * @param MPDO MPDO object.
+ * @param changedSubIndex Sub-index of the list entry, which is being written,
+ * or 0.
+ * @param changedValue New value of the entry, which is being written.
+ */
+static void CO_MPDOconfigDispatch(CO_MPDO_t *MPDO, uint8_t changedSubIndex, uint64_t changedValue){
+    uint16_t i;
+    uint8_t count = 0;
+
+    CO_DISABLE_INTERRUPTS();
+    for(i=0; i<MPDO->dispatcherListSize; i++){
+        uint64_t entry = (i + 1 == changedSubIndex) ? changedValue : MPDO->dispatcherList[i];
+        CO_MPDOdispatch_t row;
+        int16_t j;
+
+        if(entry == 0) continue;
+        row.entryNo = CO_OD_find(MPDO->SDO, (uint16_t)(entry >> 40));
+        if(row.entryNo == 0xFFFF) continue;
+        row.sender = (uint32_t)entry & 0x7FFFFFFFL;
+        row.subIndex = (uint8_t)(entry >> 32);
+        row.blockSize = (uint8_t)(entry >> 56);
+        if(row.blockSize == 0) row.blockSize = 1;
+
+        /* keep rows sorted by sender */
+        for(j=count; j>0 && MPDO->dispatch[j-1].sender > row.sender; j--){
+            MPDO->dispatch[j] = MPDO->dispatch[j-1];
+        }
+        MPDO->dispatch[j] = row;
+        count++;
+    }
+    MPDO->dispatchCount = count;
+    CO_ENABLE_INTERRUPTS();
+}
+
+
+/*
+ * Function for accessing _object dispatcher list_ (index 0x1FD0) from SDO server.
+ *
+ * For more information see file CO_SDO.h.
+ */
+static CO_SDO_abortCode_t CO_ODF_MPDOdispatcher(CO_ODF_arg_t *ODF_arg){
+    CO_MPDO_t *MPDO;
+    uint64_t value;
+
+    MPDO = (CO_MPDO_t*) ODF_arg->object;
+
+    /* Reading Object Dictionary variable */
+    if(ODF_arg->reading){
+        return CO_SDO_AB_NONE;
+    }
+
+    /* Writing Object Dictionary variable */
+    memcpy(&value, ODF_arg->data, sizeof(value));
+    if(value != 0){
+        uint8_t nodeId = (uint8_t)(value >> 24);
+        uint16_t entryNo = CO_OD_find(MPDO->SDO, (uint16_t)(value >> 40));
+
+        if(nodeId == 0 || nodeId > 127)
+            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+        if(entryNo == 0xFFFF || (uint8_t)(value >> 32) > MPDO->SDO->OD[entryNo].maxSubIndex)
+            return CO_SDO_AB_NOT_EXIST;   /* Object does not exist in the object dictionary. */
+    }
+
+    /* configure dispatch table */
+    CO_MPDOconfigDispatch(MPDO, ODF_arg->subIndex, value);
+
+    return CO_SDO_AB_NONE;
+}
+
+
+/******************************************************************************/
+int16_t CO_MPDO_init(
+        CO_MPDO_t              *MPDO,
+        CO_SDO_t               *SDO,
+        const uint32_t         *scannerList,
+        uint8_t                 scannerListSize,
+        const uint64_t         *dispatcherList,
+        uint8_t                 dispatcherListSize,
+        uint16_t                idx_dispatcherList,
+        CO_MPDOdispatch_t      *dispatch)
+{
+    if((scannerListSize != 0 && scannerList == NULL) ||
+       (dispatcherListSize != 0 && (dispatcherList == NULL || dispatch == NULL)))
+    {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* Configure object variables */
+    MPDO->SDO = SDO;
+    MPDO->scannerList = scannerList;
+    MPDO->scannerListSize = scannerListSize;
+    MPDO->dispatcherList = dispatcherList;
+    MPDO->dispatcherListSize = dispatcherListSize;
+    MPDO->dispatch = dispatch;
+
+    /* Configure Object dictionary entry at index 0x1FD0 */
+    if(dispatcherListSize != 0){
+        CO_OD_configure(SDO, idx_dispatcherList, CO_ODF_MPDOdispatcher, (void*)MPDO, 0, 0);
+    }
+
+    CO_MPDOconfigDispatch(MPDO, 0, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+#ifdef CO_TPDO_CHANGE_DRIVEN
+/******************************************************************************/
+void CO_TPDOnotify_init(
+        CO_TPDOnotify_t        *notify,
+        CO_TPDO_t             **TPDO,
+        uint16_t                TPDOcount,
+        CO_SDO_t               *SDO,
+        CO_TPDOmapRef_t       **mapRef,
+        uint8_t                *operatingState)
+{
+    uint16_t i;
+
+    /* Configure object variables */
+    notify->TPDO = TPDO;
+    notify->TPDOcount = TPDOcount;
+    notify->SDO = SDO;
+    notify->mapRef = mapRef;
+    notify->operatingState = operatingState;
+    notify->operatingStatePrevious = *operatingState;
+    notify->dirtyFirst = NULL;
+    notify->syncFirst = NULL;
+    notify->syncListValid = CO_false;
+    notify->timeDifference_ms = 1;
+    notify->SYNCtimerPrevious = 0;
+    CO_timerWheel_init(&notify->timers);
+
+    for(i=0; i<SDO->ODSize; i++){
+        mapRef[i] = NULL;
+    }
+
+    /* link TPDOs and process all of them in the first cycle */
+    for(i=0; i<TPDOcount; i++){
+        CO_TPDO_t *T = TPDO[i];
+
+        T->notify = notify;
+        T->dirty = CO_false;
+        T->visitTime_ms = 0;
+        CO_timer_init(&T->timer, CO_TPDOnotify_timerExpired, (void*)T);
+        CO_TPDOlinkMapRef(T, CO_true);
+        CO_TPDOnotify_mark(notify, T);
+    }
+
+    /* get notified about SDO downloads */
+    SDO->functWrittenObject = (void*)notify;
+    SDO->pFunctWritten = CO_TPDOnotify_SDOwritten;
+}
+
+
+/******************************************************************************/
+void CO_TPDOnotify_written(CO_TPDOnotify_t *notify, uint16_t index, uint8_t subIndex){
+    uint16_t entryNo = CO_OD_find(notify->SDO, index);
+
+    if(entryNo != 0xFFFF){
+        CO_TPDOnotify_entry(notify, entryNo, subIndex);
+    }
+}
+
+
+/******************************************************************************/
+void CO_TPDOmarkDirty(CO_TPDO_t *TPDO){
+    if(TPDO->notify != NULL){
+        CO_TPDOnotify_mark(TPDO->notify, TPDO);
+    }
+}
+
+
+/*
+ * Process one TPDO and schedule its next processing by its timers.
+ *
+ * @param notify TPDO notification object.
+ * @param TPDO TPDO object.
+ * @param SYNC SYNC object.
+ */
+static void CO_TPDOnotify_visit(CO_TPDOnotify_t *notify, CO_TPDO_t *TPDO, CO_SYNC_t *SYNC){
+    uint16_t timeDifference_ms = notify->timeDifference_ms;
+    uint32_t skipped = notify->timers.now_ms - TPDO->visitTime_ms - timeDifference_ms;
+    uint32_t dueIn = 0;
+    CO_bool_t timed = CO_false;
+
+    TPDO->visitTime_ms = notify->timers.now_ms;
+
+    /* Timers run also in skipped cycles. Nothing was due there, so only
+     * decrement them, then process this cycle as with polling. */
+    if(skipped > 0xFFFFU) skipped = 0xFFFFU;
+    TPDO->inhibitTimer = (TPDO->inhibitTimer > skipped * 10U) ? (uint16_t)(TPDO->inhibitTimer - skipped * 10U) : 0U;
+    TPDO->eventTimer = (TPDO->eventTimer > skipped) ? (uint16_t)(TPDO->eventTimer - skipped) : 0U;
+
+    /* SYNC is detected by CO_TPDO_process() only in the cycle it arrived */
+    TPDO->SYNCtimerPrevious = notify->SYNCtimerPrevious;
+
+    if(!TPDO->sendRequest) TPDO->sendRequest = CO_TPDOisCOS(TPDO);
+    CO_TPDO_process(TPDO, SYNC, timeDifference_ms * 10U, timeDifference_ms);
+
+    /* schedule the cycle, in which event timer expires, or inhibit timer
+     * expires for pending request */
+    if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL &&
+       TPDO->TPDOCommPar->transmissionType >= 254)
+    {
+        if(TPDO->TPDOCommPar->eventTimer != 0){
+            dueIn = TPDO->eventTimer + timeDifference_ms;
+            timed = CO_true;
+        }
+        if(TPDO->sendRequest){
+            uint32_t inhibitDueIn = (TPDO->inhibitTimer + 9U) / 10U + timeDifference_ms;
+
+            if(!timed || inhibitDueIn < dueIn) dueIn = inhibitDueIn;
+            timed = CO_true;
+        }
+    }
+
+    if(timed){
+        CO_timer_start(&notify->timers, &TPDO->timer, dueIn);
+    }
+    else{
+        CO_timer_stop(&TPDO->timer);
+    }
+}
+
+
+/******************************************************************************/
+void CO_TPDOnotify_process(
+        CO_TPDOnotify_t        *notify,
+        CO_SYNC_t              *SYNC,
+        uint16_t                timeDifference_ms)
+{
+    CO_TPDO_t *TPDO;
+    uint16_t i;
+
+    notify->timeDifference_ms = timeDifference_ms;
+
+    /* NMT state changed, process all TPDOs */
+    if(*notify->operatingState != notify->operatingStatePrevious){
+        notify->operatingStatePrevious = *notify->operatingState;
+        for(i=0; i<notify->TPDOcount; i++){
+            CO_TPDOnotify_mark(notify, notify->TPDO[i]);
+        }
+    }
+
+    /* SYNC received, process synchronous TPDOs */
+    if(SYNC != NULL && SYNC->timer < notify->SYNCtimerPrevious){
+        if(!notify->syncListValid){
+            notify->syncListValid = CO_true;
+            notify->syncFirst = NULL;
+            for(i=notify->TPDOcount; i>0; i--){
+                TPDO = notify->TPDO[i-1];
+                if(TPDO->TPDOCommPar->transmissionType <= 240 ||
+                   TPDO->TPDOCommPar->transmissionType == 252)
+                {
+                    TPDO->syncNext = notify->syncFirst;
+                    notify->syncFirst = TPDO;
+                }
+            }
+        }
+        for(TPDO = notify->syncFirst; TPDO != NULL; TPDO = TPDO->syncNext){
+            CO_TPDOnotify_mark(notify, TPDO);
+        }
+    }
+
+    /* mark TPDOs with expired timers */
+    CO_timerWheel_process(&notify->timers, timeDifference_ms);
+
+    /* process marked TPDOs. Take the whole list, TPDOs marked meanwhile
+     * will be processed in the next cycle. */
+    CO_DISABLE_INTERRUPTS();
+    TPDO = notify->dirtyFirst;
+    notify->dirtyFirst = NULL;
+    CO_ENABLE_INTERRUPTS();
+
+    while(TPDO != NULL){
+        CO_TPDO_t *next = TPDO->dirtyNext;
+
+        CO_DISABLE_INTERRUPTS();
+        TPDO->dirty = CO_false;
+        CO_ENABLE_INTERRUPTS();
+        CO_TPDOnotify_visit(notify, TPDO, SYNC);
+        TPDO = next;
+    }
+
+    if(SYNC != NULL) notify->SYNCtimerPrevious = SYNC->timer;
+}
+#endif
@@ -29,6 +29,8 @@
 #ifndef CO_PDO_H
 #define CO_PDO_H
 
+#include "CO_timer.h"
+
 
 /**
  * @defgroup CO_PDO PDO
@@ -48,14 +50,117 @@
  *
  * Features of the PDO as implemented here, in CANopenNode:
  *  - Dynamic PDO mapping.
- *  - Map granularity of one byte.
+ *  - Map granularity of one bit. Byte aligned variables are copied with
+ *    memcpy, other are packed with precomputed shift and mask.
  *  - After RPDO is received from CAN bus, its data are copied to buffer.
  *    Function CO_RPDO_process() (called by application) copies data to
- *    mapped objects in Object Dictionary.
+ *    mapped objects in Object Dictionary. Event driven RPDO is processed
+ *    immediately, synchronous RPDO after next SYNC, see #CO_RPDO_BUFFER_SIZE.
  *  - Function CO_TPDO_process() (called by application) sends TPDO if
  *    necessary. There are possible different transmission types, including
  *    automatic detection of Change of State of specific variable.
+ *  - TPDO with transmission type 252 is sampled at SYNC and sent directly
+ *    from CAN receive function, when Remote Transmission Request is received.
+ *    TPDO with transmission type 253 is marked by CAN receive function and
+ *    sent with current data by next CO_TPDO_process().
+ *  - Multiplexed PDO (MPDO), see #CO_MPDO_SAM.
+ */
+
+
+/**
+ * @name Calling OD extensions from PDOs
+ * If defined, CO_RPDO_process() (after writing) and CO_TPDOsend() (before
+ * reading) call the @ref CO_SDO_OD_function of each mapped object, which has
+ * it registered with CO_OD_configure(). Mapped objects are resolved in
+ * Object Dictionary only once, when PDO mapping is configured.
+ * @{
+ */
+//#define RPDO_CALLS_EXTENSION
+//#define TPDO_CALLS_EXTENSION
+/** @} */
+
+
+/**
+ * @name Change driven TPDO processing
+ * If defined, CO_TPDOnotify_process() replaces calling CO_TPDOisCOS() and
+ * CO_TPDO_process() for each TPDO in each cycle. TPDO is processed only,
+ * if it may have something to do: variable mapped to it was written, its
+ * event or inhibit timer expires, SYNC was received or NMT state changed.
+ * Expiration of event and inhibit timers is scheduled on the timer wheel of
+ * CO_TPDOnotify_t.
+ *
+ * Writes by SDO download and by RPDO are detected automatically. If
+ * application writes mapped variable directly, it must call
+ * CO_TPDOnotify_written(). If it sets _sendRequest_, it must call
+ * CO_TPDOmarkDirty().
+ * @{
+ */
+//#define CO_TPDO_CHANGE_DRIVEN
+/** @} */
+
+
+/**
+ * @name Receive buffer of RPDO
+ * Each RPDO has CO_RPDO_BUFFER_SIZE buffers, filled by CAN receive function
+ * and emptied by CO_RPDO_process(). Buffered message is copied into
+ * CO_RPDO_t::CANrxData with disabled interrupts, mapped objects are then
+ * written from there. So objects are never written with partially received
+ * data.
+ *
+ *  - Event driven RPDO (transmission type 254 or 255) buffers only the latest
+ *    message by default. If message is received before the previous one was
+ *    processed, previous is overwritten.
+ *  - If CO_RPDO_t::fifo is set, event driven RPDO buffers up to
+ *    CO_RPDO_BUFFER_SIZE messages. All are processed in the order of
+ *    reception. If buffers are full, the newest buffered message is
+ *    overwritten.
+ *  - Synchronous RPDO (transmission type 0 to 240) buffers the latest message
+ *    received before the SYNC and the latest message received after it. The
+ *    first is processed, when CO_RPDO_process() is called with _syncWas_ set.
+ *    Messages received after the SYNC wait for the next SYNC.
+ *
+ * Each overwritten message, which was not processed, increments
+ * _RPDO overflow counter_, if it is configured with CO_RPDO_init().
+ * @{
  */
+#ifndef CO_RPDO_BUFFER_SIZE
+    /** Number of receive buffers of each RPDO, power of two from 2 to 128 */
+    #define CO_RPDO_BUFFER_SIZE     2
+#endif
+/** @} */
+
+
+/**
+ * @name Multiplexed PDO
+ * PDO, whose mapping parameter has number of mapped objects set to
+ * CO_MPDO_SAM or CO_MPDO_DAM, is Multiplexed PDO. It always has eight data
+ * bytes: byte 0 contains address mode in bit 7 and node-ID in bits 0-6, bytes
+ * 1-3 contain index and sub-index of the object, bytes 4-7 contain its data.
+ * Objects longer than four bytes can not be transferred.
+ *
+ *  - Source address mode (SAM) producer transmits own objects, which are
+ *    listed in _object scanner list_ (index 0x1FA0). Each transmission of the
+ *    TPDO (by event timer, by _sendRequest_, etc.) contains the next object
+ *    of the list.
+ *  - SAM consumer writes received object into local object, as configured in
+ *    _object dispatcher list_ (index 0x1FD0). Lists are part of CO_MPDO_t.
+ *    Dispatcher list is converted into table sorted by sender objects, so
+ *    received object is found with binary search.
+ *  - Destination address mode (DAM) producer is used by application with
+ *    CO_TPDOsendDAM(). It writes any object into node with specified node-ID
+ *    or into all nodes.
+ *  - DAM consumer writes received object into the same object of own Object
+ *    Dictionary, if message is addressed to this node or to all nodes.
+ *
+ * Consumer writes objects, which are mappable to RPDO, producer reads objects,
+ * which are mappable to TPDO. Other objects are skipped. Received MPDOs are
+ * buffered as with CO_RPDO_t::fifo set, each message carries different object.
+ * Bursts of MPDOs longer than #CO_RPDO_BUFFER_SIZE are lost.
+ * @{
+ */
+#define CO_MPDO_SAM                 0xFEU   /**< Number of mapped objects of SAM MPDO */
+#define CO_MPDO_DAM                 0xFFU   /**< Number of mapped objects of DAM MPDO */
+/** @} */
 
 
 /**
@@ -82,8 +187,8 @@ typedef struct{
  * RPDO mapping parameter. The same as record from Object dictionary (index 0x1600+).
  */
 typedef struct{
-    /** Actual number of mapped objects from 0 to 8. To change mapped object,
-    this value must be 0. */
+    /** Actual number of mapped objects from 0 to 8, #CO_MPDO_SAM or
+    #CO_MPDO_DAM. To change mapped object, this value must be 0. */
     uint8_t             numberOfMappedObjects;
     /** Location and size of the mapped object. Bit meanings `0xIIIISSLL`:
         - Bit  0-7:  Data Length in bits.
@@ -115,7 +220,10 @@ typedef struct{
         - 0:       Transmiting is synchronous, specification in device profile.
         - 1-240:   Transmiting is synchronous after every N-th SYNC object.
         - 241-251: Not used.
-        - 252-253: Transmited only on reception of Remote Transmission Request.
+        - 252:     Data is sampled at SYNC and transmitted on reception of
+                   Remote Transmission Request.
+        - 253:     Transmitted only on reception of Remote Transmission Request,
+                   with current data.
         - 254:     Manufacturer specific.
         - 255:     Asinchronous, specification in device profile. */
     uint8_t             transmissionType;
@@ -139,8 +247,8 @@ typedef struct{
  * TPDO mapping parameter. The same as record from Object dictionary (index 0x1A00+).
  */
 typedef struct{
-    /** Actual number of mapped objects from 0 to 8. To change mapped object,
-    this value must be 0. */
+    /** Actual number of mapped objects from 0 to 8, #CO_MPDO_SAM or
+    #CO_MPDO_DAM. To change mapped object, this value must be 0. */
     uint8_t             numberOfMappedObjects;
     /** Location and size of the mapped object. Bit meanings `0xIIIISSLL`:
         - Bit  0-7:  Data Length in bits.
@@ -157,12 +265,122 @@ typedef struct{
 }CO_TPDOMapPar_t;
 
 
+/**
+ * Row of the dispatch table of SAM MPDO consumer. Calculated from one entry of
+ * _object dispatcher list_ by CO_MPDO_init() or when the list is written.
+ */
+typedef struct{
+    /** First object of the sender. Bit meanings `0xNNIIIISS`:
+        - Bit  0-7:  Sub-index of the object.
+        - Bit 8-23:  Index of the object.
+        - Bit 24-30: Node-ID of the sender. */
+    uint32_t            sender;
+    /** OD entry of the local object, as returned from CO_OD_find() */
+    uint16_t            entryNo;
+    /** Sub-index of the first local object */
+    uint8_t             subIndex;
+    /** Number of consecutive sub-indexes, 1 to 255 */
+    uint8_t             blockSize;
+}CO_MPDOdispatch_t;
+
+
+/**
+ * MPDO object, common for all MPDOs.
+ */
+typedef struct{
+    CO_SDO_t           *SDO;            /**< From CO_MPDO_init() */
+    /** From CO_MPDO_init(). _Object scanner list_ (index 0x1FA0), each entry
+    has bit meanings `0xBBIIIISS`:
+        - Bit  0-7:  Sub-index of the first object.
+        - Bit 8-23:  Index of the object.
+        - Bit 24-31: Number of consecutive sub-indexes, 0 is the same as 1.
+    Entry with value 0 is not used. */
+    const uint32_t     *scannerList;
+    uint8_t             scannerListSize;/**< From CO_MPDO_init() */
+    /** From CO_MPDO_init(). _Object dispatcher list_ (index 0x1FD0), each entry
+    has bit meanings `0xBBIIIISSNNIIIISS`:
+        - Bit  0-7:  Sub-index of the first object of the sender.
+        - Bit 8-23:  Index of the object of the sender.
+        - Bit 24-31: Node-ID of the sender.
+        - Bit 32-39: Sub-index of the first local object.
+        - Bit 40-55: Index of the local object.
+        - Bit 56-63: Number of consecutive sub-indexes, 0 is the same as 1.
+    Entry with value 0 is not used. */
+    const uint64_t     *dispatcherList;
+    uint8_t             dispatcherListSize;/**< From CO_MPDO_init() */
+    /** From CO_MPDO_init(). Dispatch table, sorted by CO_MPDOdispatch_t::sender */
+    CO_MPDOdispatch_t  *dispatch;
+    /** Number of used rows in dispatch */
+    uint8_t             dispatchCount;
+}CO_MPDO_t;
+
+
+/**
+ * Part of PDO data, copied from (to) mapped objects. Calculated from PDO
+ * mapping by CO_RPDOconfigMap() or CO_TPDOconfigMap().
+ *
+ * Byte span is contiguous part of PDO, copied with single memcpy. Adjacent
+ * mapped variables, which are also adjacent in memory, are merged into one
+ * byte span. Bit span is variable, which is not byte aligned inside PDO. It
+ * is packed with precomputed shift and mask into 64-bit PDO window, which
+ * always lies inside PDO data buffer.
+ */
+typedef struct{
+    uint8_t            *pData;          /**< Pointer to data of mapped object(s) */
+    /** Bit span: mask of the variable inside PDO window, already shifted */
+    uint64_t            mask;
+    /** Byte span: offset of data inside PDO. Bit span: offset of 8-byte PDO window */
+    uint8_t             offset;
+    /** Byte span: number of bytes. Bit span: number of used bytes of variable */
+    uint8_t             length;
+    uint8_t             shift;          /**< Bit span: bit offset of the variable inside PDO window */
+#ifdef CO_BIG_ENDIAN
+    /** True for multibyte variable, bytes are copied in reverse order */
+    uint8_t             swap;
+#endif
+}CO_PDOspan_t;
+
+
+#if defined(RPDO_CALLS_EXTENSION) || defined(TPDO_CALLS_EXTENSION)
+/**
+ * Mapped object, resolved in Object Dictionary when PDO mapping is configured.
+ * Used for calling its @ref CO_SDO_OD_function from PDO.
+ */
+typedef struct{
+    CO_OD_extension_t  *ext;            /**< Extension of the OD entry */
+    void               *pData;          /**< Pointer to data of the variable */
+    uint16_t            index;          /**< Index of the variable */
+    uint16_t            attribute;      /**< Attribute of the variable */
+    uint16_t            length;         /**< Length of the variable in bytes */
+    uint8_t             subIndex;       /**< Subindex of the variable */
+}CO_PDOmapExt_t;
+#endif
+
+
+#ifdef CO_TPDO_CHANGE_DRIVEN
+struct CO_TPDO;
+struct CO_TPDOnotify;
+
+/**
+ * Reference from Object Dictionary variable to TPDO, which maps it. Element of
+ * the list, which starts in CO_TPDOnotify_t::mapRef.
+ */
+typedef struct CO_TPDOmapRef{
+    struct CO_TPDOmapRef *next;         /**< Next TPDO, which maps the same OD entry */
+    struct CO_TPDO     *TPDO;           /**< TPDO, which maps the variable */
+    uint16_t            entryNo;        /**< OD entry, as returned from CO_OD_find() */
+    uint8_t             subIndex;       /**< Sub-index of the variable */
+}CO_TPDOmapRef_t;
+#endif
+
+
 /**
  * RPDO object.
  */
 typedef struct{
     CO_EM_t            *em;             /**< From CO_RPDO_init() */
     CO_SDO_t           *SDO;            /**< From CO_RPDO_init() */
+    CO_SYNC_t          *SYNC;           /**< From CO_RPDO_init() */
     const CO_RPDOCommPar_t *RPDOCommPar;/**< From CO_RPDO_init() */
     const CO_RPDOMapPar_t  *RPDOMapPar; /**< From CO_RPDO_init() */
     uint8_t            *operatingState; /**< From CO_RPDO_init() */
@@ -173,13 +391,65 @@ typedef struct{
     CO_bool_t           valid;
     /** Data length of the received PDO message. Calculated from mapping */
     uint8_t             dataLength;
-    /** Pointers to 8 data objects, where PDO will be copied */
-    uint8_t            *mapPointer[8];
-    /** Variable indicates, if new PDO message received from CAN bus.
-    Must be 2-byte variable because of correct alignment of CANrxData. */
-    uint16_t            CANrxNew;
-    /** 8 data bytes of the received message. Take care for correct (word) alignment!*/
-    uint8_t             CANrxData[8];
+    /** 0 for ordinary PDO, #CO_MPDO_SAM or #CO_MPDO_DAM. From mapping */
+    uint8_t             MPDOmode;
+    /** MPDO object or NULL. Set by application after CO_RPDO_init(). Used by
+    SAM MPDO. */
+    CO_MPDO_t          *MPDO;
+    /** Copy plan: parts of PDO and mapped objects, where they will be
+    copied. Dummy mapping entries are skipped. Byte spans are at the
+    beginning of the array, bit spans at its end. */
+    CO_PDOspan_t        span[8];
+    /** Number of byte spans in span */
+    uint8_t             spanCount;
+    /** Number of bit spans in span */
+    uint8_t             bitSpanCount;
+#ifdef RPDO_CALLS_EXTENSION
+    /** Mapped objects, whose OD extensions are called after PDO is processed */
+    CO_PDOmapExt_t      mapExt[8];
+    /** Number of used entries in mapExt */
+    uint8_t             mapExtCount;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    /** TPDO notification object or NULL. Set by application after
+    CO_RPDO_init(). Mapped variables are reported to it after PDO is
+    processed. */
+    struct CO_TPDOnotify *TPDOnotify;
+    /** OD entries of mapped variables, as returned from CO_OD_find() */
+    uint16_t            mapEntryNo[8];
+    /** Sub-indexes of mapped variables */
+    uint8_t             mapSubIndex[8];
+    /** Number of used entries in mapEntryNo and mapSubIndex */
+    uint8_t             mapCount;
+#endif
+    /** If true, event driven PDO messages are queued and all are processed.
+    Default is false: only the latest message is processed. Set by
+    application after CO_RPDO_init(). See #CO_RPDO_BUFFER_SIZE. */
+    CO_bool_t           fifo;
+    /** Number of messages written into CANrxBuffer. Written only by CAN
+    receive function, wraps around. */
+    uint8_t             CANrxHead;
+    /** Number of messages taken from CANrxBuffer. Written only by
+    CO_RPDO_process(), wraps around. Buffer is empty, if equal to CANrxHead. */
+    uint8_t             CANrxTail;
+    /** Value of CO_SYNC_t::CANrxToggle at reception of the message in each
+    buffer */
+    CO_bool_t           CANrxToggle[CO_RPDO_BUFFER_SIZE];
+    /** From CO_RPDO_init(), may be NULL */
+    uint32_t           *overflowCounter;
+    /** Data bytes of the message, which is being or was last processed.
+    Take care for correct (word) alignment!*/
+    uint8_t             CANrxData[CO_CAN_DATA_MAX];
+    /** Buffers for received messages */
+    uint8_t             CANrxBuffer[CO_RPDO_BUFFER_SIZE][CO_CAN_DATA_MAX];
+#ifdef CO_CAN_RX_TIMESTAMP
+    /** Reception time of the message in each buffer */
+    uint64_t            CANrxTimestamp[CO_RPDO_BUFFER_SIZE];
+    /** Reception time of the PDO message in CANrxData in [nanoseconds], see
+    CO_CANrxMsg_readTimestamp(). Latency from SYNC is
+    (timestamp - CO_SYNC_t::timestamp). */
+    uint64_t            timestamp;
+#endif
     CO_CANmodule_t     *CANdevRx;       /**< From CO_RPDO_init() */
     uint16_t            CANdevRxIdx;    /**< From CO_RPDO_init() */
 }CO_RPDO_t;
@@ -188,7 +458,7 @@ typedef struct{
 /**
  * TPDO object.
  */
-typedef struct{
+typedef struct CO_TPDO{
     CO_EM_t            *em;             /**< From CO_TPDO_init() */
     CO_SDO_t           *SDO;            /**< From CO_TPDO_init() */
     const CO_TPDOCommPar_t *TPDOCommPar;/**< From CO_TPDO_init() */
@@ -200,15 +470,52 @@ typedef struct{
     CO_bool_t           valid;          /**< True, if PDO is enabled and valid */
     /** Data length of the transmitting PDO message. Calculated from mapping */
     uint8_t             dataLength;
+    /** 0 for ordinary PDO, #CO_MPDO_SAM or #CO_MPDO_DAM. From mapping */
+    uint8_t             MPDOmode;
+    /** MPDO object or NULL. Set by application after CO_TPDO_init(). Used by
+    SAM MPDO. */
+    CO_MPDO_t          *MPDO;
+    /** SAM MPDO: entry of the object scanner list and sub-index offset inside
+    its block, which will be transmitted next */
+    uint8_t             scanEntry, scanOffset;
     /** If application set this flag, PDO will be later sent by
     function CO_TPDO_process(). Depends on transmission type. */
     uint8_t             sendRequest;
-    /** Pointers to 8 data objects, where PDO will be copied */
-    uint8_t            *mapPointer[8];
-    /** Each flag bit is connected with one mapPointer. If flag bit
-    is true, CO_TPDO_process() functiuon will send PDO if
-    Change of State is detected on value pointed by that mapPointer */
-    uint8_t             sendIfCOSFlags;
+    /** Copy plan: parts of PDO and mapped objects, where they will be
+    copied from. Byte spans are at the beginning of the array, bit spans at
+    its end. */
+    CO_PDOspan_t        span[8];
+    /** Number of byte spans in span */
+    uint8_t             spanCount;
+    /** Number of bit spans in span */
+    uint8_t             bitSpanCount;
+    /** Change of State mask, used as byte array. Bit is set, if the same bit
+    of the PDO belongs to the variable with Change of State detection. Then
+    CO_TPDOisCOS() compares PDO with mapped objects in 64-bit words. */
+    uint64_t            sendIfCOSMask[(CO_CAN_DATA_MAX+7U)/8U];
+#ifdef TPDO_CALLS_EXTENSION
+    /** Mapped objects, whose OD extensions are called before PDO is sent */
+    CO_PDOmapExt_t      mapExt[8];
+    /** Number of used entries in mapExt */
+    uint8_t             mapExtCount;
+#endif
+#ifdef CO_TPDO_CHANGE_DRIVEN
+    /** From CO_TPDOnotify_init() or NULL */
+    struct CO_TPDOnotify *notify;
+    /** References from mapped variables to this TPDO */
+    CO_TPDOmapRef_t     mapRef[8];
+    /** Number of used entries in mapRef */
+    uint8_t             mapRefCount;
+    /** True, if TPDO is in the list of TPDOs, which will be processed */
+    CO_bool_t           dirty;
+    /** Next TPDO in the lists of CO_TPDOnotify_t */
+    struct CO_TPDO     *dirtyNext, *syncNext;
+    /** Time of the last processing, see CO_timerWheel_t::now_ms */
+    uint32_t            visitTime_ms;
+    /** Marks TPDO for processing, when event timer expires or inhibit timer
+    expires for pending request */
+    CO_timer_t          timer;
+#endif
     /** SYNC counter used for PDO sending */
     uint8_t             syncCounter;
     /** Previous timer from CO_SYNC_t */
@@ -217,12 +524,59 @@ typedef struct{
     uint16_t            inhibitTimer;
     /** Event timer used for PDO sending */
     uint16_t            eventTimer;
+    /** True, if data of TPDO with transmission type 252 was sampled at SYNC
+    into CANtxBuff and may be sent on Remote Transmission Request */
+    CO_bool_t           RTRsampled;
+    /** True, if Remote Transmission Request for TPDO with transmission type
+    253 was received. TPDO is sent from CO_TPDO_processRTR(). */
+    CO_FLAG_t           RTRreceived;
+    /** Pointer to optional external function. If defined, it is called from
+    high priority interrupt after Remote Transmission Request for TPDO with
+    transmission type 253 was received. Function may wake up external task,
+    which sends TPDO with CO_process_TPDO_RTR(). Set by application after
+    CO_TPDO_init(). */
+    void              (*pFunctSignal)(uint32_t arg);
+    /** Optional argument, which is passed to above function */
+    uint32_t            functArg;
+    CO_CANmodule_t     *CANdevRx;       /**< From CO_TPDO_init() */
+    uint16_t            CANdevRxIdx;    /**< From CO_TPDO_init() */
     CO_CANmodule_t     *CANdevTx;       /**< From CO_TPDO_init() */
     CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer inside CANdev */
     uint16_t            CANdevTxIdx;    /**< From CO_TPDO_init() */
 }CO_TPDO_t;
 
 
+#ifdef CO_TPDO_CHANGE_DRIVEN
+/**
+ * TPDO notification object, common for all TPDOs.
+ */
+typedef struct CO_TPDOnotify{
+    CO_TPDO_t         **TPDO;           /**< From CO_TPDOnotify_init() */
+    uint16_t            TPDOcount;      /**< From CO_TPDOnotify_init() */
+    CO_SDO_t           *SDO;            /**< From CO_TPDOnotify_init() */
+    /** From CO_TPDOnotify_init(). For each OD entry first reference to TPDO,
+    which maps its variable. */
+    CO_TPDOmapRef_t   **mapRef;
+    uint8_t            *operatingState; /**< From CO_TPDOnotify_init() */
+    /** NMT operating state in previous cycle */
+    uint8_t             operatingStatePrevious;
+    /** List of TPDOs, which will be processed in the next cycle */
+    CO_TPDO_t          *dirtyFirst;
+    /** List of synchronous TPDOs */
+    CO_TPDO_t          *syncFirst;
+    /** False, if list of synchronous TPDOs must be rebuilt */
+    CO_bool_t           syncListValid;
+    /** Timers of TPDOs. Separate from the wheel of CO_process(), because
+    TPDOs are processed in other task. */
+    CO_timerWheel_t     timers;
+    /** Time difference of the current cycle in [milliseconds] */
+    uint16_t            timeDifference_ms;
+    /** Timer from CO_SYNC_t in previous cycle */
+    uint32_t            SYNCtimerPrevious;
+}CO_TPDOnotify_t;
+#endif
+
+
 /**
  * Initialize RPDO object.
  *
@@ -231,6 +585,8 @@ typedef struct{
  * @param RPDO This object will be initialized.
  * @param em Emergency object.
  * @param SDO SDO server object.
+ * @param SYNC SYNC object. It separates messages of synchronous RPDO
+ * received before and after the SYNC.
  * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
  * @param nodeId CANopen Node ID of this device. If default COB_ID is used, value will be added.
  * @param defaultCOB_ID Default COB ID for this PDO (without NodeId).
@@ -245,6 +601,9 @@ typedef struct{
  * dictionary (index 0x1400+).
  * @param RPDOMapPar Pointer to _RPDO mapping parameter_ record from Object
  * dictionary (index 0x1600+).
+ * @param overflowCounter Pointer to _RPDO overflow counter_ variable from
+ * Object dictionary (manufacturer specific section) or NULL. It counts received
+ * messages, which were overwritten before processed. See #CO_RPDO_BUFFER_SIZE.
  * @param idx_RPDOCommPar Index in Object Dictionary.
  * @param idx_RPDOMapPar Index in Object Dictionary.
  * @param CANdevRx CAN device for PDO reception.
@@ -256,12 +615,14 @@ int16_t CO_RPDO_init(
         CO_RPDO_t              *RPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_SYNC_t              *SYNC,
         uint8_t                *operatingState,
         uint8_t                 nodeId,
         uint16_t                defaultCOB_ID,
         uint8_t                 restrictionFlags,
         const CO_RPDOCommPar_t *RPDOCommPar,
         const CO_RPDOMapPar_t  *RPDOMapPar,
+        uint32_t               *overflowCounter,
         uint16_t                idx_RPDOCommPar,
         uint16_t                idx_RPDOMapPar,
         CO_CANmodule_t         *CANdevRx,
@@ -292,6 +653,9 @@ int16_t CO_RPDO_init(
  * dictionary (index 0x1600+).
  * @param idx_TPDOCommPar Index in Object Dictionary.
  * @param idx_TPDOMapPar Index in Object Dictionary.
+ * @param CANdevRx CAN device for reception of Remote Transmission Request or
+ * NULL, if RTR is not received.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device.
  * @param CANdevTx CAN device used for PDO transmission.
  * @param CANdevTxIdx Index of transmit buffer in the above CAN device.
  *
@@ -309,6 +673,8 @@ int16_t CO_TPDO_init(
         const CO_TPDOMapPar_t  *TPDOMapPar,
         uint16_t                idx_TPDOCommPar,
         uint16_t                idx_TPDOMapPar,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx,
         CO_CANmodule_t         *CANdevTx,
         uint16_t                CANdevTxIdx);
 
@@ -344,16 +710,45 @@ uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO);
 int16_t CO_TPDOsend(CO_TPDO_t *TPDO);
 
 
+/**
+ * Send DAM MPDO message.
+ *
+ * Function writes object in Object Dictionary of other node(s). It may be
+ * called by application from the same thread as CO_TPDO_process(), if TPDO
+ * is configured as DAM MPDO and NMT operating state is operational.
+ *
+ * @param TPDO TPDO object.
+ * @param nodeId Node-ID of the destination node or 0 for all nodes.
+ * @param index Index of the object in Object Dictionary of destination node.
+ * @param subIndex Sub-index of the object in Object Dictionary of destination node.
+ * @param data Data of the object in CANopen (little endian) byte order.
+ * @param length Length of the data, 1 to 4.
+ *
+ * @return Same as CO_CANsend() or CO_ERROR_ILLEGAL_ARGUMENT, if TPDO is not
+ * valid DAM MPDO, is not operational or arguments are wrong.
+ */
+int16_t CO_TPDOsendDAM(
+        CO_TPDO_t              *TPDO,
+        uint8_t                 nodeId,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        const uint8_t          *data,
+        uint8_t                 length);
+
+
 /**
  * Process received PDO messages.
  *
  * Function must be called cyclically in any NMT state. It copies data from RPDO
  * to Object Dictionary variables if: new PDO receives and PDO is valid and NMT
- * operating state is operational. It does not verify _transmission type_.
+ * operating state is operational. Synchronous RPDO is processed only, if
+ * _syncWas_ is true. See #CO_RPDO_BUFFER_SIZE.
  *
  * @param RPDO This object.
+ * @param syncWas True, if CANopen SYNC message was just received or
+ * transmitted (CO_SYNC_process() returned 1).
  */
-void CO_RPDO_process(CO_RPDO_t *RPDO);
+void CO_RPDO_process(CO_RPDO_t *RPDO, CO_bool_t syncWas);
 
 
 /**
@@ -375,5 +770,115 @@ void CO_TPDO_process(
         uint16_t                timeDifference_ms);
 
 
+/**
+ * Send TPDO with transmission type 253 on Remote Transmission Request.
+ *
+ * Function is called from CO_TPDO_process(). It may be called also directly
+ * after CAN reception (see CO_TPDO_t::pFunctSignal), so TPDO is not delayed
+ * until next cycle. It must be called from the same thread as
+ * CO_TPDO_process(), because current data are read from Object Dictionary.
+ *
+ * @param TPDO This object.
+ */
+void CO_TPDO_processRTR(CO_TPDO_t *TPDO);
+
+
+/**
+ * Initialize MPDO object.
+ *
+ * Function must be called in the communication reset section. Application
+ * then sets _MPDO_ of RPDO and TPDO objects, which may be configured as SAM
+ * MPDO.
+ *
+ * @param MPDO This object will be initialized.
+ * @param SDO SDO server object.
+ * @param scannerList Pointer to _object scanner list_ array from Object
+ * dictionary (index 0x1FA0) or NULL.
+ * @param scannerListSize Number of entries in _scannerList_.
+ * @param dispatcherList Pointer to _object dispatcher list_ array from Object
+ * dictionary (index 0x1FD0) or NULL.
+ * @param dispatcherListSize Number of entries in _dispatcherList_.
+ * @param idx_dispatcherList Index in Object Dictionary.
+ * @param dispatch Array of _dispatcherListSize_ rows, used internally.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_MPDO_init(
+        CO_MPDO_t              *MPDO,
+        CO_SDO_t               *SDO,
+        const uint32_t         *scannerList,
+        uint8_t                 scannerListSize,
+        const uint64_t         *dispatcherList,
+        uint8_t                 dispatcherListSize,
+        uint16_t                idx_dispatcherList,
+        CO_MPDOdispatch_t      *dispatch);
+
+
+#ifdef CO_TPDO_CHANGE_DRIVEN
+/**
+ * Initialize TPDO notification object.
+ *
+ * Function must be called in the communication reset section, after all
+ * TPDOs are initialized. It registers itself to the SDO server and marks all
+ * TPDOs for processing.
+ *
+ * @param notify This object will be initialized.
+ * @param TPDO Array of pointers to TPDO objects.
+ * @param TPDOcount Size of the _TPDO_ array.
+ * @param SDO SDO server object.
+ * @param mapRef Array of SDO->ODSize pointers, used internally.
+ * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
+ */
+void CO_TPDOnotify_init(
+        CO_TPDOnotify_t        *notify,
+        CO_TPDO_t             **TPDO,
+        uint16_t                TPDOcount,
+        CO_SDO_t               *SDO,
+        CO_TPDOmapRef_t       **mapRef,
+        uint8_t                *operatingState);
+
+
+/**
+ * Report written Object Dictionary variable.
+ *
+ * Application must call this function after it writes variable, which may be
+ * mapped to TPDO with Change of State detection. TPDOs, which map the
+ * variable, will be processed in the next cycle.
+ *
+ * @param notify This object.
+ * @param index Index of the variable in Object Dictionary.
+ * @param subIndex Sub-index of the variable in Object Dictionary.
+ */
+void CO_TPDOnotify_written(CO_TPDOnotify_t *notify, uint16_t index, uint8_t subIndex);
+
+
+/**
+ * Mark TPDO for processing in the next cycle.
+ *
+ * Application must call this function after it sets _sendRequest_ of the TPDO.
+ *
+ * @param TPDO TPDO object.
+ */
+void CO_TPDOmarkDirty(CO_TPDO_t *TPDO);
+
+
+/**
+ * Process transmitting PDO messages, change driven.
+ *
+ * Function must be called cyclically in any NMT state instead of
+ * CO_TPDOisCOS() and CO_TPDO_process() for each TPDO. It processes only marked
+ * TPDOs, TPDOs with expired timers and synchronous TPDOs after SYNC.
+ *
+ * @param notify This object.
+ * @param SYNC SYNC object. Ignored if NULL.
+ * @param timeDifference_ms Time difference from previous function call in [milliseconds].
+ */
+void CO_TPDOnotify_process(
+        CO_TPDOnotify_t        *notify,
+        CO_SYNC_t              *SYNC,
+        uint16_t                timeDifference_ms);
+#endif
+
+
 /** @} */
 #endif
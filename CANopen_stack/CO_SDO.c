@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "crc16-ccitt.h"
 
@@ -41,8 +42,8 @@
 #define CCS_ABORT                      0x80U
 
 
-#if CO_SDO_BUFFER_SIZE < 7
-    #error CO_SDO_BUFFER_SIZE must be greater than 7
+#if CO_SDO_BUFFER_SIZE < 7 || CO_SDO_BUFFER_SIZE > 65535
+    #error CO_SDO_BUFFER_SIZE must be in range from 7 to 65535
 #endif
 
 
@@ -126,7 +127,7 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
     SDO = (CO_SDO_t*)object;   /* this is the correct pointer type of the first argument */
 
     /* verify message length and message overflow (previous message was not processed yet) */
-    if((msg->DLC == 8U) && (!SDO->CANrxNew)){
+    if((msg->DLC >= 8U) && (msg->DLC <= CO_CAN_DATA_MAX) && (!CO_FLAG_READ(SDO->CANrxNew))){
         if(SDO->state != CO_SDO_ST_DOWNLOAD_BL_SUBBLOCK) {
             /* copy data and set 'new message' flag */
             SDO->CANrxData[0] = msg->data[0];
@@ -137,8 +138,17 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
             SDO->CANrxData[5] = msg->data[5];
             SDO->CANrxData[6] = msg->data[6];
             SDO->CANrxData[7] = msg->data[7];
+#if CO_CAN_DATA_MAX > 8U
+            {
+                uint8_t i;
+                for(i=8U; i<msg->DLC; i++){
+                    SDO->CANrxData[i] = msg->data[i];
+                }
+            }
+#endif
+            SDO->CANrxDLC = msg->DLC;
 
-            SDO->CANrxNew = CO_true;
+            CO_FLAG_SET(SDO->CANrxNew);
         }
         else {
             /* block download, copy data directly */
@@ -146,7 +156,7 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
 
             SDO->CANrxData[0] = msg->data[0];
             seqno = SDO->CANrxData[0] & 0x7fU;
-            SDO->timeoutTimer = 0;
+            CO_FLAG_SET(SDO->CANrxActivity);
 
             /* check correct sequence number. */
             if(seqno == (SDO->sequence + 1U)) {
@@ -156,12 +166,12 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
                 SDO->sequence++;
 
                 /* copy data */
-                for(i=1; i<8; i++) {
+                for(i=1; (i<=SDO->segSize) && (i<msg->DLC); i++) {
                     SDO->ODF_arg.data[SDO->bufferOffset++] = msg->data[i]; //SDO->ODF_arg.data is equal as SDO->databuffer
                     if(SDO->bufferOffset >= CO_SDO_BUFFER_SIZE) {
                         /* buffer full, break reception */
                         SDO->state = CO_SDO_ST_DOWNLOAD_BL_SUB_RESP;
-                        SDO->CANrxNew = CO_true;
+                        CO_FLAG_SET(SDO->CANrxNew);
                         break;
                     }
                 }
@@ -169,7 +179,7 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
                 /* break reception if last segment or block sequence is too large */
                 if(((SDO->CANrxData[0] & 0x80U) == 0x80U) || (SDO->sequence >= SDO->blksize)) {
                     SDO->state = CO_SDO_ST_DOWNLOAD_BL_SUB_RESP;
-                    SDO->CANrxNew = CO_true;
+                    CO_FLAG_SET(SDO->CANrxNew);
                 }
             }
             else if((seqno == SDO->sequence) || (SDO->sequence == 0U)){
@@ -178,18 +188,56 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
             else {
                 /* seqno is totally wrong, break reception. */
                 SDO->state = CO_SDO_ST_DOWNLOAD_BL_SUB_RESP;
-                SDO->CANrxNew = CO_true;
+                CO_FLAG_SET(SDO->CANrxNew);
             }
         }
 
         /* Optional signal to RTOS, which can resume task, which handles SDO server. */
-        if(SDO->CANrxNew && SDO->pFunctSignal) {
+        if(CO_FLAG_READ(SDO->CANrxNew) && SDO->pFunctSignal) {
             SDO->pFunctSignal(SDO->functArg);
         }
     }
 }
 
 
+/*
+ * Configure CAN reception and transmission of SDO server channel.
+ *
+ * @param SDO This object.
+ * @param COB_IDClientToServer COB-ID, channel is not used, if bit 31 is set.
+ * @param COB_IDServerToClient COB-ID, channel is not used, if bit 31 is set.
+ */
+static void CO_SDO_configCom(CO_SDO_t *SDO, uint32_t COB_IDClientToServer, uint32_t COB_IDServerToClient){
+    uint16_t IDClientToServer = (uint16_t)(COB_IDClientToServer & 0x7FFU);
+    uint16_t IDServerToClient = (uint16_t)(COB_IDServerToClient & 0x7FFU);
+
+    /* channel, which is not used, receives nothing */
+    if(((COB_IDClientToServer | COB_IDServerToClient) & 0x80000000UL) != 0U){
+        IDClientToServer = 0U;
+        IDServerToClient = 0U;
+    }
+
+    /* configure SDO server CAN reception */
+    CO_CANrxBufferInit(
+            SDO->CANdevRx,          /* CAN device */
+            SDO->CANdevRxIdx,       /* rx buffer index */
+            IDClientToServer,       /* CAN identifier */
+            0x7FF,                  /* mask */
+            0,                      /* rtr */
+            (void*)SDO,             /* object passed to receive function */
+            CO_SDO_receive);        /* this function will process received message */
+
+    /* configure SDO server CAN transmission */
+    SDO->CANtxBuff = CO_CANtxBufferInit(
+            SDO->CANdevTx,          /* CAN device */
+            SDO->CANdevTxIdx,       /* index of specific buffer inside CAN module */
+            IDServerToClient,       /* CAN identifier */
+            0,                      /* rtr */
+            8,                      /* number of data bytes */
+            0);                     /* synchronous message flag bit */
+}
+
+
 /*
  * Function for accessing _SDO server parameter_ (index 0x1200+) from SDO server.
  *
@@ -197,16 +245,44 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
  */
 static CO_SDO_abortCode_t CO_ODF_1200(CO_ODF_arg_t *ODF_arg);
 static CO_SDO_abortCode_t CO_ODF_1200(CO_ODF_arg_t *ODF_arg){
-    uint8_t *nodeId;
+    CO_SDO_t *SDO;
     uint32_t value;
     CO_SDO_abortCode_t ret = CO_SDO_AB_NONE;
 
-    nodeId = (uint8_t*) ODF_arg->object;
+    SDO = (CO_SDO_t*) ODF_arg->object;
     value = CO_getUint32(ODF_arg->data);
 
-    /* if SDO reading Object dictionary 0x1200, add nodeId to the value */
-    if((ODF_arg->reading) && (ODF_arg->subIndex > 0U)){
-        CO_setUint32(ODF_arg->data, value + *nodeId);
+    if(ODF_arg->index == OD_H1200_SDO_SERVER_PARAM){
+        /* default SDO channel is fixed, it shares attributes with additional
+         * channels in Object Dictionary */
+        if(!ODF_arg->reading){
+            ret = CO_SDO_AB_READONLY;
+        }
+        /* if SDO reading Object dictionary 0x1200, add nodeId to COB-IDs */
+        else if(ODF_arg->subIndex == 1U || ODF_arg->subIndex == 2U){
+            CO_setUint32(ODF_arg->data, value + SDO->nodeId);
+        }
+    }
+    /* additional SDO server channel, COB-IDs may be changed */
+    else if((!ODF_arg->reading) && (ODF_arg->subIndex == 1U || ODF_arg->subIndex == 2U)){
+        uint16_t entryNo = CO_OD_find(SDO, ODF_arg->index);
+        uint32_t COB_ID1 = *((uint32_t*)CO_OD_getDataPointer(SDO, entryNo, 1U));
+        uint32_t COB_ID2 = *((uint32_t*)CO_OD_getDataPointer(SDO, entryNo, 2U));
+        uint32_t *current = (ODF_arg->subIndex == 1U) ? &COB_ID1 : &COB_ID2;
+
+        /* bits 11...29 must be zero */
+        if((value & 0x3FFFF800UL) != 0U){
+            ret = CO_SDO_AB_INVALID_VALUE;
+        }
+        /* if COB-ID is valid, it can not be changed */
+        else if(((*current & 0x80000000UL) == 0U) && ((value & 0x80000000UL) == 0U)
+                && (((value ^ *current) & 0x7FFU) != 0U)){
+            ret = CO_SDO_AB_INVALID_VALUE;
+        }
+        else{
+            *current = value;
+            CO_SDO_configCom(SDO, COB_ID1, COB_ID2);
+        }
     }
 
     return ret;
@@ -216,13 +292,14 @@ static CO_SDO_abortCode_t CO_ODF_1200(CO_ODF_arg_t *ODF_arg){
 /******************************************************************************/
 int16_t CO_SDO_init(
         CO_SDO_t               *SDO,
-        uint16_t                COB_IDClientToServer,
-        uint16_t                COB_IDServerToClient,
+        uint32_t                COB_IDClientToServer,
+        uint32_t                COB_IDServerToClient,
         uint16_t                ObjDictIndex_SDOServerParameter,
         CO_SDO_t               *parentSDO,
         const CO_OD_entry_t     OD[],
         uint16_t                ODSize,
         CO_OD_extension_t      *ODExtensions,
+        CO_timerWheel_t        *timers,
         uint8_t                 nodeId,
         CO_CANmodule_t         *CANdevRx,
         uint16_t                CANdevRxIdx,
@@ -238,12 +315,17 @@ int16_t CO_SDO_init(
         SDO->OD = OD;
         SDO->ODSize = ODSize;
         SDO->ODExtensions = ODExtensions;
+        SDO->ODimages = NULL;
+        SDO->ODimagesCount = 0U;
+        SDO->ODindex = NULL;
 
         /* clear pointers in ODExtensions */
         for(i=0U; i<ODSize; i++){
             SDO->ODExtensions[i].pODFunc = NULL;
             SDO->ODExtensions[i].object = NULL;
             SDO->ODExtensions[i].flags = NULL;
+            SDO->ODExtensions[i].stream = NULL;
+            SDO->ODExtensions[i].owner = NULL;
         }
     }
     /* copy object dictionary from parent */
@@ -252,45 +334,64 @@ int16_t CO_SDO_init(
         SDO->OD = parentSDO->OD;
         SDO->ODSize = parentSDO->ODSize;
         SDO->ODExtensions = parentSDO->ODExtensions;
+        SDO->ODimages = parentSDO->ODimages;
+        SDO->ODimagesCount = parentSDO->ODimagesCount;
+        SDO->ODindex = parentSDO->ODindex;
     }
 
     /* Configure object variables */
     SDO->nodeId = nodeId;
     SDO->state = CO_SDO_ST_IDLE;
-    SDO->CANrxNew = CO_false;
+    SDO->stream = NULL;
+    SDO->completeAccess = CO_false;
+    CO_FLAG_CLEAR(SDO->CANrxNew);
+    CO_FLAG_CLEAR(SDO->CANrxActivity);
+    SDO->timers = timers;
+    CO_timer_init(&SDO->timeoutTimer, NULL, NULL);
+    SDO->CANrxDLC = 0U;
+    SDO->segSize = 7U;
     SDO->pFunctSignal = 0;
     SDO->functArg = 0;
+    SDO->pFunctWritten = NULL;
+    SDO->functWrittenObject = NULL;
 
 
-    /* Configure Object dictionary entry at index 0x1200 */
-    if(ObjDictIndex_SDOServerParameter == OD_H1200_SDO_SERVER_PARAM){
-        CO_OD_configure(SDO, ObjDictIndex_SDOServerParameter, CO_ODF_1200, (void*)&SDO->nodeId, 0U, 0U);
+    /* Configure Object dictionary entry at index 0x1200 to 0x127F */
+    if((ObjDictIndex_SDOServerParameter >= OD_H1200_SDO_SERVER_PARAM)
+        && (ObjDictIndex_SDOServerParameter < (OD_H1200_SDO_SERVER_PARAM + 0x80U))){
+        CO_OD_configure(SDO, ObjDictIndex_SDOServerParameter, CO_ODF_1200, (void*)SDO, 0U, 0U);
     }
 
-    /* configure SDO server CAN reception */
-    CO_CANrxBufferInit(
-            CANdevRx,               /* CAN device */
-            CANdevRxIdx,            /* rx buffer index */
-            COB_IDClientToServer,   /* CAN identifier */
-            0x7FF,                  /* mask */
-            0,                      /* rtr */
-            (void*)SDO,             /* object passed to receive function */
-            CO_SDO_receive);        /* this function will process received message */
-
-    /* configure SDO server CAN transmission */
+    /* configure SDO server CAN reception and transmission */
+    SDO->CANdevRx = CANdevRx;
+    SDO->CANdevRxIdx = CANdevRxIdx;
     SDO->CANdevTx = CANdevTx;
-    SDO->CANtxBuff = CO_CANtxBufferInit(
-            CANdevTx,               /* CAN device */
-            CANdevTxIdx,            /* index of specific buffer inside CAN module */
-            COB_IDServerToClient,   /* CAN identifier */
-            0,                      /* rtr */
-            8,                      /* number of data bytes */
-            0);                     /* synchronous message flag bit */
+    SDO->CANdevTxIdx = CANdevTxIdx;
+    CO_SDO_configCom(SDO, COB_IDClientToServer, COB_IDServerToClient);
 
     return CO_ERROR_NO;
 }
 
 
+/******************************************************************************/
+void CO_OD_configureStream(
+        CO_SDO_t               *SDO,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        CO_SDO_stream_t        *stream)
+{
+    uint16_t entryNo;
+
+    entryNo = CO_OD_find(SDO, index);
+    if(entryNo < 0xFFFFU){
+        if(stream != NULL){
+            stream->subIndex = subIndex;
+        }
+        SDO->ODExtensions[entryNo].stream = stream;
+    }
+}
+
+
 /******************************************************************************/
 void CO_OD_configure(
         CO_SDO_t               *SDO,
@@ -325,11 +426,18 @@ void CO_OD_configure(
 
 /******************************************************************************/
 uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index){
-    /* Fast search in ordered Object Dictionary. If indexes are mixed, this won't work. */
-    /* If Object Dictionary has up to 2^N entries, then N is max number of loop passes. */
     uint16_t cur, min, max;
     const CO_OD_entry_t* object;
 
+    /* Direct index, generated together with Object Dictionary. */
+    if(SDO->ODindex != NULL){
+        uint8_t page = SDO->ODindex->page[index >> 8];
+
+        return (page != 0xFFU) ? SDO->ODindex->entryNo[page][index & 0xFFU] : 0xFFFFU;
+    }
+
+    /* Fast search in ordered Object Dictionary. If indexes are mixed, this won't work. */
+    /* If Object Dictionary has up to 2^N entries, then N is max number of loop passes. */
     min = 0U;
     max = SDO->ODSize - 1U;
     while(min < max){
@@ -434,7 +542,7 @@ void* CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
     }
 
     if(object->maxSubIndex == 0U){   /* Object type is Var */
-        return object->pData;
+        return CO_OD_getInstancePointer(SDO, object->pData);
     }
     else if(object->attribute != 0U){/* Object type is Array */
         if(subIndex==0){
@@ -446,15 +554,35 @@ void* CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
             return 0;
         }
         else{
-            return (void*)(((int8_t*)object->pData) + ((subIndex-1) * object->length));
+            return CO_OD_getInstancePointer(SDO, ((int8_t*)object->pData) + ((subIndex-1) * object->length));
         }
     }
     else{                            /* Object Type is Record */
-        return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].pData;
+        return CO_OD_getInstancePointer(SDO, ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].pData);
     }
 }
 
 
+/******************************************************************************/
+void* CO_OD_getInstancePointer(CO_SDO_t *SDO, const void *pData){
+    const uint8_t *p = (const uint8_t*)pData;
+    uint8_t i;
+
+    if((SDO->ODimages != NULL) && (p != NULL)){
+        for(i=0U; i<SDO->ODimagesCount; i++){
+            const CO_ODimage_t *img = &SDO->ODimages[i];
+            const uint8_t *def = (const uint8_t*)img->defaultImage;
+
+            if((p >= def) && (p < (def + img->size))){
+                return (void*)(((uint8_t*)img->image) + (p - def));
+            }
+        }
+    }
+
+    return (void*)pData;
+}
+
+
 /******************************************************************************/
 uint8_t* CO_OD_getFlagsPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
     CO_OD_extension_t* ext;
@@ -474,6 +602,7 @@ uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
 
     SDO->ODF_arg.index = index;
     SDO->ODF_arg.subIndex = subIndex;
+    SDO->completeAccess = CO_false;
 
     /* find object in Object Dictionary */
     SDO->entryNo = CO_OD_find(SDO, index);
@@ -486,6 +615,19 @@ uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
         return CO_SDO_AB_SUB_UNKNOWN;     /* Sub-index does not exist. */
     }
 
+    /* object with OD function or stream is transferred by one SDO server at a time */
+    if(SDO->ODExtensions){
+        CO_OD_extension_t *ext = &SDO->ODExtensions[SDO->entryNo];
+        if((ext->pODFunc != NULL) || (ext->stream != NULL)){
+            CO_SDO_t *owner = ext->owner;
+            if((owner != NULL) && (owner != SDO) && (owner->state != CO_SDO_ST_IDLE)
+                && (owner->entryNo == SDO->entryNo)){
+                return CO_SDO_AB_DATA_DEV_STATE;
+            }
+            ext->owner = SDO;
+        }
+    }
+
     /* pointer to data in Object dictionary */
     SDO->ODF_arg.ODdataStorage = CO_OD_getDataPointer(SDO, SDO->entryNo, subIndex);
 
@@ -503,6 +645,20 @@ uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
     SDO->ODF_arg.firstSegment = CO_true;
     SDO->ODF_arg.lastSegment = CO_true;
 
+    /* stream object, its length is not limited by SDO buffer */
+    SDO->stream = NULL;
+    if(SDO->ODExtensions){
+        CO_SDO_stream_t *stream = SDO->ODExtensions[SDO->entryNo].stream;
+        if((stream != NULL) && (stream->subIndex == subIndex)){
+            SDO->stream = stream;
+            SDO->streamOffset = 0U;
+            SDO->streamBlockStart = 0U;
+            SDO->streamCrcOffset = 0U;
+            SDO->ODF_arg.dataLengthTotal = stream->size;
+            return 0U;
+        }
+    }
+
     /* indicate total data length, if not domain */
     SDO->ODF_arg.dataLengthTotal = (SDO->ODF_arg.ODdataStorage) ? SDO->ODF_arg.dataLength : 0U;
 
@@ -515,6 +671,154 @@ uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
 }
 
 
+/******************************************************************************/
+uint32_t CO_SDO_initTransferComplete(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
+    uint16_t entryNo;
+    uint8_t maxSubIndex;
+    uint32_t length = 0U;
+    uint16_t attribute = CO_ODA_READABLE | CO_ODA_WRITEABLE;
+    uint16_t i;
+
+    /* complete access starts with sub-index 0 or 1 */
+    if(subIndex > 1U){
+        return CO_SDO_AB_UNSUPPORTED_ACCESS;
+    }
+
+    entryNo = CO_OD_find(SDO, index);
+    if(entryNo == 0xFFFFU){
+        return CO_SDO_AB_NOT_EXIST;     /* object does not exist in OD */
+    }
+    maxSubIndex = SDO->OD[entryNo].maxSubIndex;
+    if(subIndex > maxSubIndex){
+        return CO_SDO_AB_SUB_UNKNOWN;     /* Sub-index does not exist. */
+    }
+
+    /* verify each sub-index and sum their lengths */
+    for(i=subIndex; i<=maxSubIndex; i++){
+        uint32_t abortCode = CO_SDO_initTransfer(SDO, index, (uint8_t)i);
+        if(abortCode != 0U){
+            return abortCode;
+        }
+
+        /* length of domain and stream object is not known */
+        if((SDO->ODF_arg.ODdataStorage == 0) || (SDO->stream != NULL)){
+            return CO_SDO_AB_UNSUPPORTED_ACCESS;
+        }
+        length += SDO->ODF_arg.dataLength;
+
+        if((SDO->ODF_arg.attribute & CO_ODA_READABLE) == 0U){
+            attribute &= ~CO_ODA_READABLE;
+        }
+        /* sub-index 0, which is not writeable, is skipped in download */
+        if(((SDO->ODF_arg.attribute & CO_ODA_WRITEABLE) == 0U) && ((i != 0U) || (maxSubIndex == 0U))){
+            attribute &= ~CO_ODA_WRITEABLE;
+        }
+    }
+
+    /* verify length */
+    if(length > CO_SDO_BUFFER_SIZE){
+        return CO_SDO_AB_DEVICE_INCOMPAT;     /* general internal incompatibility in the device */
+    }
+
+    /* ODF_arg describes the whole transfer */
+    SDO->ODF_arg.subIndex = subIndex;
+    SDO->ODF_arg.dataLength = (uint16_t)length;
+    SDO->ODF_arg.dataLengthTotal = length;
+    SDO->ODF_arg.attribute = attribute;
+    SDO->completeAccess = CO_true;
+
+    return 0U;
+}
+
+
+/*
+ * Read all sub-indexes of complete access transfer, see CO_SDO_readOD().
+ *
+ * Each sub-index is initialized with CO_SDO_initTransfer(), which clears
+ * _completeAccess_, and read with CO_SDO_readOD() after its predecessor.
+ */
+static uint32_t CO_SDO_readODcomplete(CO_SDO_t *SDO, uint16_t SDOBufferSize){
+    uint8_t *data = SDO->ODF_arg.data;
+    uint16_t index = SDO->ODF_arg.index;
+    uint8_t subIndex = SDO->ODF_arg.subIndex;
+    uint16_t attribute = SDO->ODF_arg.attribute;
+    uint16_t offset = 0U;
+    uint16_t i;
+
+    for(i=subIndex; i<=SDO->OD[SDO->entryNo].maxSubIndex; i++){
+        uint32_t abortCode = CO_SDO_initTransfer(SDO, index, (uint8_t)i);
+        if(abortCode != 0U){
+            return abortCode;
+        }
+        if(SDO->ODF_arg.dataLength > (SDOBufferSize - offset)){
+            return CO_SDO_AB_OUT_OF_MEM;    /* Out of memory */
+        }
+
+        SDO->ODF_arg.data = &data[offset];
+        abortCode = CO_SDO_readOD(SDO, SDOBufferSize - offset);
+        if(abortCode != 0U){
+            return abortCode;
+        }
+        offset += SDO->ODF_arg.dataLength;
+    }
+
+    SDO->ODF_arg.subIndex = subIndex;
+    SDO->ODF_arg.data = data;
+    SDO->ODF_arg.dataLength = offset;
+    SDO->ODF_arg.dataLengthTotal = offset;
+    SDO->ODF_arg.attribute = attribute;
+    SDO->completeAccess = CO_true;
+
+    return 0U;
+}
+
+
+/*
+ * Write all sub-indexes of complete access transfer, see CO_SDO_writeOD().
+ *
+ * Sub-indexes are written in the same way as they are read in
+ * CO_SDO_readODcomplete(). Length of data is verified before the first one.
+ */
+static uint32_t CO_SDO_writeODcomplete(CO_SDO_t *SDO, uint16_t length){
+    uint8_t *data = SDO->ODF_arg.data;
+    uint16_t index = SDO->ODF_arg.index;
+    uint8_t subIndex = SDO->ODF_arg.subIndex;
+    uint8_t maxSubIndex = SDO->OD[SDO->entryNo].maxSubIndex;
+    uint16_t offset = 0U;
+    uint16_t i;
+
+    if(length != SDO->ODF_arg.dataLength){
+        return CO_SDO_AB_TYPE_MISMATCH;     /* Length of service parameter does not match */
+    }
+
+    for(i=subIndex; i<=maxSubIndex; i++){
+        uint16_t len;
+        uint32_t abortCode = CO_SDO_initTransfer(SDO, index, (uint8_t)i);
+        if(abortCode != 0U){
+            return abortCode;
+        }
+        len = SDO->ODF_arg.dataLength;
+
+        /* skip sub-index 0, which is not writeable */
+        if((i != 0U) || (maxSubIndex == 0U) || ((SDO->ODF_arg.attribute & CO_ODA_WRITEABLE) != 0U)){
+            SDO->ODF_arg.data = &data[offset];
+            abortCode = CO_SDO_writeOD(SDO, len);
+            if(abortCode != 0U){
+                return abortCode;
+            }
+        }
+        offset += len;
+    }
+
+    SDO->ODF_arg.subIndex = subIndex;
+    SDO->ODF_arg.data = data;
+    SDO->ODF_arg.dataLength = length;
+    SDO->completeAccess = CO_true;
+
+    return 0U;
+}
+
+
 /******************************************************************************/
 uint32_t CO_SDO_readOD(CO_SDO_t *SDO, uint16_t SDOBufferSize){
     uint8_t *SDObuffer = SDO->ODF_arg.data;
@@ -522,6 +826,10 @@ uint32_t CO_SDO_readOD(CO_SDO_t *SDO, uint16_t SDOBufferSize){
     uint16_t length = SDO->ODF_arg.dataLength;
     CO_OD_extension_t *ext = 0;
 
+    if(SDO->completeAccess){
+        return CO_SDO_readODcomplete(SDO, SDOBufferSize);
+    }
+
     /* is object readable? */
     if((SDO->ODF_arg.attribute & CO_ODA_READABLE) == 0)
         return CO_SDO_AB_WRITEONLY;     /* attempt to read a write-only object */
@@ -584,6 +892,10 @@ uint32_t CO_SDO_writeOD(CO_SDO_t *SDO, uint16_t length){
     uint8_t *SDObuffer = SDO->ODF_arg.data;
     uint8_t *ODdata = (uint8_t*)SDO->ODF_arg.ODdataStorage;
 
+    if(SDO->completeAccess){
+        return CO_SDO_writeODcomplete(SDO, length);
+    }
+
     /* is object writeable? */
     if((SDO->ODF_arg.attribute & CO_ODA_WRITEABLE) == 0){
         return CO_SDO_AB_READONLY;     /* attempt to write a read-only object */
@@ -636,12 +948,83 @@ uint32_t CO_SDO_writeOD(CO_SDO_t *SDO, uint16_t length){
             *(ODdata++) = *(SDObuffer++);
         }
         CO_ENABLE_INTERRUPTS();
+
+        if(SDO->pFunctWritten != NULL){
+            SDO->pFunctWritten(SDO->functWrittenObject, SDO->entryNo, SDO->ODF_arg.subIndex);
+        }
     }
 
     return 0;
 }
 
 
+/*
+ * Copy data between buffer and stream object at SDO->streamOffset.
+ *
+ * @param SDO This object.
+ * @param buf Data of CAN message or SDO buffer.
+ * @param count Number of bytes to copy.
+ * @param writing True for download, data are copied from _buf_ to the stream.
+ *
+ * @return 0 or #CO_SDO_abortCode_t.
+ */
+static uint32_t CO_SDO_streamCopy(CO_SDO_t *SDO, uint8_t *buf, uint16_t count, CO_bool_t writing){
+    CO_SDO_stream_t *stream = SDO->stream;
+
+    if(writing && (count > (stream->capacity - SDO->streamOffset))){
+        return CO_SDO_AB_DATA_LONG;     /* Length of service parameter too high */
+    }
+
+    while(count > 0U){
+        uint32_t len = count;
+        uint8_t *window;
+
+        if(stream->pFunctWindow != NULL){
+            window = stream->pFunctWindow(stream->object, SDO->streamOffset, &len, writing);
+            if((window == NULL) || (len == 0U) || (len > count)){
+                return CO_SDO_AB_HW;    /* Access failed due to hardware error */
+            }
+        }
+        else{
+            window = &stream->data[SDO->streamOffset];
+        }
+
+        if(writing){
+            CO_memcpy(window, buf, (uint16_t)len);
+        }
+        else{
+            CO_memcpy(buf, window, (uint16_t)len);
+        }
+        buf += len;
+        count -= (uint16_t)len;
+        SDO->streamOffset += len;
+    }
+
+    return 0U;
+}
+
+
+/*
+ * Finish transfer of stream object.
+ *
+ * @param SDO This object.
+ * @param writing True for download, size of the stream is set.
+ *
+ * @return 0 or #CO_SDO_abortCode_t from CO_SDO_stream_t::pFunctFinished.
+ */
+static uint32_t CO_SDO_streamFinish(CO_SDO_t *SDO, CO_bool_t writing){
+    CO_SDO_stream_t *stream = SDO->stream;
+
+    if(writing){
+        stream->size = SDO->streamOffset;
+    }
+    if(stream->pFunctFinished != NULL){
+        return stream->pFunctFinished(stream->object, writing);
+    }
+    return 0U;
+}
+
+
 /******************************************************************************/
 static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
     SDO->CANtxBuff->data[0] = 0x80;
@@ -649,8 +1032,11 @@ static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
     SDO->CANtxBuff->data[2] = (SDO->ODF_arg.index>>8) & 0xFF;
     SDO->CANtxBuff->data[3] = SDO->ODF_arg.subIndex;
     CO_memcpySwap4(&SDO->CANtxBuff->data[4], (uint8_t*)&code);
+#if CO_CAN_DATA_MAX > 8U
+    SDO->CANtxBuff->DLC = 8U;
+#endif
     SDO->state = CO_SDO_ST_IDLE;
-    SDO->CANrxNew = CO_false;
+    CO_FLAG_CLEAR(SDO->CANrxNew);
     CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
 }
 
@@ -659,7 +1045,6 @@ static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
 int8_t CO_SDO_process(
         CO_SDO_t               *SDO,
         CO_bool_t               NMTisPreOrOperational,
-        uint16_t                timeDifference_ms,
         uint16_t                SDOtimeoutTime)
 {
     CO_SDO_state_t state = CO_SDO_ST_IDLE;
@@ -667,33 +1052,41 @@ int8_t CO_SDO_process(
     CO_bool_t sendResponse = CO_false;
 
     /* return if idle */
-    if((SDO->state == CO_SDO_ST_IDLE) && (!SDO->CANrxNew)){
+    if((SDO->state == CO_SDO_ST_IDLE) && (!CO_FLAG_READ(SDO->CANrxNew))){
         return 0;
     }
 
     /* SDO is allowed to work only in operational or pre-operational NMT state */
     if(!NMTisPreOrOperational){
         SDO->state = CO_SDO_ST_IDLE;
-        SDO->CANrxNew = CO_false;
+        CO_FLAG_CLEAR(SDO->CANrxNew);
         return 0;
     }
 
     /* Is something new to process? */
-    if((!SDO->CANtxBuff->bufferFull) && ((SDO->CANrxNew) || (SDO->state == CO_SDO_ST_UPLOAD_BL_SUBBLOCK))){
+    if((!CO_FLAG_READ(SDO->CANtxBuff->bufferFull)) && ((CO_FLAG_READ(SDO->CANrxNew)) || (SDO->state == CO_SDO_ST_UPLOAD_BL_SUBBLOCK))){
         uint8_t CCS = SDO->CANrxData[0] >> 5;   /* Client command specifier */
 
         /* reset timeout */
         if(SDO->state != CO_SDO_ST_UPLOAD_BL_SUBBLOCK)
-            SDO->timeoutTimer = 0;
+            CO_timer_start(SDO->timers, &SDO->timeoutTimer, SDOtimeoutTime);
 
         /* clear response buffer */
         SDO->CANtxBuff->data[0] = SDO->CANtxBuff->data[1] = SDO->CANtxBuff->data[2] = SDO->CANtxBuff->data[3] = 0;
         SDO->CANtxBuff->data[4] = SDO->CANtxBuff->data[5] = SDO->CANtxBuff->data[6] = SDO->CANtxBuff->data[7] = 0;
+#if CO_CAN_DATA_MAX > 8U
+        {
+            uint8_t i;
+            for(i=8U; i<=SDO->segSize; i++){
+                SDO->CANtxBuff->data[i] = 0;
+            }
+        }
+#endif
 
         /* Is abort from client? */
-        if((SDO->CANrxNew) && (SDO->CANrxData[0] == CCS_ABORT)){
+        if((CO_FLAG_READ(SDO->CANrxNew)) && (SDO->CANrxData[0] == CCS_ABORT)){
             SDO->state = CO_SDO_ST_IDLE;
-            SDO->CANrxNew = CO_false;
+            CO_FLAG_CLEAR(SDO->CANrxNew);
             return -1;
         }
 
@@ -704,6 +1097,9 @@ int8_t CO_SDO_process(
         else{
             uint32_t abortCode;
 
+            /* segments of new transfer are classic by default */
+            SDO->segSize = 7U;
+
             /* Is client command specifier valid */
             if((CCS != CCS_DOWNLOAD_INITIATE) && (CCS != CCS_UPLOAD_INITIATE) &&
                 (CCS != CCS_DOWNLOAD_BLOCK) && (CCS != CCS_UPLOAD_BLOCK)){
@@ -711,13 +1107,27 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
-            /* init ODF_arg */
-            abortCode = CO_SDO_initTransfer(SDO, (uint16_t)SDO->CANrxData[2]<<8 | SDO->CANrxData[1], SDO->CANrxData[3]);
+            /* init ODF_arg, for single sub-index or complete access */
+            if((SDO->CANrxData[0] & 0x10U) != 0U){
+                abortCode = CO_SDO_initTransferComplete(SDO, (uint16_t)SDO->CANrxData[2]<<8 | SDO->CANrxData[1], SDO->CANrxData[3]);
+            }
+            else{
+                abortCode = CO_SDO_initTransfer(SDO, (uint16_t)SDO->CANrxData[2]<<8 | SDO->CANrxData[1], SDO->CANrxData[3]);
+            }
             if(abortCode != 0U){
                 CO_SDO_abort(SDO, abortCode);
                 return -1;
             }
 
+#if CO_CAN_DATA_MAX > 8U
+            /* Client uses CAN FD frames, use long segments. Length of domain
+             * is not known in advance, so it uses classic segments. */
+            if((SDO->CANrxDLC > 8U) && (SDO->ODF_arg.ODdataStorage != 0) && (SDO->stream == NULL)){
+                SDO->segSize = CO_CAN_DATA_MAX - 1U;
+            }
+            SDO->CANtxBuff->DLC = SDO->segSize + 1U;
+#endif
+
             /* download */
             if((CCS == CCS_DOWNLOAD_INITIATE) || (CCS == CCS_DOWNLOAD_BLOCK)){
                 if((SDO->ODF_arg.attribute & CO_ODA_WRITEABLE) == 0U){
@@ -736,14 +1146,27 @@ int8_t CO_SDO_process(
 
             /* upload */
             else{
-                abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
-                if(abortCode != 0U){
-                    CO_SDO_abort(SDO, abortCode);
-                    return -1;
+                uint32_t length;
+
+                /* stream object is read during transfer */
+                if(SDO->stream != NULL){
+                    if((SDO->ODF_arg.attribute & CO_ODA_READABLE) == 0U){
+                        CO_SDO_abort(SDO, CO_SDO_AB_WRITEONLY); /* attempt to read a write-only object */
+                        return -1;
+                    }
+                    length = SDO->stream->size;
+                }
+                else{
+                    abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
+                    if(abortCode != 0U){
+                        CO_SDO_abort(SDO, abortCode);
+                        return -1;
+                    }
+                    length = SDO->ODF_arg.dataLength;
                 }
 
                 /* if data size is large enough set state machine to block upload, otherwise set to normal transfer */
-                if((CCS == CCS_UPLOAD_BLOCK) && (SDO->ODF_arg.dataLength > SDO->CANrxData[5])){
+                if((CCS == CCS_UPLOAD_BLOCK) && (length > SDO->CANrxData[5])){
                     state = CO_SDO_ST_UPLOAD_BL_INITIATE;
                 }
                 else{
@@ -753,12 +1176,15 @@ int8_t CO_SDO_process(
         }
     }
 
-    /* verify SDO timeout */
-    if(SDO->timeoutTimer < SDOtimeoutTime){
-        SDO->timeoutTimer += timeDifference_ms;
+    /* segments of block download were received */
+    if(CO_FLAG_READ(SDO->CANrxActivity)){
+        CO_FLAG_CLEAR(SDO->CANrxActivity);
+        CO_timer_start(SDO->timers, &SDO->timeoutTimer, SDOtimeoutTime);
     }
-    if(SDO->timeoutTimer >= SDOtimeoutTime){
-        if((SDO->state == CO_SDO_ST_DOWNLOAD_BL_SUBBLOCK) && (SDO->sequence != 0) && (!SDO->CANtxBuff->bufferFull)){
+
+    /* verify SDO timeout. Timer is started by the first message of transfer. */
+    if((SDO->state != CO_SDO_ST_IDLE) && !CO_timer_isRunning(&SDO->timeoutTimer)){
+        if((SDO->state == CO_SDO_ST_DOWNLOAD_BL_SUBBLOCK) && (SDO->sequence != 0) && (!CO_FLAG_READ(SDO->CANtxBuff->bufferFull))){
             timeoutSubblockDownolad = CO_true;
             state = CO_SDO_ST_DOWNLOAD_BL_SUB_RESP;
         }
@@ -796,14 +1222,23 @@ int8_t CO_SDO_process(
                     len = 4U;
                 }
 
-                /* copy data to SDO buffer */
-                SDO->ODF_arg.data[0] = SDO->CANrxData[4];
-                SDO->ODF_arg.data[1] = SDO->CANrxData[5];
-                SDO->ODF_arg.data[2] = SDO->CANrxData[6];
-                SDO->ODF_arg.data[3] = SDO->CANrxData[7];
-
-                /* write data to the Object dictionary */
-                abortCode = CO_SDO_writeOD(SDO, len);
+                /* write data directly to the stream object */
+                if(SDO->stream != NULL){
+                    abortCode = CO_SDO_streamCopy(SDO, &SDO->CANrxData[4], len, CO_true);
+                    if(abortCode == 0U){
+                        abortCode = CO_SDO_streamFinish(SDO, CO_true);
+                    }
+                }
+                else{
+                    /* copy data to SDO buffer */
+                    SDO->ODF_arg.data[0] = SDO->CANrxData[4];
+                    SDO->ODF_arg.data[1] = SDO->CANrxData[5];
+                    SDO->ODF_arg.data[2] = SDO->CANrxData[6];
+                    SDO->ODF_arg.data[3] = SDO->CANrxData[7];
+
+                    /* write data to the Object dictionary */
+                    abortCode = CO_SDO_writeOD(SDO, len);
+                }
                 if(abortCode != 0U){
                     CO_SDO_abort(SDO, abortCode);
                     return -1;
@@ -822,8 +1257,15 @@ int8_t CO_SDO_process(
                     CO_memcpySwap4((uint8_t*)&lenRx, &SDO->CANrxData[4]);
                     SDO->ODF_arg.dataLengthTotal = lenRx;
 
+                    /* verify length of stream object */
+                    if(SDO->stream != NULL){
+                        if(lenRx > SDO->stream->capacity){
+                            CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                            return -1;
+                        }
+                    }
                     /* verify length except for domain data type */
-                    if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
+                    else if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
                         CO_SDO_abort(SDO, CO_SDO_AB_TYPE_MISMATCH);  /* Length of service parameter does not match */
                         return -1;
                     }
@@ -850,44 +1292,65 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
-            /* get size of data in message */
-            len = 7U - ((SDO->CANrxData[0] >> 1U) & 0x07U);
+            /* get size of data in message. Long segments don't indicate
+             * unused bytes, last one contains the rest of the object. */
+            if(SDO->segSize > 7U){
+                len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
+                if(len > SDO->segSize) len = SDO->segSize;
+            }
+            else{
+                len = 7U - ((SDO->CANrxData[0] >> 1U) & 0x07U);
+            }
 
-            /* verify length. Domain data type enables length larger than SDO buffer size */
-            if((SDO->bufferOffset + len) > SDO->ODF_arg.dataLength){
-                if(SDO->ODF_arg.ODdataStorage != 0){
-                    CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+            /* write segment directly to the stream object */
+            if(SDO->stream != NULL){
+                abortCode = CO_SDO_streamCopy(SDO, &SDO->CANrxData[1], len, CO_true);
+                if((abortCode == 0U) && ((SDO->CANrxData[0] & 0x01U) != 0U)){
+                    abortCode = CO_SDO_streamFinish(SDO, CO_true);
+                    SDO->state = CO_SDO_ST_IDLE;
+                }
+                if(abortCode != 0U){
+                    CO_SDO_abort(SDO, abortCode);
                     return -1;
                 }
-                else{
-                    /* empty buffer in domain data type */
-                    SDO->ODF_arg.lastSegment = CO_false;
+            }
+            else{
+                /* verify length. Domain data type enables length larger than SDO buffer size */
+                if((SDO->bufferOffset + len) > SDO->ODF_arg.dataLength){
+                    if(SDO->ODF_arg.ODdataStorage != 0){
+                        CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                        return -1;
+                    }
+                    else{
+                        /* empty buffer in domain data type */
+                        SDO->ODF_arg.lastSegment = CO_false;
+                        abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+                        if(abortCode != 0U){
+                            CO_SDO_abort(SDO, abortCode);
+                            return -1;
+                        }
+
+                        SDO->ODF_arg.dataLength = CO_SDO_BUFFER_SIZE;
+                        SDO->bufferOffset = 0;
+                    }
+                }
+
+                /* copy data to buffer */
+                for(i=0U; i<len; i++)
+                    SDO->ODF_arg.data[SDO->bufferOffset++] = SDO->CANrxData[i+1];
+
+                /* If no more segments to be downloaded, write data to the Object dictionary */
+                if((SDO->CANrxData[0] & 0x01U) != 0U){
+                    SDO->ODF_arg.lastSegment = CO_true;
                     abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
                     if(abortCode != 0U){
                         CO_SDO_abort(SDO, abortCode);
                         return -1;
                     }
 
-                    SDO->ODF_arg.dataLength = CO_SDO_BUFFER_SIZE;
-                    SDO->bufferOffset = 0;
-                }
-            }
-
-            /* copy data to buffer */
-            for(i=0U; i<len; i++)
-                SDO->ODF_arg.data[SDO->bufferOffset++] = SDO->CANrxData[i+1];
-
-            /* If no more segments to be downloaded, write data to the Object dictionary */
-            if((SDO->CANrxData[0] & 0x01U) != 0U){
-                SDO->ODF_arg.lastSegment = CO_true;
-                abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
-                if(abortCode != 0U){
-                    CO_SDO_abort(SDO, abortCode);
-                    return -1;
+                    /* finish */
+                    SDO->state = CO_SDO_ST_IDLE;
                 }
-
-                /* finish */
-                SDO->state = CO_SDO_ST_IDLE;
             }
 
             /* download segment response and alternate toggle bit */
@@ -911,7 +1374,11 @@ int8_t CO_SDO_process(
             SDO->CANtxBuff->data[3] = SDO->CANrxData[3];
 
             /* blksize */
-            SDO->blksize = (CO_SDO_BUFFER_SIZE > (7*127)) ? 127 : (CO_SDO_BUFFER_SIZE / 7);
+            SDO->blksize = (CO_SDO_BUFFER_SIZE > (SDO->segSize*127)) ? 127 : (CO_SDO_BUFFER_SIZE / SDO->segSize);
+            if(SDO->blksize == 0U){
+                /* long segment is larger than buffer, but object fits into it */
+                SDO->blksize = 1U;
+            }
             SDO->CANtxBuff->data[4] = SDO->blksize;
 
             /* is CRC enabled */
@@ -924,8 +1391,15 @@ int8_t CO_SDO_process(
                 CO_memcpySwap4((uint8_t*)&lenRx, &SDO->CANrxData[4]);
                 SDO->ODF_arg.dataLengthTotal = lenRx;
 
+                /* verify length of stream object */
+                if(SDO->stream != NULL){
+                    if(lenRx > SDO->stream->capacity){
+                        CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                        return -1;
+                    }
+                }
                 /* verify length except for domain data type */
-                if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
+                else if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
                     CO_SDO_abort(SDO, CO_SDO_AB_TYPE_MISMATCH);  /* Length of service parameter does not match */
                     return -1;
                 }
@@ -955,8 +1429,25 @@ int8_t CO_SDO_process(
             SDO->CANtxBuff->data[1] = SDO->sequence;
             SDO->sequence = 0;
 
+            /* pass buffer to stream object, if it can not hold the longest sub-block */
+            if(SDO->stream != NULL){
+                if((SDO->bufferOffset != 0) && !lastSegmentInSubblock
+                    && ((CO_SDO_BUFFER_SIZE - SDO->bufferOffset) < (SDO->segSize*127))){
+                    /* calculate CRC on next bytes, if enabled */
+                    if(SDO->crcEnabled){
+                        SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->bufferOffset, SDO->crc);
+                    }
+
+                    abortCode = CO_SDO_streamCopy(SDO, SDO->ODF_arg.data, SDO->bufferOffset, CO_true);
+                    if(abortCode != 0U){
+                        CO_SDO_abort(SDO, abortCode);
+                        return -1;
+                    }
+                    SDO->bufferOffset = 0;
+                }
+            }
             /* empty buffer in domain data type if not last segment */
-            if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->bufferOffset != 0) && !lastSegmentInSubblock){
+            else if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->bufferOffset != 0) && !lastSegmentInSubblock){
                 /* calculate CRC on next bytes, if enabled */
                 if(SDO->crcEnabled){
                     SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->bufferOffset, SDO->crc);
@@ -976,7 +1467,7 @@ int8_t CO_SDO_process(
 
             /* blksize */
             len = CO_SDO_BUFFER_SIZE - SDO->bufferOffset;
-            SDO->blksize = (len > (7*127)) ? 127 : (len / 7);
+            SDO->blksize = (len > (SDO->segSize*127)) ? 127 : (len / SDO->segSize);
             SDO->CANtxBuff->data[2] = SDO->blksize;
 
             /* set next state */
@@ -1005,8 +1496,15 @@ int8_t CO_SDO_process(
             }
 
             /* number of bytes in the last segment of the last block that do not contain data. */
-            len = (SDO->CANrxData[0]>>2U) & 0x07U;
-            SDO->bufferOffset -= len;
+            if(SDO->segSize > 7U){
+                if(SDO->bufferOffset > SDO->ODF_arg.dataLength){
+                    SDO->bufferOffset = SDO->ODF_arg.dataLength;
+                }
+            }
+            else{
+                len = (SDO->CANrxData[0]>>2U) & 0x07U;
+                SDO->bufferOffset -= len;
+            }
 
             /* calculate and verify CRC, if enabled */
             if(SDO->crcEnabled){
@@ -1021,9 +1519,17 @@ int8_t CO_SDO_process(
                 }
             }
 
-            /* write data to the Object dictionary */
-            SDO->ODF_arg.lastSegment = CO_true;
-            abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+            /* write data to the stream object or to the Object dictionary */
+            if(SDO->stream != NULL){
+                abortCode = CO_SDO_streamCopy(SDO, SDO->ODF_arg.data, SDO->bufferOffset, CO_true);
+                if(abortCode == 0U){
+                    abortCode = CO_SDO_streamFinish(SDO, CO_true);
+                }
+            }
+            else{
+                SDO->ODF_arg.lastSegment = CO_true;
+                abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+            }
             if(abortCode != 0U){
                 CO_SDO_abort(SDO, abortCode);
                 return -1;
@@ -1037,13 +1543,31 @@ int8_t CO_SDO_process(
         }
 
         case CO_SDO_ST_UPLOAD_INITIATE:{
+            CO_bool_t expedited = (SDO->ODF_arg.dataLength <= 4U) ? CO_true : CO_false;
+
             /* default response */
             SDO->CANtxBuff->data[1] = SDO->CANrxData[1];
             SDO->CANtxBuff->data[2] = SDO->CANrxData[2];
             SDO->CANtxBuff->data[3] = SDO->CANrxData[3];
 
+            /* short stream object is read into SDO buffer and sent expedited */
+            if(SDO->stream != NULL){
+                expedited = ((SDO->stream->size > 0U) && (SDO->stream->size <= 4U)) ? CO_true : CO_false;
+                if(expedited){
+                    SDO->ODF_arg.dataLength = (uint16_t)SDO->stream->size;
+                    abortCode = CO_SDO_streamCopy(SDO, SDO->ODF_arg.data, SDO->ODF_arg.dataLength, CO_false);
+                    if(abortCode == 0U){
+                        abortCode = CO_SDO_streamFinish(SDO, CO_false);
+                    }
+                    if(abortCode != 0U){
+                        CO_SDO_abort(SDO, abortCode);
+                        return -1;
+                    }
+                }
+            }
+
             /* Expedited transfer */
-            if(SDO->ODF_arg.dataLength <= 4U){
+            if(expedited){
                 for(i=0U; i<SDO->ODF_arg.dataLength; i++)
                     SDO->CANtxBuff->data[4U+i] = SDO->ODF_arg.data[i];
 
@@ -1089,12 +1613,37 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
+            /* read segment directly from the stream object */
+            if(SDO->stream != NULL){
+                uint32_t remaining = SDO->stream->size - SDO->streamOffset;
+
+                len = (remaining > 7U) ? 7U : (uint16_t)remaining;
+                abortCode = CO_SDO_streamCopy(SDO, &SDO->CANtxBuff->data[1], len, CO_false);
+                if((abortCode == 0U) && (SDO->streamOffset == SDO->stream->size)){
+                    abortCode = CO_SDO_streamFinish(SDO, CO_false);
+                    SDO->state = CO_SDO_ST_IDLE;
+                }
+                if(abortCode != 0U){
+                    CO_SDO_abort(SDO, abortCode);
+                    return -1;
+                }
+
+                /* first response byte, end of transfer and toggle bit */
+                SDO->CANtxBuff->data[0] = (SDO->sequence ? 0x10 : 0x00) | ((7-len)<<1);
+                if(SDO->state == CO_SDO_ST_IDLE){
+                    SDO->CANtxBuff->data[0] |= 0x01;
+                }
+                SDO->sequence = (SDO->sequence) ? 0 : 1;
+                sendResponse = CO_true;
+                break;
+            }
+
             /* calculate length to be sent */
             len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
-            if(len > 7U) len = 7U;
+            if(len > SDO->segSize) len = SDO->segSize;
 
             /* If data type is domain, re-fill the data buffer if neccessary and indicated so. */
-            if((SDO->ODF_arg.ODdataStorage == 0) && (len < 7U) && (!SDO->ODF_arg.lastSegment)){
+            if((SDO->ODF_arg.ODdataStorage == 0) && (len < SDO->segSize) && (!SDO->ODF_arg.lastSegment)){
                 /* copy previous data to the beginning */
                 for(i=0U; i<len; i++){
                     SDO->ODF_arg.data[i] = SDO->ODF_arg.data[SDO->bufferOffset+i];
@@ -1118,7 +1667,7 @@ int8_t CO_SDO_process(
 
                 /* re-calculate the length */
                 len = SDO->ODF_arg.dataLength;
-                if(len > 7U) len = 7U;
+                if(len > SDO->segSize) len = SDO->segSize;
             }
 
             /* fill response data bytes */
@@ -1126,7 +1675,7 @@ int8_t CO_SDO_process(
                 SDO->CANtxBuff->data[i+1] = SDO->ODF_arg.data[SDO->bufferOffset++];
 
             /* first response byte */
-            SDO->CANtxBuff->data[0] = 0x00 | (SDO->sequence ? 0x10 : 0x00) | ((7-len)<<1);
+            SDO->CANtxBuff->data[0] = 0x00 | (SDO->sequence ? 0x10 : 0x00) | ((len < 7U) ? ((7-len)<<1) : 0);
             SDO->sequence = (SDO->sequence) ? 0 : 1;
 
             /* verify end of transfer */
@@ -1146,10 +1695,10 @@ int8_t CO_SDO_process(
             SDO->CANtxBuff->data[2] = SDO->CANrxData[2];
             SDO->CANtxBuff->data[3] = SDO->CANrxData[3];
 
-            /* calculate CRC, if enabled */
+            /* calculate CRC, if enabled. Stream object is calculated during transfer */
             if((SDO->CANrxData[0] & 0x04U) != 0U){
                 SDO->crcEnabled = CO_true;
-                SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, 0);
+                SDO->crc = (SDO->stream != NULL) ? 0 : crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, 0);
             }
             else{
                 SDO->crcEnabled = CO_false;
@@ -1166,7 +1715,7 @@ int8_t CO_SDO_process(
             }
 
             /* verify if SDO data buffer is large enough */
-            if(((SDO->blksize*7U) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment)){
+            if(((SDO->blksize*SDO->segSize) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment) && (SDO->stream == NULL)){
                 CO_SDO_abort(SDO, CO_SDO_AB_BLOCK_SIZE); /* Invalid block size (block mode only). */
                 return -1;
             }
@@ -1197,14 +1746,14 @@ int8_t CO_SDO_process(
             SDO->bufferOffset = 0;
             SDO->sequence = 0;
             SDO->endOfTransfer = CO_false;
-            SDO->CANrxNew = CO_false;
+            CO_FLAG_CLEAR(SDO->CANrxNew);
             SDO->state = CO_SDO_ST_UPLOAD_BL_SUBBLOCK;
             /* continue in next case */
         }
 
         case CO_SDO_ST_UPLOAD_BL_SUBBLOCK:{
             /* is block confirmation received */
-            if(SDO->CANrxNew){
+            if(CO_FLAG_READ(SDO->CANrxNew)){
                 uint8_t ackseq;
                 uint16_t j;
 
@@ -1225,7 +1774,7 @@ int8_t CO_SDO_process(
                 /* end of transfer */
                 if((SDO->endOfTransfer) && (ackseq == SDO->blksize)){
                     /* first response byte */
-                    SDO->CANtxBuff->data[0] = 0xC1 | ((7 - SDO->lastLen) << 2);
+                    SDO->CANtxBuff->data[0] = 0xC1 | ((SDO->lastLen < 7U) ? ((7 - SDO->lastLen) << 2) : 0);
 
                     /* CRC */
                     if(SDO->crcEnabled)
@@ -1238,44 +1787,52 @@ int8_t CO_SDO_process(
                     break;
                 }
 
-                /* move remaining data to the beginning */
-                for(i=ackseq*7, j=0; i<SDO->ODF_arg.dataLength; i++, j++)
-                    SDO->ODF_arg.data[j] = SDO->ODF_arg.data[i];
-
-                /* set remaining data length in buffer */
-                SDO->ODF_arg.dataLength -= ackseq * 7U;
-
-                /* new block size */
-                SDO->blksize = SDO->CANrxData[2];
-
-                /* If data type is domain, re-fill the data buffer if neccessary and indicated so. */
-                if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->ODF_arg.dataLength < (SDO->blksize*7U)) && (!SDO->ODF_arg.lastSegment)){
-                    /* move the beginning of the data buffer */
-                    len = SDO->ODF_arg.dataLength; /* length of valid data in buffer */
-                    SDO->ODF_arg.data += len;
-                    SDO->ODF_arg.dataLength = CO_OD_getLength(SDO, SDO->entryNo, SDO->ODF_arg.subIndex) - len;
-
-                    /* read next data from Object dictionary function */
-                    abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
-                    if(abortCode != 0U){
-                        CO_SDO_abort(SDO, abortCode);
-                        return -1;
+                /* stream object continues after the last confirmed segment */
+                if(SDO->stream != NULL){
+                    SDO->streamOffset = SDO->streamBlockStart + (uint32_t)ackseq * SDO->segSize;
+                    SDO->streamBlockStart = SDO->streamOffset;
+                    SDO->blksize = SDO->CANrxData[2];
+                }
+                else{
+                    /* move remaining data to the beginning */
+                    for(i=ackseq*SDO->segSize, j=0; i<SDO->ODF_arg.dataLength; i++, j++)
+                        SDO->ODF_arg.data[j] = SDO->ODF_arg.data[i];
+
+                    /* set remaining data length in buffer */
+                    SDO->ODF_arg.dataLength -= ackseq * SDO->segSize;
+
+                    /* new block size */
+                    SDO->blksize = SDO->CANrxData[2];
+
+                    /* If data type is domain, re-fill the data buffer if neccessary and indicated so. */
+                    if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->ODF_arg.dataLength < (SDO->blksize*SDO->segSize)) && (!SDO->ODF_arg.lastSegment)){
+                        /* move the beginning of the data buffer */
+                        len = SDO->ODF_arg.dataLength; /* length of valid data in buffer */
+                        SDO->ODF_arg.data += len;
+                        SDO->ODF_arg.dataLength = CO_OD_getLength(SDO, SDO->entryNo, SDO->ODF_arg.subIndex) - len;
+
+                        /* read next data from Object dictionary function */
+                        abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
+                        if(abortCode != 0U){
+                            CO_SDO_abort(SDO, abortCode);
+                            return -1;
+                        }
+
+                        /* calculate CRC on next bytes, if enabled */
+                        if(SDO->crcEnabled){
+                            SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, SDO->crc);
+                        }
+
+                      /* return to the original data buffer */
+                        SDO->ODF_arg.data -= len;
+                        SDO->ODF_arg.dataLength +=  len;
                     }
 
-                    /* calculate CRC on next bytes, if enabled */
-                    if(SDO->crcEnabled){
-                        SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, SDO->crc);
+                    /* verify if SDO data buffer is large enough */
+                    if(((SDO->blksize*SDO->segSize) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment)){
+                        CO_SDO_abort(SDO, CO_SDO_AB_BLOCK_SIZE); /* Invalid block size (block mode only). */
+                        return -1;
                     }
-
-                  /* return to the original data buffer */
-                    SDO->ODF_arg.data -= len;
-                    SDO->ODF_arg.dataLength +=  len;
-                }
-
-                /* verify if SDO data buffer is large enough */
-                if(((SDO->blksize*7U) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment)){
-                    CO_SDO_abort(SDO, CO_SDO_AB_BLOCK_SIZE); /* Invalid block size (block mode only). */
-                    return -1;
                 }
 
                 SDO->bufferOffset = 0U;
@@ -1283,7 +1840,7 @@ int8_t CO_SDO_process(
                 SDO->endOfTransfer = CO_false;
 
                 /* clear flag here */
-                SDO->CANrxNew = CO_false;
+                CO_FLAG_CLEAR(SDO->CANrxNew);
             }
 
             /* return, if all segments was allready transfered or on end of transfer */
@@ -1292,32 +1849,63 @@ int8_t CO_SDO_process(
             }
 
             /* reset timeout */
-            SDO->timeoutTimer = 0;
+            CO_timer_start(SDO->timers, &SDO->timeoutTimer, SDOtimeoutTime);
 
-            /* calculate length to be sent */
-            len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
-            if(len > 7U){
-                len = 7U;
-            }
+            /* send segments of the sub-block, until transmit buffer is full */
+            do{
+                CO_bool_t lastSegment;
 
-            /* fill response data bytes */
-            for(i=0U; i<len; i++){
-                SDO->CANtxBuff->data[i+1] = SDO->ODF_arg.data[SDO->bufferOffset++];
-            }
+                /* read segment directly from the stream object */
+                if(SDO->stream != NULL){
+                    uint32_t offset = SDO->streamOffset;
+                    uint32_t remaining = SDO->stream->size - offset;
 
-            /* first response byte */
-            SDO->CANtxBuff->data[0] = ++SDO->sequence;
+                    len = (remaining > SDO->segSize) ? SDO->segSize : (uint16_t)remaining;
+                    for(i=len; i<SDO->segSize; i++){
+                        SDO->CANtxBuff->data[i+1] = 0U;
+                    }
+                    abortCode = CO_SDO_streamCopy(SDO, &SDO->CANtxBuff->data[1], len, CO_false);
+                    if(abortCode != 0U){
+                        CO_SDO_abort(SDO, abortCode);
+                        return -1;
+                    }
 
-            /* verify end of transfer */
-            if((SDO->bufferOffset == SDO->ODF_arg.dataLength) && (SDO->ODF_arg.lastSegment)){
-                SDO->CANtxBuff->data[0] |= 0x80;
-                SDO->lastLen = len;
-                SDO->blksize = SDO->sequence;
-                SDO->endOfTransfer = CO_true;
-            }
+                    /* calculate CRC on bytes, which were not sent before */
+                    if(SDO->crcEnabled && (SDO->streamOffset > SDO->streamCrcOffset)){
+                        uint16_t sent = (uint16_t)(SDO->streamCrcOffset - offset);
+                        SDO->crc = crc16_ccitt(&SDO->CANtxBuff->data[1+sent], len-sent, SDO->crc);
+                        SDO->streamCrcOffset = SDO->streamOffset;
+                    }
+                    lastSegment = (SDO->streamOffset == SDO->stream->size) ? CO_true : CO_false;
+                }
+                else{
+                    /* calculate length to be sent */
+                    len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
+                    if(len > SDO->segSize){
+                        len = SDO->segSize;
+                    }
 
-            /* send response */
-            CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
+                    /* fill response data bytes, unused bytes of the last segment are zero */
+                    for(i=0U; i<SDO->segSize; i++){
+                        SDO->CANtxBuff->data[i+1] = (i < len) ? SDO->ODF_arg.data[SDO->bufferOffset++] : 0U;
+                    }
+                    lastSegment = ((SDO->bufferOffset == SDO->ODF_arg.dataLength) && (SDO->ODF_arg.lastSegment)) ? CO_true : CO_false;
+                }
+
+                /* first response byte */
+                SDO->CANtxBuff->data[0] = ++SDO->sequence;
+
+                /* verify end of transfer */
+                if(lastSegment){
+                    SDO->CANtxBuff->data[0] |= 0x80;
+                    SDO->lastLen = len;
+                    SDO->blksize = SDO->sequence;
+                    SDO->endOfTransfer = CO_true;
+                }
+
+                /* send response */
+                CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
+            }while((SDO->sequence < SDO->blksize) && (!SDO->endOfTransfer) && (!CO_FLAG_READ(SDO->CANtxBuff->bufferFull)));
 
             /* don't clear the SDO->CANrxNew flag, so return directly */
             return 1;
@@ -1330,6 +1918,14 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
+            if(SDO->stream != NULL){
+                abortCode = CO_SDO_streamFinish(SDO, CO_false);
+                if(abortCode != 0U){
+                    CO_SDO_abort(SDO, abortCode);
+                    return -1;
+                }
+            }
+
             SDO->state = CO_SDO_ST_IDLE;
             break;
         }
@@ -1341,7 +1937,7 @@ int8_t CO_SDO_process(
     }
 
     /* free buffer and send message */
-    SDO->CANrxNew = CO_false;
+    CO_FLAG_CLEAR(SDO->CANrxNew);
     if(sendResponse) {
         CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
     }
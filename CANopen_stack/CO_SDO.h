@@ -29,6 +29,33 @@
 #ifndef CO_SDO_H
 #define CO_SDO_H
 
+#include "CO_timer.h"
+
+
+/*
+ * Access to _CANrxNew_ flags of CANopen objects and to _bufferFull_ flags of
+ * CAN transmit buffers. Driver may define these macros and CO_FLAG_t type in
+ * CO_driver.h, if receive or transmit functions and processing functions run
+ * in different threads, see CO_FLAG_SET() in Linux driver. By default flag is
+ * accessed directly.
+ */
+#ifndef CO_FLAG_READ
+    typedef volatile CO_bool_t CO_FLAG_t;
+    #define CO_FLAG_READ(rxNew)     (rxNew)
+    #define CO_FLAG_SET(rxNew)      do{(rxNew) = CO_true;}while(0)
+    #define CO_FLAG_CLEAR(rxNew)    do{(rxNew) = CO_false;}while(0)
+#endif
+
+
+/*
+ * Maximum number of data bytes in CAN message. Driver with CAN FD support
+ * defines it in CO_driver.h (up to 64) and provides _DLC_ (number of data
+ * bytes) in CO_CANtx_t. By default messages are classic CAN.
+ */
+#ifndef CO_CAN_DATA_MAX
+    #define CO_CAN_DATA_MAX         8U
+#endif
+
 
 /**
  * @defgroup CO_SDO SDO server
@@ -49,6 +76,22 @@
  * used by the stack or by the application. This file (CO_SDO.h) implements
  * SDO server.
  *
+ * Device may have additional SDO server channels (index 0x1201 to 0x127F in
+ * Object dictionary), so more clients can access it at the same time. Each
+ * channel is own CO_SDO_t object with own state machine, buffer and timeout.
+ * Additional channels share Object dictionary and its extensions with the
+ * first channel, see _parentSDO_ in CO_SDO_init(). All channels must be
+ * processed from the same thread, so Object dictionary is accessed by one
+ * channel at a time. Object with @ref CO_SDO_OD_function or with stream
+ * object is transferred by one channel at a time. Other channels are aborted
+ * with CO_SDO_AB_DATA_DEV_STATE, until transfer of the object is finished.
+ *
+ * Client may access all sub-indexes of array or record at once (complete
+ * access, see CO_SDO_initTransferComplete()). Values of sub-indexes are
+ * packed one after another in a single expedited, segmented or block
+ * transfer, so bulk reading and writing of parameters needs one transfer
+ * instead of one per sub-index.
+ *
  * SDO client can be (optionally) implemented on one (or multiple, if multiple
  * SDO channels are used) device in CANopen network. Usually this is master
  * device and provides also some kind of user interface, so configuration of
@@ -77,7 +120,8 @@
  * or block transfer.
  *
  * ####Initiate SDO download (client request)
- *  - byte 0:       SDO command specifier. 8 bits: `0010nnes` (nn: if e=s=1,
+ *  - byte 0:       SDO command specifier. 8 bits: `001cnnes` (c=1 for complete
+ *                  access, subIndex must be 0 or 1; nn: if e=s=1,
  *                  number of data bytes, that do *not* contain data; e=1 for
  *                  expedited transfer; s=1 if data size is indicated).
  *  - byte 1..2:    Object index.
@@ -102,7 +146,8 @@
  *  - byte 1..7:    Reserved.
  *
  * ####Initiate SDO upload (client request)
- *  - byte 0:       SDO command specifier. 8 bits: `01000000`.
+ *  - byte 0:       SDO command specifier. 8 bits: `010c0000` (c=1 for complete
+ *                  access, subIndex must be 0 or 1).
  *  - byte 1..2:    Object index.
  *  - byte 3:       Object subIndex.
  *  - byte 4..7:    Reserved.
@@ -133,7 +178,9 @@
  *  - byte 4..7:    #CO_SDO_abortCode_t.
  *
  * ####Block transfer
- *     See DS301 V4.2.
+ *     See DS301 V4.2. Complete access is indicated by the same bit 4 in
+ *     command specifier of initiate block download and initiate block upload
+ *     requests. This is not part of CiA 301, bit is reserved there.
  */
 
 
@@ -288,6 +335,12 @@ typedef enum{
  *     data, which are longer than #CO_SDO_BUFFER_SIZE. In that case
  *     Object dictionary function is called multiple times between SDO transfer.
  *
+ * ####Stream object
+ *     Large object may be configured with CO_OD_configureStream() instead.
+ *     SDO server then copies data directly between CAN messages and memory
+ *     of the application, see CO_SDO_stream_t. Object dictionary function is
+ *     not called for such object.
+ *
  * ####Parameter to function:
  *     ODF_arg     - Pointer to CO_ODF_arg_t object filled before function call.
  *
@@ -306,7 +359,11 @@ typedef enum{
  * If data type is domain, data length is not limited to SDO buffer size. If
  * block transfer is implemented, value should be set to 889.
  *
- * Value can be in range from 7 to 889 bytes.
+ * Block download into stream object (see CO_SDO_stream_t) is staged in SDO
+ * buffer. Buffer is passed to the stream, when it can not hold another sub-block
+ * of 127 segments, so larger buffer gives fewer and larger writes.
+ *
+ * Value can be in range from 7 to 65535 bytes.
  */
     #ifndef CO_SDO_BUFFER_SIZE
         #define CO_SDO_BUFFER_SIZE    32
@@ -388,7 +445,9 @@ typedef enum{
     OD_H1A00_TXPDO_1_MAPPING      = 0x1A00U,/**< TXPDO mapping parameters */
     OD_H1A01_TXPDO_2_MAPPING      = 0x1A01U,/**< TXPDO mapping parameters */
     OD_H1A02_TXPDO_3_MAPPING      = 0x1A02U,/**< TXPDO mapping parameters */
-    OD_H1A03_TXPDO_4_MAPPING      = 0x1A03U /**< TXPDO mapping parameters */
+    OD_H1A03_TXPDO_4_MAPPING      = 0x1A03U,/**< TXPDO mapping parameters */
+    OD_H1FA0_MPDO_SCANNER_LIST    = 0x1FA0U,/**< Object scanner list of MPDO */
+    OD_H1FD0_MPDO_DISPATCHER_LIST = 0x1FD0U /**< Object dispatcher list of MPDO */
 }CO_ObjDicId_t;
 
 
@@ -537,6 +596,48 @@ typedef struct{
 }CO_ODF_arg_t;
 
 
+/**
+ * Stream object, see CO_OD_configureStream().
+ *
+ * Segmented and block transfers of the object copy data directly between CAN
+ * messages and memory of the application, without SDO buffer and without
+ * @ref CO_SDO_OD_function. Memory may be an array or mmap region (_data_), or
+ * it may be provided in windows by _pFunctWindow_, for example from a cache
+ * of a file. Only block download passes data through SDO buffer, because
+ * segments are stored by CAN receive function, see #CO_SDO_BUFFER_SIZE.
+ *
+ * Size of the object is limited only by 32-bit data size of SDO. Data are
+ * copied without disabling interrupts. Stream objects use 7-byte segments and
+ * expedited transfer, if object is not longer than four bytes. Data bytes are
+ * transferred as they are, they are not swapped on big endian processor.
+ */
+typedef struct{
+    /** Memory of the object or NULL, if _pFunctWindow_ is used */
+    uint8_t            *data;
+    /** Pointer to optional function, which provides memory of the object in
+    windows. It returns pointer to data at _offset_ or NULL, if data are not
+    accessible (transfer is then aborted with CO_SDO_AB_HW). On entry
+    _length_ is number of bytes needed, function may lower it to number of
+    bytes available at returned pointer, at least 1. Request of offset 0
+    starts new transfer. */
+    uint8_t          *(*pFunctWindow)(void *object, uint32_t offset, uint32_t *length, CO_bool_t writing);
+    /** Pointer to optional function, called after the last data of the
+    transfer were copied. After download _size_ is already updated. Return
+    value different than 0 aborts the SDO transfer. */
+    CO_SDO_abortCode_t (*pFunctFinished)(void *object, CO_bool_t writing);
+    /** Object passed to above functions */
+    void               *object;
+    /** Size of the data in bytes. Upload transfers _size_ bytes, successful
+    download sets it to the number of received bytes. */
+    uint32_t            size;
+    /** Maximum size of downloaded data. Longer download is aborted with
+    CO_SDO_AB_DATA_LONG. Aborted download leaves data partially written. */
+    uint32_t            capacity;
+    /** Streamed sub-index of the object, from CO_OD_configureStream() */
+    uint8_t             subIndex;
+}CO_SDO_stream_t;
+
+
 /**
  * Object is used as array inside CO_SDO_t, parallel to @ref CO_SDO_objectDictionary.
  *
@@ -551,15 +652,57 @@ typedef struct{
     /** Pointer to #CO_SDO_OD_flags_t. If object type is array or record, this
     variable points to array with length equal to number of subindexes. */
     uint8_t            *flags;
+    /** Pointer to stream object or NULL, see CO_OD_configureStream() */
+    CO_SDO_stream_t    *stream;
+    /** SDO server, which transfers the object last. Other SDO servers can not
+    access the object, while transfer is in progress. */
+    struct CO_SDO      *owner;
 }CO_OD_extension_t;
 
 
 /**
- * SDO server object.
+ * Memory image of Object dictionary variables.
+ *
+ * Entries of @ref CO_SDO_objectDictionary point into default images
+ * (CO_OD_RAM, CO_OD_EEPROM and CO_OD_ROM). If more CANopen devices share the
+ * same Object dictionary, each device has own copy of the images and pointers
+ * are translated by CO_OD_getInstancePointer().
  */
 typedef struct{
-    /** 8 data bytes of the received message. */
-    uint8_t             CANrxData[8];   /* Take care for correct (word) alignment! */
+    /** Default image, into which @ref CO_SDO_objectDictionary points */
+    const void         *defaultImage;
+    /** Image of this CANopen device, copy of the default image */
+    void               *image;
+    /** Size of the image in bytes */
+    uint32_t            size;
+}CO_ODimage_t;
+
+
+/**
+ * Direct index into @ref CO_SDO_objectDictionary.
+ *
+ * It is generated by Object dictionary editor as CO_OD_index, together with
+ * CO_OD_INDEX_PAGES in CO_OD.h. Object with _index_ is found by CO_OD_find()
+ * at sequence number entryNo[page[index>>8]][index&0xFF] in constant time.
+ */
+typedef struct{
+    /** For each high byte of index number of the page in _entryNo_ or 0xFF,
+    if there is no object */
+    const uint8_t      *page;
+    /** Pages of sequence numbers for each low byte of index, 0xFFFF if there
+    is no object */
+    const uint16_t    (*entryNo)[256];
+}CO_ODindex_t;
+
+
+/**
+ * SDO server object.
+ */
+typedef struct CO_SDO{
+    /** Data bytes of the received message. */
+    uint8_t             CANrxData[CO_CAN_DATA_MAX]; /* Take care for correct (word) alignment! */
+    /** Number of data bytes of the received message */
+    uint8_t             CANrxDLC;
     /** SDO data buffer of size #CO_SDO_BUFFER_SIZE. */
     uint8_t             databuffer[CO_SDO_BUFFER_SIZE]; /* Take care for correct (word) alignment! */
     /** Internal flag indicates, that this object has own OD */
@@ -571,10 +714,30 @@ typedef struct{
     /** Pointer to array of CO_OD_extension_t objects. Size of the array is
     equal to ODSize. */
     CO_OD_extension_t  *ODExtensions;
+    /** Pointer to array of CO_ODimage_t objects or NULL, if default images are
+    used. Set after CO_SDO_init() by owner of the images. */
+    const CO_ODimage_t *ODimages;
+    /** Size of the _ODimages_ array */
+    uint8_t             ODimagesCount;
+    /** Pointer to CO_ODindex_t object or NULL, if CO_OD_find() uses binary
+    search. Set after CO_SDO_init() by owner of the OD. */
+    const CO_ODindex_t *ODindex;
     /** Offset in buffer of next data segment being read/written */
     uint16_t            bufferOffset;
+    /** Stream object of current transfer or NULL, see CO_SDO_stream_t */
+    CO_SDO_stream_t    *stream;
+    /** Offset in stream object of next data being read/written */
+    uint32_t            streamOffset;
+    /** Offset in stream object of the first segment of current sub-block in
+    block upload */
+    uint32_t            streamBlockStart;
+    /** Offset in stream object, up to which CRC is calculated in block upload */
+    uint32_t            streamCrcOffset;
     /** Sequence number of OD entry as returned from CO_OD_find() */
     uint16_t            entryNo;
+    /** True, if all sub-indexes of the object are transferred, see
+    CO_SDO_initTransferComplete() */
+    CO_bool_t           completeAccess;
     /** CO_ODF_arg_t object with additional variables. Reference to this object
     is passed to @ref CO_SDO_OD_function */
     CO_ODF_arg_t        ODF_arg;
@@ -584,10 +747,15 @@ typedef struct{
     CO_SDO_state_t      state;
     /** Toggle bit in segmented transfer or block sequence in block transfer */
     uint8_t             sequence;
-    /** Timeout timer for SDO communication */
-    uint16_t            timeoutTimer;
+    /** Timeout timer for SDO communication, started on each received message */
+    CO_timer_t          timeoutTimer;
+    /** From CO_SDO_init() */
+    CO_timerWheel_t    *timers;
     /** Number of segments per block with 1 <= blksize <= 127 */
     uint8_t             blksize;
+    /** Number of data bytes in segmented or block transfer segment: 7, or
+    CO_CAN_DATA_MAX-1 if client uses CAN FD frames, see CO_SDO_process(). */
+    uint8_t             segSize;
     /** True, if CRC calculation by block transfer is enabled */
     CO_bool_t           crcEnabled;
     /** Calculated CRC code */
@@ -597,15 +765,31 @@ typedef struct{
     /** Indication end of block transfer */
     CO_bool_t           endOfTransfer;
     /** Variable indicates, if new SDO message received from CAN bus */
-    CO_bool_t           CANrxNew;
+    CO_FLAG_t           CANrxNew;
+    /** Set by receive function on each segment of block download, which
+    doesn't set CANrxNew. CO_SDO_process() restarts timeoutTimer then. */
+    CO_FLAG_t           CANrxActivity;
     /** Pointer to optional external function. If defined, it is called from high
-    priority interrupt after new CAN SDO response message is received. Function
-    may wake up external task, which processes SDO client functions */
+    priority interrupt after new CAN SDO request message is received. Function
+    may wake up external task, which processes SDO server with
+    CO_process_SDO(). Set by application after CO_SDO_init(). */
     void              (*pFunctSignal)(uint32_t arg);
     /** Optional argument, which is passed to above function */
     uint32_t            functArg;
+    /** Pointer to optional external function. If defined, it is called after
+    SDO download has written data into the Object Dictionary variable. Used
+    by CO_TPDOnotify_init() for change driven TPDO processing. */
+    void              (*pFunctWritten)(void *object, uint16_t entryNo, uint8_t subIndex);
+    /** Object, which is passed to above function */
+    void               *functWrittenObject;
+    /** From CO_SDO_init() */
+    CO_CANmodule_t     *CANdevRx;
+    /** From CO_SDO_init() */
+    uint16_t            CANdevRxIdx;
     /** From CO_SDO_init() */
     CO_CANmodule_t     *CANdevTx;
+    /** From CO_SDO_init() */
+    uint16_t            CANdevTxIdx;
     /** CAN transmit buffer inside CANdev for CAN tx message */
     CO_CANtx_t         *CANtxBuff;
 }CO_SDO_t;
@@ -695,9 +879,13 @@ void CO_memcpySwap4(uint8_t dest[], const uint8_t src[]);
  * Function must be called in the communication reset section.
  *
  * @param SDO This object will be initialized.
- * @param COB_IDClientToServer 0x600 + nodeId by default.
- * @param COB_IDServerToClient 0x580 + nodeId by default.
- * @param ObjDictIndex_SDOServerParameter Index in Object dictionary.
+ * @param COB_IDClientToServer 0x600 + nodeId by default. For additional SDO
+ * server channel value from Object dictionary, channel is not used, if bit 31
+ * is set.
+ * @param COB_IDServerToClient 0x580 + nodeId by default. Same as above.
+ * @param ObjDictIndex_SDOServerParameter Index in Object dictionary, 0x1200 for
+ * first SDO server channel, 0x1201 to 0x127F for additional channels. COB-IDs
+ * of additional channels may be changed by writing to the Object dictionary.
  * @param parentSDO Pointer to SDO object, which contains object dictionary and
  * its extension. For first (default) SDO object this argument must be NULL.
  * If this argument is specified, then OD, ODSize and ODExtensions arguments
@@ -706,7 +894,9 @@ void CO_memcpySwap4(uint8_t dest[], const uint8_t src[]);
  * @param ODSize Size of the above array.
  * @param ODExtensions Pointer to the externally defined array of the same size
  * as ODSize.
- * @param nodeId CANopen Node ID of this device. Value will be added to COB_IDs.
+ * @param timers Timer wheel processed by CO_process().
+ * @param nodeId CANopen Node ID of this device. Value is added to COB_IDs,
+ * when index 0x1200 is read from Object dictionary.
  * @param CANdevRx CAN device for SDO server reception.
  * @param CANdevRxIdx Index of receive buffer in the above CAN device.
  * @param CANdevTx CAN device for SDO server transmission.
@@ -716,13 +906,14 @@ void CO_memcpySwap4(uint8_t dest[], const uint8_t src[]);
  */
 int16_t CO_SDO_init(
         CO_SDO_t               *SDO,
-        uint16_t                COB_IDClientToServer,
-        uint16_t                COB_IDServerToClient,
+        uint32_t                COB_IDClientToServer,
+        uint32_t                COB_IDServerToClient,
         uint16_t                ObjDictIndex_SDOServerParameter,
         CO_SDO_t               *parentSDO,
         const CO_OD_entry_t     OD[],
         uint16_t                ODSize,
         CO_OD_extension_t       ODExtensions[],
+        CO_timerWheel_t        *timers,
         uint8_t                 nodeId,
         CO_CANmodule_t         *CANdevRx,
         uint16_t                CANdevRxIdx,
@@ -735,10 +926,23 @@ int16_t CO_SDO_init(
  *
  * Function must be called cyclically.
  *
+ * If CO_CAN_DATA_MAX is larger than 8 and client sends initiate request in
+ * CAN FD frame, segmented and block transfer of objects, which are not domain,
+ * use segments with CO_CAN_DATA_MAX-1 data bytes and responses are sent with
+ * CO_CAN_DATA_MAX bytes. As unused bytes of such segments can not be encoded
+ * in command byte, length of the last segment is derived from object length.
+ * This is not part of CiA 301, domain objects and classic clients use 7-byte
+ * segments.
+ *
+ * In block upload, function sends segments of the sub-block in one call, until
+ * the sub-block is complete or CO_CANtx_t::bufferFull is set by the driver.
+ * Transfer is so paced by free space in the transmit path. Function should be
+ * called again soon after messages are transmitted, while SDO server is in
+ * CO_SDO_ST_UPLOAD_BL_SUBBLOCK state.
+ *
  * @param SDO This object.
  * @param NMTisPreOrOperational Different than zero, if #CO_NMT_internalState_t is
  * NMT_PRE_OPERATIONAL or NMT_OPERATIONAL.
- * @param timeDifference_ms Time difference from previous function call in [milliseconds].
  * @param SDOtimeoutTime Timeout time for SDO communication in milliseconds.
  *
  * @return 0: SDO server is idle.
@@ -748,10 +952,29 @@ int16_t CO_SDO_init(
 int8_t CO_SDO_process(
         CO_SDO_t               *SDO,
         CO_bool_t               NMTisPreOrOperational,
-        uint16_t                timeDifference_ms,
         uint16_t                SDOtimeoutTime);
 
 
+/**
+ * Configure stream access to one @ref CO_SDO_objectDictionary entry.
+ *
+ * SDO transfers of the _subIndex_ then use _stream_, see CO_SDO_stream_t.
+ * Object should be of domain type. Attributes from Object dictionary still
+ * decide, if object is readable and writeable. If OD entry does not exist,
+ * function returns silently.
+ *
+ * @param SDO This object.
+ * @param index Index of object in the Object dictionary.
+ * @param subIndex Subindex of object in the Object dictionary.
+ * @param stream Stream object, configured by application, or NULL to remove it.
+ */
+void CO_OD_configureStream(
+        CO_SDO_t               *SDO,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        CO_SDO_stream_t        *stream);
+
+
 /**
  * Configure additional functionality to one @ref CO_SDO_objectDictionary entry.
  *
@@ -782,6 +1005,9 @@ void CO_OD_configure(
 /**
  * Find object with specific index in Object dictionary.
  *
+ * If _ODindex_ is set, lookup is a direct table access, otherwise binary search
+ * in ordered Object dictionary.
+ *
  * @param SDO This object.
  * @param index Index of the object in Object dictionary.
  *
@@ -832,6 +1058,23 @@ uint16_t CO_OD_getAttribute(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex);
 void* CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex);
 
 
+/**
+ * Translate pointer into default Object dictionary image to pointer into
+ * image of this CANopen device.
+ *
+ * If _SDO->ODimages_ is not set or pointer is not inside any default image,
+ * it is returned unchanged. CO_OD_getDataPointer() uses this function, so
+ * it returns data of this CANopen device.
+ *
+ * @param SDO This object.
+ * @param pData Pointer to variable inside default image, for example
+ * &OD_errorRegister.
+ *
+ * @return Pointer to the same variable inside image of this CANopen device.
+ */
+void* CO_OD_getInstancePointer(CO_SDO_t *SDO, const void *pData);
+
+
 /**
  * Get pointer to the #CO_SDO_OD_flags_t byte of the given object with
  * specific subIndex.
@@ -859,10 +1102,30 @@ uint8_t* CO_OD_getFlagsPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex
 uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex);
 
 
+/**
+ * Initialize SDO transfer with complete access.
+ *
+ * Transfer includes sub-indexes from _subIndex_ to the last one. Their values
+ * are packed one after another, each with its length from Object dictionary.
+ * CO_SDO_readOD() and CO_SDO_writeOD() then access each sub-index separately
+ * and call @ref CO_SDO_OD_function for each of them. Object must not contain
+ * domain or stream object and all values must fit into SDO buffer. In
+ * download, sub-index 0 is skipped, if it is not writeable.
+ *
+ * @param SDO This object.
+ * @param index Index of the object in Object dictionary.
+ * @param subIndex 0 or 1.
+ *
+ * @return 0 on success, otherwise #CO_SDO_abortCode_t.
+ */
+uint32_t CO_SDO_initTransferComplete(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex);
+
+
 /**
  * Read data from @ref CO_SDO_objectDictionary to internal buffer.
  *
- * ODF_arg s must be initialized before with CO_SDO_initTransfer().
+ * ODF_arg s must be initialized before with CO_SDO_initTransfer() or
+ * CO_SDO_initTransferComplete().
  * @ref CO_SDO_OD_function is called if configured.
  *
  * @param SDO This object.
@@ -876,7 +1139,8 @@ uint32_t CO_SDO_readOD(CO_SDO_t *SDO, uint16_t SDOBufferSize);
 /**
  * Write data from internal buffer to @ref CO_SDO_objectDictionary.
  *
- * ODF_arg s must be initialized before with CO_SDO_initTransfer().
+ * ODF_arg s must be initialized before with CO_SDO_initTransfer() or
+ * CO_SDO_initTransferComplete().
  * @ref CO_SDO_OD_function is called if configured.
  *
  * @param SDO This object.
@@ -103,7 +103,7 @@ static void CO_SDOclient_receive(void *object, const CO_CANrxMsg_t *msg){
     SDO_C = (CO_SDOclient_t*)object;    /* this is the correct pointer type of the first argument */
 
     /* verify message length and message overflow (previous message was not processed yet) */
-    if((msg->DLC == 8U) && (!SDO_C->CANrxNew) && (SDO_C->state != SDO_STATE_NOTDEFINED)){
+    if((msg->DLC == 8U) && (!CO_FLAG_READ(SDO_C->CANrxNew)) && (SDO_C->state != SDO_STATE_NOTDEFINED)){
         if(SDO_C->state != SDO_STATE_BLOCKUPLOAD_INPROGRES) {
             /* copy data and set 'new message' flag */
             SDO_C->CANrxData[0] = msg->data[0];
@@ -115,7 +115,7 @@ static void CO_SDOclient_receive(void *object, const CO_CANrxMsg_t *msg){
             SDO_C->CANrxData[6] = msg->data[6];
             SDO_C->CANrxData[7] = msg->data[7];
 
-            SDO_C->CANrxNew = 1;
+            CO_FLAG_SET(SDO_C->CANrxNew);
         }
         else {
             /* block upload, copy data directly */
@@ -139,7 +139,7 @@ static void CO_SDOclient_receive(void *object, const CO_CANrxMsg_t *msg){
                     if(SDO_C->dataSizeTransfered >= SDO_C->bufferSize) {
                         /* buffer full, break reception */
                         SDO_C->state = SDO_STATE_BLOCKUPLOAD_SUB_END;
-                        SDO_C->CANrxNew = 1;
+                        CO_FLAG_SET(SDO_C->CANrxNew);
                         break;
                     }
                 }
@@ -147,7 +147,7 @@ static void CO_SDOclient_receive(void *object, const CO_CANrxMsg_t *msg){
                 /* break reception if last segment or block sequence is too large */
                 if(((SDO_C->CANrxData[0] & 0x80U) == 0x80U) || (SDO_C->block_seqno >= SDO_C->block_blksize)) {
                     SDO_C->state = SDO_STATE_BLOCKUPLOAD_SUB_END;
-                    SDO_C->CANrxNew = 1;
+                    CO_FLAG_SET(SDO_C->CANrxNew);
                 }
             }
             else if((seqno == SDO_C->block_seqno) || (SDO_C->block_seqno == 0U)){
@@ -156,12 +156,12 @@ static void CO_SDOclient_receive(void *object, const CO_CANrxMsg_t *msg){
             else {
                 /* seqno is totally wrong, break reception. */
                 SDO_C->state = SDO_STATE_BLOCKUPLOAD_SUB_END;
-                SDO_C->CANrxNew = 1;
+                CO_FLAG_SET(SDO_C->CANrxNew);
             }
         }
 
         /* Optional signal to RTOS, which can resume task, which handles SDO client. */
-        if(SDO_C->CANrxNew && SDO_C->pFunctSignal) {
+        if(CO_FLAG_READ(SDO_C->CANrxNew) && SDO_C->pFunctSignal) {
             SDO_C->pFunctSignal(SDO_C->functArg);
         }
     }
@@ -184,7 +184,7 @@ int16_t CO_SDOclient_init(
 
     /* Configure object variables */
     SDO_C->state = SDO_STATE_NOTDEFINED;
-    SDO_C->CANrxNew = 0;
+    CO_FLAG_CLEAR(SDO_C->CANrxNew);
 
     SDO_C->pst    = 21; /*  block transfer */
     SDO_C->block_size_max = 127; /*  block transfer */
@@ -219,7 +219,7 @@ CO_SDOclient_return_t CO_SDOclient_setup(
 
     /* Configure object variables */
     SDO_C->state = SDO_STATE_NOTDEFINED;
-    SDO_C->CANrxNew = 0;
+    CO_FLAG_CLEAR(SDO_C->CANrxNew);
 
     /* setup Object Dictionary variables */
     if((COB_IDClientToServer & 0x80000000L) || (COB_IDServerToClient & 0x80000000L) || nodeIDOfTheSDOServer == 0){
@@ -272,7 +272,7 @@ static void CO_SDOclient_abort(CO_SDOclient_t *SDO_C, uint32_t code){
     CO_memcpySwap4(&SDO_C->CANtxBuff->data[4], (uint8_t*)&code);
     CO_CANsend(SDO_C->CANdevTx, SDO_C->CANtxBuff);
     SDO_C->state = SDO_STATE_NOTDEFINED;
-    SDO_C->CANrxNew = 0;
+    CO_FLAG_CLEAR(SDO_C->CANrxNew);
 }
 
 
@@ -283,7 +283,7 @@ static void CO_SDOTxBufferClear(CO_SDOclient_t *SDO_C) {
     for(i=0; i<8; i++) {
         SDO_C->CANtxBuff->data[i] = 0;
     }
-    SDO_C->CANtxBuff->bufferFull = 0;
+    CO_FLAG_CLEAR(SDO_C->CANtxBuff->bufferFull);
 }
 
 
@@ -299,7 +299,8 @@ CO_SDOclient_return_t CO_SDOclientDownloadInitiate(
         uint8_t                 subIndex,
         uint8_t                *dataTx,
         uint32_t                dataSize,
-        uint8_t                 blockEnable)
+        uint8_t                 blockEnable,
+        uint8_t                 completeAccess)
 {
     /* verify parameters */
     if(dataTx == 0 || dataSize == 0) return CO_SDOcli_wrongArguments;
@@ -315,6 +316,7 @@ CO_SDOclient_return_t CO_SDOclientDownloadInitiate(
 
     SDO_C->index = index;
     SDO_C->subIndex = subIndex;
+    SDO_C->completeAccess = completeAccess;
     SDO_C->CANtxBuff->data[1] = index & 0xFF;
     SDO_C->CANtxBuff->data[2] = index >> 8;
     SDO_C->CANtxBuff->data[3] = subIndex;
@@ -358,8 +360,13 @@ CO_SDOclient_return_t CO_SDOclientDownloadInitiate(
         CO_memcpySwap4(&SDO_C->CANtxBuff->data[4], (uint8_t*)&len);
     }
 
+    /* complete access flag */
+    if(completeAccess != 0){
+        SDO_C->CANtxBuff->data[0] |= 0x10;
+    }
+
     /* empty receive buffer, reset timeout timer and send message */
-    SDO_C->CANrxNew = 0;
+    CO_FLAG_CLEAR(SDO_C->CANrxNew);
     SDO_C->timeoutTimer = 0;
     CO_CANsend(SDO_C->CANdevTx, SDO_C->CANtxBuff);
 
@@ -382,7 +389,7 @@ CO_SDOclient_return_t CO_SDOclientDownload(
     /* if nodeIDOfTheSDOServer == node-ID of this node, then exchange data with this node */
     if(SDO_C->SDO && SDO_C->SDOClientPar->nodeIDOfTheSDOServer == SDO_C->SDO->nodeId){
         SDO_C->state = SDO_STATE_NOTDEFINED;
-        SDO_C->CANrxNew = 0;
+        CO_FLAG_CLEAR(SDO_C->CANrxNew);
 
         /* If SDO server is busy return error */
         if(SDO_C->SDO->state != 0){
@@ -390,7 +397,12 @@ CO_SDOclient_return_t CO_SDOclientDownload(
         }
 
         /* init ODF_arg */
-        *pSDOabortCode = CO_SDO_initTransfer(SDO_C->SDO, SDO_C->index, SDO_C->subIndex);
+        if(SDO_C->completeAccess != 0){
+            *pSDOabortCode = CO_SDO_initTransferComplete(SDO_C->SDO, SDO_C->index, SDO_C->subIndex);
+        }
+        else{
+            *pSDOabortCode = CO_SDO_initTransfer(SDO_C->SDO, SDO_C->index, SDO_C->subIndex);
+        }
         if((*pSDOabortCode) != CO_SDO_AB_NONE){
             return CO_SDOcli_endedWithServerAbort;
         }
@@ -409,14 +421,14 @@ CO_SDOclient_return_t CO_SDOclientDownload(
 
 
 /*  RX data ****************************************************************************************** */
-    if(SDO_C->CANrxNew){
+    if(CO_FLAG_READ(SDO_C->CANrxNew)){
         uint8_t SCS = SDO_C->CANrxData[0]>>5;    /* Client command specifier */
 
         /* ABORT */
         if (SDO_C->CANrxData[0] == (SCS_ABORT<<5)){
             SDO_C->state = SDO_STATE_NOTDEFINED;
             CO_memcpySwap4((uint8_t*)pSDOabortCode , &SDO_C->CANrxData[4]);
-            SDO_C->CANrxNew = 0;
+            CO_FLAG_CLEAR(SDO_C->CANrxNew);
             return CO_SDOcli_endedWithServerAbort;
         }
 
@@ -428,7 +440,7 @@ CO_SDOclient_return_t CO_SDOclientDownload(
                     if(SDO_C->bufferSize <= 4){
                         /* expedited transfer */
                         SDO_C->state = SDO_STATE_NOTDEFINED;
-                        SDO_C->CANrxNew = 0;
+                        CO_FLAG_CLEAR(SDO_C->CANrxNew);
                         return CO_SDOcli_ok_communicationEnd;
                     }
                     else{
@@ -463,7 +475,7 @@ CO_SDOclient_return_t CO_SDOclientDownload(
                     /* is end of transfer? */
                     if(SDO_C->bufferOffset == SDO_C->bufferSize){
                         SDO_C->state = SDO_STATE_NOTDEFINED;
-                        SDO_C->CANrxNew = 0;
+                        CO_FLAG_CLEAR(SDO_C->CANrxNew);
                         return CO_SDOcli_ok_communicationEnd;
                     }
                     SDO_C->state = SDO_STATE_DOWNLOAD_REQUEST;
@@ -550,7 +562,7 @@ CO_SDOclient_return_t CO_SDOclientDownload(
                     /*  SDO block download successfully transferred */
                     SDO_C->state = SDO_STATE_NOTDEFINED;
                     SDO_C->timeoutTimer = 0;
-                    SDO_C->CANrxNew = 0;
+                    CO_FLAG_CLEAR(SDO_C->CANrxNew);
                     return CO_SDOcli_ok_communicationEnd;
                 }
                 else{
@@ -566,7 +578,7 @@ CO_SDOclient_return_t CO_SDOclientDownload(
             }
         }
         SDO_C->timeoutTimer = 0;
-        SDO_C->CANrxNew = 0;
+        CO_FLAG_CLEAR(SDO_C->CANrxNew);
     }
 
 /*  TMO *********************************************************************************************** */
@@ -580,7 +592,7 @@ CO_SDOclient_return_t CO_SDOclientDownload(
     }
 
 /*  TX data ******************************************************************************************* */
-    if(SDO_C->CANtxBuff->bufferFull) {
+    if(CO_FLAG_READ(SDO_C->CANtxBuff->bufferFull)) {
         return CO_SDOcli_transmittBufferFull;
     }
 
@@ -699,7 +711,8 @@ CO_SDOclient_return_t CO_SDOclientUploadInitiate(
         uint8_t                 subIndex,
         uint8_t                *dataRx,
         uint32_t                dataRxSize,
-        uint8_t                 blockEnable)
+        uint8_t                 blockEnable,
+        uint8_t                 completeAccess)
 {
     /* verify parameters */
     if(dataRx == 0 || dataRxSize < 4) {
@@ -715,6 +728,7 @@ CO_SDOclient_return_t CO_SDOclientUploadInitiate(
 
     SDO_C->index = index;
     SDO_C->subIndex = subIndex;
+    SDO_C->completeAccess = completeAccess;
 
     SDO_C->CANtxBuff->data[1] = index & 0xFF;
     SDO_C->CANtxBuff->data[2] = index >> 8;
@@ -747,13 +761,18 @@ CO_SDOclient_return_t CO_SDOclientUploadInitiate(
         SDO_C->block_seqno = 0;
     }
 
+    /* complete access flag */
+    if(completeAccess != 0){
+        SDO_C->CANtxBuff->data[0] |= 0x10;
+    }
+
     /* if nodeIDOfTheSDOServer == node-ID of this node, then exchange data with this node */
     if(SDO_C->SDOClientPar->nodeIDOfTheSDOServer == SDO_C->SDO->nodeId){
         return CO_SDOcli_ok_communicationEnd;
     }
 
     /* empty receive buffer, reset timeout timer and send message */
-    SDO_C->CANrxNew = 0;
+    CO_FLAG_CLEAR(SDO_C->CANrxNew);
     SDO_C->timeoutTimer = 0;
     SDO_C->timeoutTimerBLOCK =0;
     CO_CANsend(SDO_C->CANdevTx, SDO_C->CANtxBuff);
@@ -780,7 +799,7 @@ CO_SDOclient_return_t CO_SDOclientUpload(
     /* if nodeIDOfTheSDOServer == node-ID of this node, then exchange data with this node */
     if(SDO_C->SDO && SDO_C->SDOClientPar->nodeIDOfTheSDOServer == SDO_C->SDO->nodeId){
         SDO_C->state = SDO_STATE_NOTDEFINED;
-        SDO_C->CANrxNew = 0;
+        CO_FLAG_CLEAR(SDO_C->CANrxNew);
 
         /* If SDO server is busy return error */
         if(SDO_C->SDO->state != 0){
@@ -789,7 +808,12 @@ CO_SDOclient_return_t CO_SDOclientUpload(
         }
 
         /* init ODF_arg */
-        *pSDOabortCode = CO_SDO_initTransfer(SDO_C->SDO, SDO_C->index, SDO_C->subIndex);
+        if(SDO_C->completeAccess != 0){
+            *pSDOabortCode = CO_SDO_initTransferComplete(SDO_C->SDO, SDO_C->index, SDO_C->subIndex);
+        }
+        else{
+            *pSDOabortCode = CO_SDO_initTransfer(SDO_C->SDO, SDO_C->index, SDO_C->subIndex);
+        }
         if((*pSDOabortCode) != CO_SDO_AB_NONE){
             return CO_SDOcli_endedWithServerAbort;
         }
@@ -819,13 +843,13 @@ CO_SDOclient_return_t CO_SDOclientUpload(
 
 
 /*  RX data ******************************************************************************** */
-    if(SDO_C->CANrxNew){
+    if(CO_FLAG_READ(SDO_C->CANrxNew)){
         uint8_t SCS = SDO_C->CANrxData[0]>>5;    /* Client command specifier */
 
         /*  ABORT */
         if (SDO_C->CANrxData[0] == (SCS_ABORT<<5)){
             SDO_C->state = SDO_STATE_NOTDEFINED;
-            SDO_C->CANrxNew =0;
+            CO_FLAG_CLEAR(SDO_C->CANrxNew);
             CO_memcpySwap4((uint8_t*)pSDOabortCode , &SDO_C->CANrxData[4]);
             return CO_SDOcli_endedWithServerAbort;
         }
@@ -848,7 +872,7 @@ CO_SDOclient_return_t CO_SDOclientUpload(
                         /* copy data */
                         while(size--) SDO_C->buffer[size] = SDO_C->CANrxData[4+size];
                         SDO_C->state = SDO_STATE_NOTDEFINED;
-                        SDO_C->CANrxNew = 0;
+                        CO_FLAG_CLEAR(SDO_C->CANrxNew);
 
                         return CO_SDOcli_ok_communicationEnd;
                     }
@@ -893,7 +917,7 @@ CO_SDOclient_return_t CO_SDOclientUpload(
                     if(SDO_C->CANrxData[0] & 0x01){
                         *pDataSize = SDO_C->bufferOffset;
                         SDO_C->state = SDO_STATE_NOTDEFINED;
-                        SDO_C->CANrxNew = 0;
+                        CO_FLAG_CLEAR(SDO_C->CANrxNew);
                         return CO_SDOcli_ok_communicationEnd;
                     }
                     /* set state */
@@ -960,7 +984,7 @@ CO_SDOclient_return_t CO_SDOclientUpload(
                         /* copy data */
                         while(size--) SDO_C->buffer[size] = SDO_C->CANrxData[4+size];
                         SDO_C->state = SDO_STATE_NOTDEFINED;
-                        SDO_C->CANrxNew = 0;
+                        CO_FLAG_CLEAR(SDO_C->CANrxNew);
 
                         return CO_SDOcli_ok_communicationEnd;
                     }
@@ -1047,7 +1071,7 @@ CO_SDOclient_return_t CO_SDOclientUpload(
             }
         }
         SDO_C->timeoutTimer = 0;
-        SDO_C->CANrxNew = 0;
+        CO_FLAG_CLEAR(SDO_C->CANrxNew);
     }
 
 /*  TMO *************************************************************************************************** */
@@ -1067,7 +1091,7 @@ CO_SDOclient_return_t CO_SDOclientUpload(
 
 
 /*  TX data ******************************************************************************** */
-    if(SDO_C->CANtxBuff->bufferFull) {
+    if(CO_FLAG_READ(SDO_C->CANtxBuff->bufferFull)) {
         return CO_SDOcli_transmittBufferFull;
     }
 
@@ -119,13 +119,16 @@ typedef struct{
     uint16_t            index;
     /** Subindex of current object in Object Dictionary */
     uint8_t             subIndex;
+    /** Complete access to all sub-indexes of current object, see
+    CO_SDO_initTransferComplete() */
+    uint8_t             completeAccess;
     /** From CO_SDOclient_init() */
     CO_CANmodule_t     *CANdevRx;
     /** From CO_SDOclient_init() */
     uint16_t            CANdevRxIdx;
     /** Flag indicates, if new SDO message received from CAN bus.
     It is not cleared, until received message is completely processed. */
-    uint16_t            CANrxNew;      /* must be 2-byte variable because of correct alignment of CANrxData */
+    CO_FLAG_t           CANrxNew;
     /** 8 data bytes of the received message */
     uint8_t             CANrxData[8];  /* take care for correct (word) alignment! */
     /** Pointer to optional external function. If defined, it is called from high
@@ -227,6 +230,8 @@ CO_SDOclient_return_t CO_SDOclient_setup(
  * when using processors with big-endian.
  * @param dataSize Size of data in dataTx.
  * @param blockEnable Try to initiate block transfer.
+ * @param completeAccess Write all sub-indexes from _subIndex_ (0 or 1) on,
+ * packed in dataTx, see CO_SDO_initTransferComplete().
  *
  * @return #CO_SDOclient_return_t
  */
@@ -236,7 +241,8 @@ CO_SDOclient_return_t CO_SDOclientDownloadInitiate(
         uint8_t                 subIndex,
         uint8_t                *dataTx,
         uint32_t                dataSize,
-        uint8_t                 blockEnable);
+        uint8_t                 blockEnable,
+        uint8_t                 completeAccess);
 
 
 /**
@@ -277,6 +283,8 @@ CO_SDOclient_return_t CO_SDOclientDownload(
  * little-endian. Take care, when using processors with big-endian.
  * @param dataRxSize Size of dataRx.
  * @param blockEnable Try to initiate block transfer.
+ * @param completeAccess Read all sub-indexes from _subIndex_ (0 or 1) on,
+ * packed in dataRx, see CO_SDO_initTransferComplete().
  *
  * @return #CO_SDOclient_return_t
  */
@@ -286,7 +294,8 @@ CO_SDOclient_return_t CO_SDOclientUploadInitiate(
         uint8_t                 subIndex,
         uint8_t                *dataRx,
         uint32_t                dataRxSize,
-        uint8_t                 blockEnable);
+        uint8_t                 blockEnable,
+        uint8_t                 completeAccess);
 
 
 /**
@@ -70,6 +70,10 @@ static void CO_SYNC_receive(void *object, const CO_CANrxMsg_t *msg){
                 SYNC->running = CO_true;
             }
             SYNC->timer = 0;
+            SYNC->CANrxToggle = SYNC->CANrxToggle ? CO_false : CO_true;
+#ifdef CO_CAN_RX_TIMESTAMP
+            SYNC->timestamp = CO_CANrxMsg_readTimestamp(msg);
+#endif
         }
     }
 }
@@ -252,9 +256,13 @@ int16_t CO_SYNC_init(
     SYNC->curentSyncTimeIsInsideWindow = CO_true;
 
     SYNC->running = CO_false;
+    SYNC->CANrxToggle = CO_false;
     SYNC->timer = 0;
     SYNC->counter = 0;
     SYNC->receiveError = 0U;
+#ifdef CO_CAN_RX_TIMESTAMP
+    SYNC->timestamp = 0U;
+#endif
 
     SYNC->em = em;
     SYNC->operatingState = operatingState;
@@ -317,8 +325,12 @@ uint8_t CO_SYNC_process(
                 if(++SYNC->counter > SYNC->counterOverflowValue) SYNC->counter = 1;
                 SYNC->running = CO_true;
                 SYNC->timer = 0;
+                SYNC->CANrxToggle = SYNC->CANrxToggle ? CO_false : CO_true;
                 SYNC->CANtxBuff->data[0] = SYNC->counter;
                 CO_CANsend(SYNC->CANdevTx, SYNC->CANtxBuff);
+#ifdef CO_CAN_RX_TIMESTAMP
+                SYNC->timestamp = CO_CANtimestampNow();
+#endif
                 ret = 1;
             }
         }
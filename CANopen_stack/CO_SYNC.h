@@ -80,8 +80,16 @@ typedef struct{
     /** Timer for the SYNC message in [microseconds].
     Set to zero after received or transmitted SYNC message */
     uint32_t            timer;
+    /** Toggled with each received or transmitted SYNC message. Synchronous
+    RPDOs use it to separate messages received before and after the SYNC. */
+    CO_bool_t           CANrxToggle;
     /** Set to nonzero value, if SYNC with wrong data length is received from CAN */
     uint16_t            receiveError;
+#ifdef CO_CAN_RX_TIMESTAMP
+    /** Time of the last received or transmitted SYNC message in [nanoseconds],
+    see CO_CANrxMsg_readTimestamp(). Zero if not available. */
+    uint64_t            timestamp;
+#endif
     CO_CANmodule_t     *CANdevRx;       /**< From CO_SYNC_init() */
     uint16_t            CANdevRxIdx;    /**< From CO_SYNC_init() */
     CO_CANmodule_t     *CANdevTx;       /**< From CO_SYNC_init() */
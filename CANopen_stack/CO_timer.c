@@ -0,0 +1,250 @@
+/*
+ * Timer wheel for timeouts of CANopen objects.
+ *
+ * @file        CO_timer.c
+ * @ingroup     CO_timer
+ * @version     SVN: \$Id$
+ * @author      Janez Paternoster
+ * @copyright   2004 - 2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "CO_driver.h"
+#include "CO_timer.h"
+
+
+#if CO_TIMER_SLOT_BITS < 1 || CO_TIMER_SLOT_BITS > 6 || CO_TIMER_LEVELS < 1 || (CO_TIMER_SLOT_BITS * CO_TIMER_LEVELS) > 31
+    #error Wrong CO_TIMER_SLOT_BITS or CO_TIMER_LEVELS.
+#endif
+
+#define CO_TIMER_MASK               (CO_TIMER_SLOTS - 1U)
+#define CO_TIMER_SHIFT(level)       ((level) * CO_TIMER_SLOT_BITS)
+/* Longest time, which can be placed into the wheel directly */
+#define CO_TIMER_RANGE              ((1UL << CO_TIMER_SHIFT(CO_TIMER_LEVELS)) - 1U)
+
+
+/*
+ * Find the first nonempty slot, starting from slot _start_.
+ *
+ * @param occupied Bits of nonempty slots of one level.
+ * @param start Starting slot.
+ *
+ * @return Distance from _start_ to the first nonempty slot.
+ */
+static uint8_t CO_timer_firstSlot(uint64_t occupied, uint8_t start){
+    uint8_t distance = 0;
+
+    /* rotate bits, so _start_ is bit 0 */
+    if(start != 0U){
+        occupied = (occupied >> start) | (occupied << (CO_TIMER_SLOTS - start));
+    }
+    if(CO_TIMER_SLOTS < 64U){
+        occupied &= (((uint64_t)1) << (CO_TIMER_SLOTS & 63U)) - 1U;
+    }
+
+#if defined(__GNUC__)
+    distance = (uint8_t)__builtin_ctzll(occupied);
+#else
+    while((occupied & 1U) == 0U){
+        occupied >>= 1;
+        distance++;
+    }
+#endif
+    return distance;
+}
+
+
+/*
+ * Place timer into the wheel according to its expiration time.
+ *
+ * Timer, which expires now, is placed into the current slot of level 0. It is
+ * used only for timers moved from higher levels, current slot is processed
+ * just after.
+ */
+static void CO_timer_insert(CO_timerWheel_t *wheel, CO_timer_t *timer){
+    uint32_t delta = timer->expires_ms - wheel->now_ms;
+    uint32_t slotTime = timer->expires_ms;
+    uint8_t level = 0U;
+    CO_timer_t **head;
+
+    if(delta > CO_TIMER_RANGE){
+        /* too far, place it into the last slot and move it again later */
+        slotTime = wheel->now_ms + CO_TIMER_RANGE;
+        level = CO_TIMER_LEVELS - 1U;
+    }
+    else{
+        while(level < (CO_TIMER_LEVELS - 1U) && delta >= (1UL << CO_TIMER_SHIFT(level + 1U))){
+            level++;
+        }
+    }
+
+    timer->level = level;
+    timer->slot = (uint8_t)((slotTime >> CO_TIMER_SHIFT(level)) & CO_TIMER_MASK);
+    head = &wheel->slots[level][timer->slot];
+
+    timer->next = *head;
+    if(*head != NULL) (*head)->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+    wheel->occupied[level] |= ((uint64_t)1) << timer->slot;
+}
+
+
+/*
+ * Take all timers from the slot.
+ *
+ * @return List of timers. _pprev_ of the first timer points to a slot, which
+ * no longer holds it, caller must update it.
+ */
+static CO_timer_t *CO_timer_takeSlot(CO_timerWheel_t *wheel, uint8_t level, uint8_t slot){
+    CO_timer_t *list = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+    wheel->occupied[level] &= ~(((uint64_t)1) << slot);
+    return list;
+}
+
+
+/*
+ * Process the wheel at time _now_ms_: move timers from higher levels, whose
+ * slots start now, and expire timers in the current slot of level 0.
+ */
+static void CO_timerWheel_tick(CO_timerWheel_t *wheel){
+    uint32_t now = wheel->now_ms;
+    CO_timer_t *list;
+    uint8_t level = 1U;
+
+    /* slots of higher levels start, when all lower levels wrap around */
+    while(level < CO_TIMER_LEVELS && ((now >> CO_TIMER_SHIFT(level - 1U)) & CO_TIMER_MASK) == 0U){
+        level++;
+    }
+    /* move timers, the highest level first */
+    while(--level > 0U){
+        list = CO_timer_takeSlot(wheel, level, (uint8_t)((now >> CO_TIMER_SHIFT(level)) & CO_TIMER_MASK));
+        while(list != NULL){
+            CO_timer_t *timer = list;
+
+            list = timer->next;
+            CO_timer_insert(wheel, timer);
+        }
+    }
+
+    /* expire timers of the current slot. List is kept valid, because
+     * functions of expired timers may stop other timers from it. */
+    list = CO_timer_takeSlot(wheel, 0U, (uint8_t)(now & CO_TIMER_MASK));
+    if(list != NULL) list->pprev = &list;
+    while(list != NULL){
+        CO_timer_t *timer = list;
+
+        list = timer->next;
+        if(list != NULL) list->pprev = &list;
+        timer->pprev = NULL;
+        if(timer->pFunct != NULL){
+            timer->pFunct(timer->object);
+        }
+    }
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_init(CO_timerWheel_t *wheel){
+    uint8_t level;
+    uint16_t slot;
+
+    wheel->now_ms = 0U;
+    for(level=0U; level<CO_TIMER_LEVELS; level++){
+        for(slot=0U; slot<CO_TIMER_SLOTS; slot++){
+            wheel->slots[level][slot] = NULL;
+        }
+        wheel->occupied[level] = 0U;
+    }
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_process(CO_timerWheel_t *wheel, uint32_t timeDifference_ms){
+
+    /* skip empty slots, stop at each deadline */
+    while(timeDifference_ms > 0U){
+        uint32_t deadline = CO_timerWheel_nextDeadline(wheel);
+
+        if(deadline > timeDifference_ms){
+            wheel->now_ms += timeDifference_ms;
+            break;
+        }
+        wheel->now_ms += deadline;
+        timeDifference_ms -= deadline;
+        CO_timerWheel_tick(wheel);
+    }
+}
+
+
+/******************************************************************************/
+uint32_t CO_timerWheel_nextDeadline(const CO_timerWheel_t *wheel){
+    uint32_t now = wheel->now_ms;
+    uint32_t deadline = CO_TIMER_NONE;
+    uint8_t level;
+
+    for(level=0U; level<CO_TIMER_LEVELS; level++){
+        if(wheel->occupied[level] != 0U){
+            /* next start of the slot is the deadline. Slots are searched
+             * from the one after current. */
+            uint32_t slotNow = now >> CO_TIMER_SHIFT(level);
+            uint8_t start = (uint8_t)((slotNow + 1U) & CO_TIMER_MASK);
+            uint32_t slotNext = slotNow + 1U + CO_timer_firstSlot(wheel->occupied[level], start);
+            uint32_t d = (slotNext << CO_TIMER_SHIFT(level)) - now;
+
+            if(d < deadline) deadline = d;
+        }
+    }
+
+    return deadline;
+}
+
+
+/******************************************************************************/
+void CO_timer_init(CO_timer_t *timer, void (*pFunct)(void *object), void *object){
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expires_ms = 0U;
+    timer->level = 0U;
+    timer->slot = 0U;
+    timer->pFunct = pFunct;
+    timer->object = object;
+}
+
+
+/******************************************************************************/
+void CO_timer_start(CO_timerWheel_t *wheel, CO_timer_t *timer, uint32_t delay_ms){
+    CO_timer_stop(timer);
+    if(delay_ms == 0U) delay_ms = 1U;
+    timer->expires_ms = wheel->now_ms + delay_ms;
+    CO_timer_insert(wheel, timer);
+}
+
+
+/******************************************************************************/
+void CO_timer_stop(CO_timer_t *timer){
+    if(timer->pprev != NULL){
+        *timer->pprev = timer->next;
+        if(timer->next != NULL) timer->next->pprev = timer->pprev;
+        timer->pprev = NULL;
+    }
+}
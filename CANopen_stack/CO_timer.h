@@ -0,0 +1,196 @@
+/**
+ * Timer wheel for timeouts of CANopen objects.
+ *
+ * @file        CO_timer.h
+ * @ingroup     CO_timer
+ * @version     SVN: \$Id$
+ * @author      Janez Paternoster
+ * @copyright   2004 - 2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CO_TIMER_H
+#define CO_TIMER_H
+
+
+/**
+ * @defgroup CO_timer Timer wheel
+ * @ingroup CO_CANopen
+ * @{
+ *
+ * Hierarchical timer wheel for timeouts of CANopen objects.
+ *
+ * CANopen objects don't count their timeouts on each call of their process
+ * function. They start one-shot timers with CO_timer_start() and stop them
+ * with CO_timer_stop(). CO_timerWheel_process() advances the time of the
+ * wheel and calls the function of each expired timer. Starting, stopping and
+ * expiration of the timer take constant time, independent of the number of
+ * running timers.
+ *
+ * Wheel has #CO_TIMER_LEVELS levels with #CO_TIMER_SLOTS slots each. Slot of
+ * level 0 is one millisecond, slot of each next level is #CO_TIMER_SLOTS times
+ * longer. Timer is placed into the level, which covers its remaining time. When
+ * time reaches the slot of higher level, its timers are moved into lower
+ * levels. Timers longer than the whole wheel (2^24 ms with default values) are
+ * moved within the top level until they come into range.
+ *
+ * CO_timerWheel_nextDeadline() returns the time, after which
+ * CO_timerWheel_process() has to be called next. It may be used by the
+ * scheduler of the application to sleep between calls.
+ *
+ * Wheel is not thread safe. All its timers must be started, stopped and
+ * processed from the same thread.
+ */
+
+
+/** Number of bits of slot index in one level of the wheel, 1 to 6. */
+#ifndef CO_TIMER_SLOT_BITS
+    #define CO_TIMER_SLOT_BITS      6
+#endif
+/** Number of levels of the wheel. CO_TIMER_SLOT_BITS * CO_TIMER_LEVELS must be less than 32. */
+#ifndef CO_TIMER_LEVELS
+    #define CO_TIMER_LEVELS         4
+#endif
+/** Number of slots in one level of the wheel */
+#define CO_TIMER_SLOTS              (1U << CO_TIMER_SLOT_BITS)
+/** Return value of CO_timerWheel_nextDeadline(), if no timer is running */
+#define CO_TIMER_NONE               0xFFFFFFFFUL
+
+
+/**
+ * Timer object. It is usually part of the CANopen object, which uses it.
+ */
+typedef struct CO_timer{
+    /** Next timer in the same slot of the wheel */
+    struct CO_timer    *next;
+    /** Pointer to the pointer to this timer in the list or NULL, if timer is
+    not running */
+    struct CO_timer   **pprev;
+    /** Time of expiration, see CO_timerWheel_t::now_ms */
+    uint32_t            expires_ms;
+    /** Level of the wheel, where timer is placed */
+    uint8_t             level;
+    /** Slot of the level, where timer is placed */
+    uint8_t             slot;
+    /** From CO_timer_init() */
+    void              (*pFunct)(void *object);
+    /** From CO_timer_init() */
+    void               *object;
+}CO_timer_t;
+
+
+/**
+ * Timer wheel object.
+ */
+typedef struct{
+    /** Monotonic time of the wheel in [milliseconds], incremented by
+    CO_timerWheel_process(). Overflows after 49 days. */
+    uint32_t            now_ms;
+    /** Lists of timers in each slot */
+    CO_timer_t         *slots[CO_TIMER_LEVELS][CO_TIMER_SLOTS];
+    /** Bit is set for each nonempty slot */
+    uint64_t            occupied[CO_TIMER_LEVELS];
+}CO_timerWheel_t;
+
+
+/**
+ * Initialize timer wheel.
+ *
+ * Function must be called in the communication reset section, before timers
+ * of CANopen objects are initialized.
+ *
+ * @param wheel This object will be initialized.
+ */
+void CO_timerWheel_init(CO_timerWheel_t *wheel);
+
+
+/**
+ * Process timer wheel.
+ *
+ * Function advances the time of the wheel and calls the function of each
+ * expired timer. Timers expire in the order of their expiration time.
+ *
+ * @param wheel This object.
+ * @param timeDifference_ms Time difference from previous function call in [milliseconds].
+ */
+void CO_timerWheel_process(CO_timerWheel_t *wheel, uint32_t timeDifference_ms);
+
+
+/**
+ * Get time to the next deadline of the wheel.
+ *
+ * It is the latest time, when CO_timerWheel_process() has to be called next.
+ * Deadline may be earlier than expiration of the first timer, because far
+ * timers have to be moved into lower levels of the wheel first.
+ *
+ * @param wheel This object.
+ *
+ * @return Time in [milliseconds], at least 1, or CO_TIMER_NONE.
+ */
+uint32_t CO_timerWheel_nextDeadline(const CO_timerWheel_t *wheel);
+
+
+/**
+ * Initialize timer.
+ *
+ * Timer is not running after initialization.
+ *
+ * @param timer This object will be initialized.
+ * @param pFunct Function called, when timer expires, or NULL. It may start
+ * and stop any timers of the same wheel.
+ * @param object Object passed to _pFunct_.
+ */
+void CO_timer_init(CO_timer_t *timer, void (*pFunct)(void *object), void *object);
+
+
+/**
+ * Start the timer.
+ *
+ * If timer is already running, it is started again.
+ *
+ * @param wheel Timer wheel.
+ * @param timer This object.
+ * @param delay_ms Time to expiration in [milliseconds]. Zero is the same as 1.
+ */
+void CO_timer_start(CO_timerWheel_t *wheel, CO_timer_t *timer, uint32_t delay_ms);
+
+
+/**
+ * Stop the timer.
+ *
+ * Function may be called also, if timer is not running.
+ *
+ * @param timer This object.
+ */
+void CO_timer_stop(CO_timer_t *timer);
+
+
+/**
+ * Verify, if timer is running.
+ *
+ * @param timer This object.
+ *
+ * @return True, if timer is started and not yet expired.
+ */
+#define CO_timer_isRunning(timer) ((timer)->pprev != NULL)
+
+
+/** @} */
+#endif
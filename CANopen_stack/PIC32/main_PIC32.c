@@ -147,7 +147,7 @@ int main (void){
 
         /* initialize eeprom - part 2 */
 #ifdef USE_EEPROM
-        CO_EE_init_2(&CO_EEO, eeStatus, CO->SDO, CO->em);
+        CO_EE_init_2(&CO_EEO, eeStatus, CO->SDO[0], CO->em);
 #endif
 
 
@@ -280,8 +280,8 @@ void CO_FlashInit(void)
 //===========================================================================
 void CO_FlashRegisterODFunctions(CO_t* CO)
 {
-  CO_OD_configure(CO->SDO, OD_H1010_STORE_PARAM_FUNC,
+  CO_OD_configure(CO->SDO[0], OD_H1010_STORE_PARAM_FUNC,
                   CO_ODF_1010_StoreParam, (void*)0, 0, 0);
-  CO_OD_configure(CO->SDO, OD_H1011_REST_PARAM_FUNC,
+  CO_OD_configure(CO->SDO[0], OD_H1011_REST_PARAM_FUNC,
                   CO_ODF_1011_RestoreParam, (void*)0, 0, 0);
 }
@@ -28,10 +28,223 @@
  */
 
 
+#include <string.h>         /* for 'memset' */
 #include "CO_driver.h"
 #include "CO_Emergency.h"
 
 
+/*
+ * Get the head of the dispatch chain, where buffer with given ident and mask
+ * belongs.
+ */
+static uint16_t *CO_CANrxChainHead(CO_CANmodule_t *CANmodule, uint16_t ident, uint16_t mask){
+    uint16_t *head;
+
+    if((mask & 0x07FFU) == 0x07FFU){
+        head = &CANmodule->rxIndex[ident & 0x07FFU];
+    }
+    else{
+        head = &CANmodule->rxMaskedFirst;
+    }
+
+    return head;
+}
+
+
+/*
+ * Remove configured buffer from its dispatch chain.
+ */
+static void CO_CANrxChainRemove(CO_CANmodule_t *CANmodule, uint16_t index){
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t *link = CO_CANrxChainHead(CANmodule, buffer->ident, buffer->mask);
+
+    while(*link != CO_CAN_RX_INDEX_NONE){
+        if(*link == index){
+            *link = buffer->next;
+            break;
+        }
+        link = &CANmodule->rxArray[*link].next;
+    }
+    buffer->next = CO_CAN_RX_INDEX_NONE;
+}
+
+
+/*
+ * Insert buffer into its dispatch chain. Chain is kept sorted by index, so
+ * the buffer with the lowest index takes precedence, as in linear search.
+ */
+static void CO_CANrxChainInsert(CO_CANmodule_t *CANmodule, uint16_t index){
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t *link = CO_CANrxChainHead(CANmodule, buffer->ident, buffer->mask);
+
+    while((*link != CO_CAN_RX_INDEX_NONE) && (*link < index)){
+        link = &CANmodule->rxArray[*link].next;
+    }
+    buffer->next = *link;
+    *link = index;
+}
+
+
+/*
+ * Find buffer for received message. Buffers with exact identifier are looked
+ * up directly, buffers with other masks are verified after that. Both chains
+ * are sorted by index, so masked buffers are only verified up to the exact
+ * match and the buffer with the lowest index wins, as with the linear search.
+ */
+static CO_CANrx_t *CO_CANrxFind(CO_CANmodule_t *CANmodule, uint16_t rcvMsgIdent){
+    uint16_t found = CANmodule->rxIndex[rcvMsgIdent & 0x07FFU];
+    uint16_t index;
+
+    while(found != CO_CAN_RX_INDEX_NONE){
+        CO_CANrx_t *buffer = &CANmodule->rxArray[found];
+        if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
+            break;
+        }
+        found = buffer->next;
+    }
+
+    /* CO_CAN_RX_INDEX_NONE is larger than any index */
+    for(index = CANmodule->rxMaskedFirst; index < found; index = CANmodule->rxArray[index].next){
+        CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+        if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
+            return buffer;
+        }
+    }
+
+    return (found != CO_CAN_RX_INDEX_NONE) ? &CANmodule->rxArray[found] : NULL;
+}
+
+
+/*
+ * Index of the lowest set bit, value must not be zero.
+ */
+static uint16_t CO_CANlowestBit(uint32_t value){
+#ifdef __GNUC__
+    return (uint16_t)__builtin_ctz(value);
+#else
+    uint16_t i = 0U;
+
+    while((value & 1U) == 0U){
+        value >>= 1;
+        i++;
+    }
+
+    return i;
+#endif
+}
+
+
+/*
+ * Mark transmit object as ready in the scheduler. Its key must be set.
+ */
+static void CO_CANtxReadyInsert(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    uint16_t cls = buffer->syncFlag ? 1U : 0U;
+    uint16_t key = buffer->key;
+    uint32_t bit = 1UL << (key & 0x1FU);
+
+    if((CANmodule->txReady[cls][key >> 5] & bit) == 0U){
+        CANmodule->txReady[cls][key >> 5] |= bit;
+        CANmodule->txReadySummary[cls][key >> 10] |= 1UL << ((key >> 5) & 0x1FU);
+        buffer->next = CO_CAN_RX_INDEX_NONE;
+    }
+    else{
+        buffer->next = CANmodule->txReadyFirst[cls][key];
+    }
+    CANmodule->txReadyFirst[cls][key] = (uint16_t)(buffer - CANmodule->txArray);
+}
+
+
+/*
+ * Remove transmit object from the scheduler.
+ */
+static void CO_CANtxReadyRemove(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    uint16_t cls = buffer->syncFlag ? 1U : 0U;
+    uint16_t key = buffer->key;
+    uint16_t index = (uint16_t)(buffer - CANmodule->txArray);
+    uint16_t *link = &CANmodule->txReadyFirst[cls][key];
+
+    if((CANmodule->txReady[cls][key >> 5] & (1UL << (key & 0x1FU))) == 0U){
+        return;
+    }
+    while(*link != CO_CAN_RX_INDEX_NONE){
+        if(*link == index){
+            *link = buffer->next;
+            break;
+        }
+        link = &CANmodule->txArray[*link].next;
+    }
+    if(CANmodule->txReadyFirst[cls][key] == CO_CAN_RX_INDEX_NONE){
+        CANmodule->txReady[cls][key >> 5] &= ~(1UL << (key & 0x1FU));
+        if(CANmodule->txReady[cls][key >> 5] == 0U){
+            CANmodule->txReadySummary[cls][key >> 10] &= ~(1UL << ((key >> 5) & 0x1FU));
+        }
+    }
+}
+
+
+/*
+ * Find the lowest ready key of one class. Returns CO_CAN_TX_KEYS, if none.
+ */
+static uint16_t CO_CANtxReadyLowest(const CO_CANmodule_t *CANmodule, uint16_t cls){
+    uint16_t i;
+
+    for(i=0U; i<(CO_CAN_TX_KEYS / 1024U); i++){
+        uint32_t summary = CANmodule->txReadySummary[cls][i];
+        if(summary != 0U){
+            uint16_t word = (uint16_t)((i << 5) + CO_CANlowestBit(summary));
+            return (uint16_t)((word << 5) + CO_CANlowestBit(CANmodule->txReady[cls][word]));
+        }
+    }
+
+    return CO_CAN_TX_KEYS;
+}
+
+
+/*
+ * Discard queued messages of synchronous object, if they were purged by
+ * CO_CANclearPendingSyncPDOs().
+ */
+static void CO_CANtxSyncRevalidate(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    if(buffer->syncFlag && (buffer->epoch != CANmodule->txSyncEpoch)){
+        buffer->queueCount = 0U;
+        buffer->bufferFull = CO_false;
+        buffer->epoch = CANmodule->txSyncEpoch;
+    }
+}
+
+
+/*
+ * Take the oldest message from the ready object with the lowest key. Returns
+ * NULL, if nothing is queued. _data_ points into the object queue, where
+ * message stays until it is overwritten by CO_CANsend().
+ */
+static CO_CANtx_t *CO_CANtxPop(CO_CANmodule_t *CANmodule, uint8_t **data){
+    uint16_t key0 = CO_CANtxReadyLowest(CANmodule, 0U);
+    uint16_t key1 = CO_CANtxReadyLowest(CANmodule, 1U);
+    uint16_t cls = (key1 < key0) ? 1U : 0U;
+    uint16_t key = (cls != 0U) ? key1 : key0;
+    CO_CANtx_t *buffer;
+
+    if(key >= CO_CAN_TX_KEYS){
+        return NULL;
+    }
+    buffer = &CANmodule->txArray[CANmodule->txReadyFirst[cls][key]];
+    *data = buffer->queue[buffer->queueFirst];
+    buffer->queueFirst = (uint8_t)((buffer->queueFirst + 1U) % CO_CAN_TX_DEPTH);
+    buffer->queueCount--;
+    buffer->bufferFull = CO_false;
+    if(buffer->queueCount == 0U){
+        CO_CANtxReadyRemove(CANmodule, buffer);
+    }
+    CANmodule->CANtxCount--;
+    if(cls != 0U){
+        CANmodule->txSyncCount--;
+    }
+
+    return buffer;
+}
+
+
 /******************************************************************************/
 void CO_CANsetConfigurationMode(uint16_t CANbaseAddress){
 }
@@ -64,15 +277,29 @@ CO_ReturnError_t CO_CANmodule_init(
     CANmodule->bufferInhibitFlag = CO_false;
     CANmodule->firstCANtxMessage = CO_true;
     CANmodule->CANtxCount = 0U;
+    memset(CANmodule->txReady, 0, sizeof(CANmodule->txReady));
+    memset(CANmodule->txReadySummary, 0, sizeof(CANmodule->txReadySummary));
+    CANmodule->txSyncCount = 0U;
+    CANmodule->txSyncEpoch = 0U;
     CANmodule->errOld = 0U;
     CANmodule->em = NULL;
+    for(i=0U; i<CO_CAN_RX_INDEX_SIZE; i++){
+        CANmodule->rxIndex[i] = CO_CAN_RX_INDEX_NONE;
+    }
+    CANmodule->rxMaskedFirst = CO_CAN_RX_INDEX_NONE;
 
     for(i=0U; i<rxSize; i++){
         rxArray[i].ident = 0U;
+        rxArray[i].next = CO_CAN_RX_INDEX_NONE;
         rxArray[i].pFunct = NULL;
     }
     for(i=0U; i<txSize; i++){
         txArray[i].bufferFull = CO_false;
+        txArray[i].syncFlag = CO_false;
+        txArray[i].queueDepth = CO_CAN_TX_DEPTH;
+        txArray[i].queueFirst = 0U;
+        txArray[i].queueCount = 0U;
+        txArray[i].epoch = 0U;
     }
 
 
@@ -131,6 +358,12 @@ CO_ReturnError_t CO_CANrxBufferInit(
         /* buffer, which will be configured */
         CO_CANrx_t *buffer = &CANmodule->rxArray[index];
 
+        CO_DISABLE_INTERRUPTS();
+        /* Buffer may be reconfigured, remove it from dispatch index first */
+        if(buffer->pFunct != NULL){
+            CO_CANrxChainRemove(CANmodule, index);
+        }
+
         /* Configure object variables */
         buffer->object = object;
         buffer->pFunct = pFunct;
@@ -142,6 +375,9 @@ CO_ReturnError_t CO_CANrxBufferInit(
         }
         buffer->mask = (mask & 0x07FFU) | 0x0800U;
 
+        CO_CANrxChainInsert(CANmodule, index);
+        CO_ENABLE_INTERRUPTS();
+
         /* Set CAN hardware module filter and mask. */
         if(CANmodule->useCANrxFilters){
 
@@ -170,14 +406,31 @@ CO_CANtx_t *CO_CANtxBufferInit(
         /* get specific buffer */
         buffer = &CANmodule->txArray[index];
 
+        /* discard messages, queued with previous configuration */
+        CO_DISABLE_INTERRUPTS();
+        CO_CANtxSyncRevalidate(CANmodule, buffer);
+        if(buffer->queueCount != 0U){
+            CO_CANtxReadyRemove(CANmodule, buffer);
+            CANmodule->CANtxCount -= buffer->queueCount;
+            if(buffer->syncFlag){
+                CANmodule->txSyncCount -= buffer->queueCount;
+            }
+            buffer->queueCount = 0U;
+        }
+        CO_ENABLE_INTERRUPTS();
+
         /* CAN identifier, DLC and rtr, bit aligned with CAN module transmit buffer.
-         * Microcontroller specific. */
+         * Microcontroller specific. Here identifier is in bits 0..10, rtr in
+         * bit 11 (as in CO_CANrx_t) and DLC in bits 12..15. */
         buffer->ident = ((uint32_t)ident & 0x07FFU)
-                      | ((uint32_t)(((uint32_t)noOfBytes & 0xFU) << 12U))
-                      | ((uint32_t)(rtr ? 0x8000U : 0U));
+                      | ((uint32_t)(rtr ? 0x0800U : 0U))
+                      | ((uint32_t)(((uint32_t)noOfBytes & 0xFU) << 12U));
 
         buffer->bufferFull = CO_false;
         buffer->syncFlag = syncFlag;
+        buffer->queueDepth = CO_CAN_TX_DEPTH;
+        buffer->queueFirst = 0U;
+        buffer->epoch = CANmodule->txSyncEpoch;
     }
 
     return buffer;
@@ -187,27 +440,46 @@ CO_CANtx_t *CO_CANtxBufferInit(
 /******************************************************************************/
 CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
     CO_ReturnError_t err = CO_ERROR_NO;
+    uint8_t *data;
+
+    CO_DISABLE_INTERRUPTS();
+    CO_CANtxSyncRevalidate(CANmodule, buffer);
+
+    /* if CAN TX buffer is free and nothing is queued, copy message to it */
+    if(1 && CANmodule->CANtxCount == 0){
+        CANmodule->bufferInhibitFlag = buffer->syncFlag;
+        /* copy message and txRequest */
+        CO_ENABLE_INTERRUPTS();
+        return err;
+    }
 
     /* Verify overflow */
-    if(buffer->bufferFull){
+    if(buffer->queueCount >= buffer->queueDepth){
         if(!CANmodule->firstCANtxMessage){
             /* don't set error, if bootup message is still on buffers */
             CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_TX_OVERFLOW, CO_EMC_CAN_OVERRUN, buffer->ident);
         }
         err = CO_ERROR_TX_OVERFLOW;
-    }
 
-    CO_DISABLE_INTERRUPTS();
-    /* if CAN TX buffer is free, copy message to it */
-    if(1 && CANmodule->CANtxCount == 0){
-        CANmodule->bufferInhibitFlag = buffer->syncFlag;
-        /* copy message and txRequest */
+        /* overwrite the newest message */
+        data = buffer->queue[(buffer->queueFirst + buffer->queueCount - 1U) % CO_CAN_TX_DEPTH];
     }
-    /* if no buffer is free, message will be sent by interrupt */
+    /* message will be sent by interrupt */
     else{
-        buffer->bufferFull = CO_true;
+        if(buffer->queueCount == 0U){
+            buffer->key = (uint16_t)(((buffer->ident & 0x07FFU) << 1) | ((buffer->ident >> 11) & 1U));
+            CO_CANtxReadyInsert(CANmodule, buffer);
+        }
+        data = buffer->queue[(buffer->queueFirst + buffer->queueCount) % CO_CAN_TX_DEPTH];
+        buffer->queueCount++;
         CANmodule->CANtxCount++;
+        if(buffer->syncFlag){
+            CANmodule->txSyncCount++;
+        }
     }
+    memcpy(data, buffer->data, sizeof(buffer->data));
+
+    buffer->bufferFull = (buffer->queueCount >= buffer->queueDepth) ? CO_true : CO_false;
     CO_ENABLE_INTERRUPTS();
 
     return err;
@@ -226,20 +498,15 @@ void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule){
         CANmodule->bufferInhibitFlag = CO_false;
         tpdoDeleted = 1U;
     }
-    /* delete also pending synchronous TPDOs in TX buffers */
-    if(CANmodule->CANtxCount != 0U){
-        uint16_t i;
-        CO_CANtx_t *buffer = &CANmodule->txArray[0];
-        for(i = CANmodule->txSize; i > 0U; i--){
-            if(buffer->bufferFull){
-                if(buffer->syncFlag){
-                    buffer->bufferFull = CO_false;
-                    CANmodule->CANtxCount--;
-                    tpdoDeleted = 2U;
-                }
-            }
-            buffer++;
-        }
+    /* delete also pending synchronous TPDOs: clear their scheduler class and
+     * invalidate their object queues with new epoch. */
+    if(CANmodule->txSyncCount != 0U){
+        CANmodule->CANtxCount -= CANmodule->txSyncCount;
+        CANmodule->txSyncCount = 0U;
+        CANmodule->txSyncEpoch++;
+        memset(CANmodule->txReady[1], 0, sizeof(CANmodule->txReady[1]));
+        memset(CANmodule->txReadySummary[1], 0, sizeof(CANmodule->txReadySummary[1]));
+        tpdoDeleted = 2U;
     }
     CO_ENABLE_INTERRUPTS();
 
@@ -336,14 +603,10 @@ void CO_CANinterrupt(CO_CANmodule_t *CANmodule){
         }
         else{
             /* CAN module filters are not used, message with any standard 11-bit identifier */
-            /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-            buffer = &CANmodule->rxArray[0];
-            for(index = CANmodule->rxSize; index > 0U; index--){
-                if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
-                    msgMatched = CO_true;
-                    break;
-                }
-                buffer++;
+            /* has been received. Find the same CAN-ID in dispatch index from CANmodule. */
+            buffer = CO_CANrxFind(CANmodule, (uint16_t)rcvMsgIdent);
+            if(buffer != NULL){
+                msgMatched = CO_true;
             }
         }
 
@@ -366,27 +629,19 @@ void CO_CANinterrupt(CO_CANmodule_t *CANmodule){
         CANmodule->bufferInhibitFlag = CO_false;
         /* Are there any new messages waiting to be send */
         if(CANmodule->CANtxCount > 0U){
-            uint16_t i;             /* index of transmitting message */
-
-            /* first buffer */
-            CO_CANtx_t *buffer = &CANmodule->txArray[0];
-            /* search through whole array of pointers to transmit message buffers. */
-            for(i = CANmodule->txSize; i > 0U; i--){
-                /* if message buffer is full, send it. */
-                if(buffer->bufferFull){
-                    buffer->bufferFull = CO_false;
-                    CANmodule->CANtxCount--;
-
-                    /* Copy message to CAN buffer */
-                    CANmodule->bufferInhibitFlag = buffer->syncFlag;
-                    /* canSend... */
-                    break;                      /* exit for loop */
-                }
-                buffer++;
-            }/* end of for loop */
-
+            /* queued message with the lowest CAN identifier (data before RTR),
+             * so messages leave in the same order, as they would win
+             * arbitration on the bus. */
+            uint8_t *data;
+            CO_CANtx_t *bufferToSend = CO_CANtxPop(CANmodule, &data);
+
+            if(bufferToSend != NULL){
+                /* Copy message (ident and data) to CAN buffer */
+                CANmodule->bufferInhibitFlag = bufferToSend->syncFlag;
+                /* canSend... */
+            }
             /* Clear counter if no more messages */
-            if(i == 0U){
+            else{
                 CANmodule->CANtxCount = 0U;
             }
         }
@@ -106,11 +106,11 @@
  * where CAN message data can be written. CAN message is send with calling
  * CO_CANsend() function. If at that moment CAN transmit buffer inside
  * microcontroller's CAN module is free, message is copied directly to CAN module.
- * Otherwise CO_CANsend() function sets _bufferFull_ flag to true. Message will be
- * then sent by CAN TX interrupt as soon as CAN module is freed. Until message is
- * not copied to CAN module, its contents must not change. There may be multiple
- * _bufferFull_ flags in CO_CANtx_t array set to true. In that case messages with
- * lower index inside array will be sent first.
+ * Otherwise CO_CANsend() copies message data into the queue of CO_CANtx_t
+ * object. Message will be then sent by CAN TX interrupt as soon as CAN module
+ * is freed. Queued messages are sent in order of CAN identifier, lowest first,
+ * as they would win arbitration on the bus, see @ref CO_CAN_TX_KEYS. _bufferFull_
+ * flag is set, when queue of the object is full.
  */
 
 
@@ -190,12 +190,44 @@ typedef struct{
 }CO_CANrxMsg_t;
 
 
+/**
+ * @name Receive dispatch index
+ * Received messages are matched against _rxArray_ through a table, which is
+ * directly indexed by 11-bit CAN identifier. See CO_CANmodule_t.
+ * @{
+ */
+    #define CO_CAN_RX_INDEX_SIZE    0x800U  /**< Number of entries in dispatch index */
+    #define CO_CAN_RX_INDEX_NONE    0xFFFFU /**< Empty entry or end of chain */
+/** @} */
+
+
+/**
+ * @name Transmit scheduler
+ * Messages are transmitted in order of CAN identifier, lowest first, as they
+ * would win arbitration on the bus. Each CO_CANtx_t object has own queue.
+ * Scheduler uses bitmaps of keys with queued messages, so the next message is
+ * found without scanning _txArray_. Its tables in CO_CANmodule_t take about
+ * 17 kB of RAM. Microcontroller with less RAM may map keys to _txArray_ index
+ * instead.
+ * @{
+ */
+    #ifndef CO_CAN_TX_DEPTH
+    /** Maximum (and default) number of messages, queued in one CO_CANtx_t object */
+    #define CO_CAN_TX_DEPTH         4U
+    #endif
+    /** Number of scheduling keys: 11-bit identifier and RTR bit */
+    #define CO_CAN_TX_KEYS          0x1000U
+/** @} */
+
+
 /**
  * Received message object
  */
 typedef struct{
     uint16_t            ident;          /**< Standard CAN Identifier (bits 0..10) + RTR (bit 11) */
     uint16_t            mask;           /**< Standard Identifier mask with same alignment as ident */
+    /** Index of next buffer in the same dispatch chain or CO_CAN_RX_INDEX_NONE */
+    uint16_t            next;
     void               *object;         /**< From CO_CANrxBufferInit() */
     void              (*pFunct)(void *object, const CO_CANrxMsg_t *message);  /**< From CO_CANrxBufferInit() */
 }CO_CANrx_t;
@@ -207,9 +239,20 @@ typedef struct{
 typedef struct{
     uint32_t            ident;          /**< CAN identifier as aligned in CAN module */
     uint8_t             data[8];        /**< 8 data bytes */
-    volatile CO_bool_t  bufferFull;     /**< True if previous message is still in buffer */
+    /** True if object queue is full. Next CO_CANsend() will overwrite the newest message. */
+    volatile CO_bool_t  bufferFull;
     /** Synchronous PDO messages has this flag set. It prevents them to be sent outside the synchronous window */
     volatile CO_bool_t  syncFlag;
+    /** Data of messages waiting for transmission, copied by CO_CANsend() */
+    uint8_t             queue[CO_CAN_TX_DEPTH][8];
+    /** Queue depth, set to CO_CAN_TX_DEPTH by CO_CANtxBufferInit(). It may be
+      * lowered afterwards, 1 keeps only the latest message. */
+    uint8_t             queueDepth;
+    uint8_t             queueFirst;     /**< Index of the oldest message in _queue_ */
+    uint8_t             queueCount;     /**< Number of messages in _queue_ */
+    uint16_t            key;            /**< Scheduling key of queued messages */
+    uint16_t            next;           /**< Next object with the same key or CO_CAN_RX_INDEX_NONE */
+    uint32_t            epoch;          /**< CO_CANmodule_t::txSyncEpoch, when synchronous message was queued */
 }CO_CANtx_t;
 
 
@@ -236,8 +279,30 @@ typedef struct{
     volatile CO_bool_t  firstCANtxMessage;
     /** Number of messages in transmit buffer, which are waiting to be copied to the CAN module */
     volatile uint16_t   CANtxCount;
+    /** Transmit scheduler: bitmaps of scheduling keys with queued messages,
+      * separate for ordinary [0] and synchronous [1] messages. */
+    uint32_t            txReady[2][CO_CAN_TX_KEYS / 32U];
+    /** Summary of _txReady_, one bit for each nonzero word */
+    uint32_t            txReadySummary[2][CO_CAN_TX_KEYS / 1024U];
+    /** First object from _txArray_ for each key, valid if bit in _txReady_ is set.
+      * Objects with the same key are chained through CO_CANtx_t::next. */
+    uint16_t            txReadyFirst[2][CO_CAN_TX_KEYS];
+    /** Number of queued synchronous messages */
+    uint16_t            txSyncCount;
+    /** Incremented by CO_CANclearPendingSyncPDOs(). Queues of synchronous
+      * objects with older epoch are discarded. */
+    uint32_t            txSyncEpoch;
     uint32_t            errOld;         /**< Previous state of CAN errors */
     void               *em;             /**< Emergency object */
+    /** Receive dispatch index, maintained by CO_CANrxBufferInit(). For each
+      * 11-bit CAN identifier it holds index of the first buffer from _rxArray_
+      * with exact (0x7FF) mask. Further buffers with the same identifier (RTR or
+      * duplicates) are chained in ascending order through CO_CANrx_t::next. */
+    uint16_t            rxIndex[CO_CAN_RX_INDEX_SIZE];
+    /** First buffer from _rxArray_ with mask different than 0x7FF. Those
+      * buffers are chained the same way and are verified, if there is no
+      * match in _rxIndex_. */
+    uint16_t            rxMaskedFirst;
 }CO_CANmodule_t;
 
 
@@ -395,6 +460,9 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
  * when it is called. Function should be called by the stack in the moment,
  * when SYNC time was just passed out of synchronous window.
  *
+ * Queued synchronous messages are discarded in constant time, their objects
+ * are revalidated with _txSyncEpoch_ on next use.
+ *
  * @param CANmodule This object.
  */
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule);
@@ -45,17 +45,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=../../CANopen_stack/PIC32/CO_driver.c ../../CANopen_stack/PIC32/eeprom.c ../../CANopen_stack/PIC32/main_PIC32.c ../../CANopen_stack/CO_Emergency.c ../../CANopen_stack/CO_HBconsumer.c ../../CANopen_stack/CO_NMT_Heartbeat.c ../../CANopen_stack/CO_PDO.c ../../CANopen_stack/CO_SDO.c ../../CANopen_stack/CO_SYNC.c ../../CANopen_stack/CANopen.c ../../CANopen_stack/crc16-ccitt.c ../appl_PIC32_explorer16_IO.c ../CO_OD.c
+SOURCEFILES_QUOTED_IF_SPACED=../../CANopen_stack/PIC32/CO_driver.c ../../CANopen_stack/PIC32/eeprom.c ../../CANopen_stack/PIC32/main_PIC32.c ../../CANopen_stack/CO_Emergency.c ../../CANopen_stack/CO_HBconsumer.c ../../CANopen_stack/CO_NMT_Heartbeat.c ../../CANopen_stack/CO_PDO.c ../../CANopen_stack/CO_SDO.c ../../CANopen_stack/CO_SYNC.c ../../CANopen_stack/CO_timer.c ../../CANopen_stack/CANopen.c ../../CANopen_stack/crc16-ccitt.c ../appl_PIC32_explorer16_IO.c ../CO_OD.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/542917987/CO_driver.o ${OBJECTDIR}/_ext/542917987/eeprom.o ${OBJECTDIR}/_ext/542917987/main_PIC32.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/1472/appl_PIC32_explorer16_IO.o ${OBJECTDIR}/_ext/1472/CO_OD.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/542917987/CO_driver.o.d ${OBJECTDIR}/_ext/542917987/eeprom.o.d ${OBJECTDIR}/_ext/542917987/main_PIC32.o.d ${OBJECTDIR}/_ext/581370467/CO_Emergency.o.d ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o.d ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o.d ${OBJECTDIR}/_ext/581370467/CO_PDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d ${OBJECTDIR}/_ext/581370467/CANopen.o.d ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o.d ${OBJECTDIR}/_ext/1472/appl_PIC32_explorer16_IO.o.d ${OBJECTDIR}/_ext/1472/CO_OD.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/542917987/CO_driver.o ${OBJECTDIR}/_ext/542917987/eeprom.o ${OBJECTDIR}/_ext/542917987/main_PIC32.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CO_timer.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/1472/appl_PIC32_explorer16_IO.o ${OBJECTDIR}/_ext/1472/CO_OD.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/542917987/CO_driver.o.d ${OBJECTDIR}/_ext/542917987/eeprom.o.d ${OBJECTDIR}/_ext/542917987/main_PIC32.o.d ${OBJECTDIR}/_ext/581370467/CO_Emergency.o.d ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o.d ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o.d ${OBJECTDIR}/_ext/581370467/CO_PDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d ${OBJECTDIR}/_ext/581370467/CO_timer.o.d ${OBJECTDIR}/_ext/581370467/CANopen.o.d ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o.d ${OBJECTDIR}/_ext/1472/appl_PIC32_explorer16_IO.o.d ${OBJECTDIR}/_ext/1472/CO_OD.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/_ext/542917987/CO_driver.o ${OBJECTDIR}/_ext/542917987/eeprom.o ${OBJECTDIR}/_ext/542917987/main_PIC32.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/1472/appl_PIC32_explorer16_IO.o ${OBJECTDIR}/_ext/1472/CO_OD.o
+OBJECTFILES=${OBJECTDIR}/_ext/542917987/CO_driver.o ${OBJECTDIR}/_ext/542917987/eeprom.o ${OBJECTDIR}/_ext/542917987/main_PIC32.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CO_timer.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/1472/appl_PIC32_explorer16_IO.o ${OBJECTDIR}/_ext/1472/CO_OD.o
 
 # Source Files
-SOURCEFILES=../../CANopen_stack/PIC32/CO_driver.c ../../CANopen_stack/PIC32/eeprom.c ../../CANopen_stack/PIC32/main_PIC32.c ../../CANopen_stack/CO_Emergency.c ../../CANopen_stack/CO_HBconsumer.c ../../CANopen_stack/CO_NMT_Heartbeat.c ../../CANopen_stack/CO_PDO.c ../../CANopen_stack/CO_SDO.c ../../CANopen_stack/CO_SYNC.c ../../CANopen_stack/CANopen.c ../../CANopen_stack/crc16-ccitt.c ../appl_PIC32_explorer16_IO.c ../CO_OD.c
+SOURCEFILES=../../CANopen_stack/PIC32/CO_driver.c ../../CANopen_stack/PIC32/eeprom.c ../../CANopen_stack/PIC32/main_PIC32.c ../../CANopen_stack/CO_Emergency.c ../../CANopen_stack/CO_HBconsumer.c ../../CANopen_stack/CO_NMT_Heartbeat.c ../../CANopen_stack/CO_PDO.c ../../CANopen_stack/CO_SDO.c ../../CANopen_stack/CO_SYNC.c ../../CANopen_stack/CO_timer.c ../../CANopen_stack/CANopen.c ../../CANopen_stack/crc16-ccitt.c ../appl_PIC32_explorer16_IO.c ../CO_OD.c
 
 
 CFLAGS=
@@ -145,6 +145,12 @@ ${OBJECTDIR}/_ext/581370467/CO_SYNC.o: ../../CANopen_stack/CO_SYNC.c  nbproject/
 	@${RM} ${OBJECTDIR}/_ext/581370467/CO_SYNC.o 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_ICD3=1 -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -DCO_SDO_BUFFER_SIZE=889 -I"../../CANopen_stack" -I"../../CANopen_stack/PIC32" -I".." -Wall -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d" -o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ../../CANopen_stack/CO_SYNC.c   
 	
+${OBJECTDIR}/_ext/581370467/CO_timer.o: ../../CANopen_stack/CO_timer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
+	@${RM} ${OBJECTDIR}/_ext/581370467/CO_timer.o.d 
+	@${RM} ${OBJECTDIR}/_ext/581370467/CO_timer.o 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_timer.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_ICD3=1 -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -DCO_SDO_BUFFER_SIZE=889 -I"../../CANopen_stack" -I"../../CANopen_stack/PIC32" -I".." -Wall -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_timer.o.d" -o ${OBJECTDIR}/_ext/581370467/CO_timer.o ../../CANopen_stack/CO_timer.c   
+	
 ${OBJECTDIR}/_ext/581370467/CANopen.o: ../../CANopen_stack/CANopen.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
 	@${RM} ${OBJECTDIR}/_ext/581370467/CANopen.o.d 
@@ -224,6 +230,12 @@ ${OBJECTDIR}/_ext/581370467/CO_SYNC.o: ../../CANopen_stack/CO_SYNC.c  nbproject/
 	@${RM} ${OBJECTDIR}/_ext/581370467/CO_SYNC.o 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -DCO_SDO_BUFFER_SIZE=889 -I"../../CANopen_stack" -I"../../CANopen_stack/PIC32" -I".." -Wall -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d" -o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ../../CANopen_stack/CO_SYNC.c   
 	
+${OBJECTDIR}/_ext/581370467/CO_timer.o: ../../CANopen_stack/CO_timer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
+	@${RM} ${OBJECTDIR}/_ext/581370467/CO_timer.o.d 
+	@${RM} ${OBJECTDIR}/_ext/581370467/CO_timer.o 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_timer.o.d" $(SILENT) -rsi ${MP_CC_DIR}../  -c ${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION) -DCO_SDO_BUFFER_SIZE=889 -I"../../CANopen_stack" -I"../../CANopen_stack/PIC32" -I".." -Wall -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_timer.o.d" -o ${OBJECTDIR}/_ext/581370467/CO_timer.o ../../CANopen_stack/CO_timer.c   
+	
 ${OBJECTDIR}/_ext/581370467/CANopen.o: ../../CANopen_stack/CANopen.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
 	@${RM} ${OBJECTDIR}/_ext/581370467/CANopen.o.d 
@@ -45,11 +45,11 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/851890637/CO_driver.o ${OBJECTDIR}/_ext/851890637/eeprom.o ${OBJECTDIR}/_ext/851890637/main_generic.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/581370467/application.o ${OBJECTDIR}/_ext/1472/CO_OD.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/851890637/CO_driver.o.d ${OBJECTDIR}/_ext/851890637/eeprom.o.d ${OBJECTDIR}/_ext/851890637/main_generic.o.d ${OBJECTDIR}/_ext/581370467/CO_Emergency.o.d ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o.d ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o.d ${OBJECTDIR}/_ext/581370467/CO_PDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d ${OBJECTDIR}/_ext/581370467/CANopen.o.d ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o.d ${OBJECTDIR}/_ext/581370467/application.o.d ${OBJECTDIR}/_ext/1472/CO_OD.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/851890637/CO_driver.o ${OBJECTDIR}/_ext/851890637/eeprom.o ${OBJECTDIR}/_ext/851890637/main_generic.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CO_timer.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/581370467/application.o ${OBJECTDIR}/_ext/1472/CO_OD.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/851890637/CO_driver.o.d ${OBJECTDIR}/_ext/851890637/eeprom.o.d ${OBJECTDIR}/_ext/851890637/main_generic.o.d ${OBJECTDIR}/_ext/581370467/CO_Emergency.o.d ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o.d ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o.d ${OBJECTDIR}/_ext/581370467/CO_PDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SDO.o.d ${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d ${OBJECTDIR}/_ext/581370467/CO_timer.o.d ${OBJECTDIR}/_ext/581370467/CANopen.o.d ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o.d ${OBJECTDIR}/_ext/581370467/application.o.d ${OBJECTDIR}/_ext/1472/CO_OD.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/_ext/851890637/CO_driver.o ${OBJECTDIR}/_ext/851890637/eeprom.o ${OBJECTDIR}/_ext/851890637/main_generic.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/581370467/application.o ${OBJECTDIR}/_ext/1472/CO_OD.o
+OBJECTFILES=${OBJECTDIR}/_ext/851890637/CO_driver.o ${OBJECTDIR}/_ext/851890637/eeprom.o ${OBJECTDIR}/_ext/851890637/main_generic.o ${OBJECTDIR}/_ext/581370467/CO_Emergency.o ${OBJECTDIR}/_ext/581370467/CO_HBconsumer.o ${OBJECTDIR}/_ext/581370467/CO_NMT_Heartbeat.o ${OBJECTDIR}/_ext/581370467/CO_PDO.o ${OBJECTDIR}/_ext/581370467/CO_SDO.o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o ${OBJECTDIR}/_ext/581370467/CO_timer.o ${OBJECTDIR}/_ext/581370467/CANopen.o ${OBJECTDIR}/_ext/581370467/crc16-ccitt.o ${OBJECTDIR}/_ext/581370467/application.o ${OBJECTDIR}/_ext/1472/CO_OD.o
 
 
 CFLAGS=
@@ -127,6 +127,12 @@ ${OBJECTDIR}/_ext/581370467/CO_SYNC.o: ../../CANopen_stack/CO_SYNC.c  nbproject/
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../../CANopen_stack/CO_SYNC.c  -o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d"      -g -D__DEBUG   -omf=elf -O1 -I"../../CANopen_stack/genericDriver" -I"../../CANopen_stack" -I".." -msmart-io=1 -Wall -msfr-warn=off
 	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/581370467/CO_timer.o: ../../CANopen_stack/CO_timer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
+	@${RM} ${OBJECTDIR}/_ext/581370467/CO_timer.o.d 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../../CANopen_stack/CO_timer.c  -o ${OBJECTDIR}/_ext/581370467/CO_timer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_timer.o.d"      -g -D__DEBUG   -omf=elf -O1 -I"../../CANopen_stack/genericDriver" -I"../../CANopen_stack" -I".." -msmart-io=1 -Wall -msfr-warn=off
+	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_timer.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/581370467/CANopen.o: ../../CANopen_stack/CANopen.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
 	@${RM} ${OBJECTDIR}/_ext/581370467/CANopen.o.d 
@@ -206,6 +212,12 @@ ${OBJECTDIR}/_ext/581370467/CO_SYNC.o: ../../CANopen_stack/CO_SYNC.c  nbproject/
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../../CANopen_stack/CO_SYNC.c  -o ${OBJECTDIR}/_ext/581370467/CO_SYNC.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d"      -g -omf=elf -O1 -I"../../CANopen_stack/genericDriver" -I"../../CANopen_stack" -I".." -msmart-io=1 -Wall -msfr-warn=off
 	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_SYNC.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/581370467/CO_timer.o: ../../CANopen_stack/CO_timer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
+	@${RM} ${OBJECTDIR}/_ext/581370467/CO_timer.o.d 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../../CANopen_stack/CO_timer.c  -o ${OBJECTDIR}/_ext/581370467/CO_timer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/581370467/CO_timer.o.d"      -g -omf=elf -O1 -I"../../CANopen_stack/genericDriver" -I"../../CANopen_stack" -I".." -msmart-io=1 -Wall -msfr-warn=off
+	@${FIXDEPS} "${OBJECTDIR}/_ext/581370467/CO_timer.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/581370467/CANopen.o: ../../CANopen_stack/CANopen.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} ${OBJECTDIR}/_ext/581370467 
 	@${RM} ${OBJECTDIR}/_ext/581370467/CANopen.o.d 
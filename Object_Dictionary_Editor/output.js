@@ -42,6 +42,9 @@
                 //MCO
 		var CO_OD_C_functions = [];
 		var CO_OD_C_OD = [];
+		var CO_OD_C_ODindexVal = [];
+		var CO_OD_C_index = [];
+		var CO_OD_indexPages = 0;
 	//fileEDSspec
 		var EDSspec_info = [];
 		var EDSspec_optObj = ["SupportedObjects=xx"];
@@ -118,6 +121,11 @@ function generateFiles(){
 	calculateDeviceIdentity();
 	calculateFeatures();
 	calculateObjects();
+	if(!calculateODindex()){
+		//direct index would find wrong objects, don't generate anything
+		g_openerWindow.source.postMessage("XDD"+"Output files are NOT generated:\n\n" + errorMessages.join("\n"), "*");
+		return;
+	}
 
 	//generate final outputs
 	generateCO_OD_H();
@@ -513,6 +521,7 @@ function calculateObjects(){
 					}
                var varPtr = "(void*)&CO"+ODfileNameReference+"_OD_"+memoryType+"."+nameNoSpace+combinedObjects[index].curentCount+arrayType;
                if (dataType=="0F") varPtr = "0";   //DOMAIN data type
+					CO_OD_C_ODindexVal.push(indexVal);
 					CO_OD_C_OD.push("{0x"+index+", 0x00, 0x"+g_byteToHexString(attribute)+", "+defaultValueMemorySize+", "+
                                     varPtr+"},");
 //													indent(varPtr+", ", 63)+accessFunctionName+"},");
@@ -596,6 +605,7 @@ function calculateObjects(){
 					}
                var varPtr = "(void*)&CO"+ODfileNameReference+"_OD_"+memoryType+"."+nameNoSpace+combinedObjects[index].curentCount+arrayType;
                if (dataType=="0F") varPtr = "0";   //DOMAIN data type
+					CO_OD_C_ODindexVal.push(indexVal);
 					CO_OD_C_OD.push("{0x"+index+", 0x"+g_byteToHexString(subNumberVal-1)+", 0x"+g_byteToHexString(attribute)+", "+subDefaultValueMemorySize+", "+
                                     varPtr+"},");
 //													indent(varPtr+", ", 49)+accessFunctionName+"},");
@@ -694,6 +704,7 @@ function calculateObjects(){
 					CO_OD_C_records.push(subStructure.join(",\n") + "};");
 
 					//put object into Object Dictionary
+					CO_OD_C_ODindexVal.push(indexVal);
 					CO_OD_C_OD.push("{0x"+index+", 0x"+g_byteToHexString(subNumberVal-1)+", 0x00,  0, (void*)&"+
 													"OD"+ODfileNameReference+"_record"+index+"},");
 //													indent("OD"+ODfileNameReference+"_record"+index+", ", 49)+accessFunctionName+"},");
@@ -1294,6 +1305,65 @@ function extractLabels(element){
 	return output;
 }
 
+//Calculate direct index table for CO_OD_find(). Object Dictionary is divided
+//into pages by high byte of index. For each used page there is table with
+//entry number of each index or 0xFFFF, if object does not exist.
+//Returns false, if index can not be generated.
+function calculateODindex(){
+	var pageOf = [];
+	var pages = [];
+	var valid = true;
+	var i, j;
+
+	for(i=0; i<256; i++) pageOf.push(0xFF);
+
+	for(i=0; i<CO_OD_C_ODindexVal.length; i++){
+		var indexVal = CO_OD_C_ODindexVal[i];
+		if(i>0 && indexVal <= CO_OD_C_ODindexVal[i-1]){
+			errorMessages.push("Error in object " + g_wordToHexString(indexVal) + ": Objects must be sorted by index!");
+			valid = false;
+		}
+		var high = indexVal >> 8;
+		if(pageOf[high] == 0xFF){
+			if(pages.length >= 255){
+				errorMessages.push("Error in object " + g_wordToHexString(indexVal) + ": Too many index pages!");
+				valid = false;
+				continue;
+			}
+			pageOf[high] = pages.length;
+			var entries = [];
+			for(j=0; j<256; j++) entries.push("0xFFFF");
+			pages.push({high: high, entries: entries});
+		}
+		pages[pageOf[high]].entries[indexVal & 0xFF] = "0x" + g_wordToHexString(i);
+	}
+	if(!valid) return false;
+	CO_OD_indexPages = pages.length;
+
+	var line;
+	CO_OD_C_index.push("static const uint8_t CO"+ODfileNameReference+"_OD_indexPage[256] = {");
+	for(i=0; i<256; i+=16){
+		line = [];
+		for(j=i; j<i+16; j++) line.push("0x" + g_byteToHexString(pageOf[j]));
+		CO_OD_C_index.push("    " + line.join(", ") + ",");
+	}
+	CO_OD_C_index.push("};\n");
+
+	CO_OD_C_index.push("static const uint16_t CO"+ODfileNameReference+"_OD_indexEntryNo[CO"+ODfileNameReference+"_OD_INDEX_PAGES][256] = {");
+	for(i=0; i<pages.length; i++){
+		CO_OD_C_index.push("  { /*0x" + g_byteToHexString(pages[i].high) + "xx*/");
+		for(j=0; j<256; j+=16){
+			CO_OD_C_index.push("    " + pages[i].entries.slice(j, j+16).join(", ") + ",");
+		}
+		CO_OD_C_index.push("  },");
+	}
+	CO_OD_C_index.push("};\n");
+
+	CO_OD_C_index.push("const CO_ODindex_t CO"+ODfileNameReference+"_OD_index = {CO"+ODfileNameReference+"_OD_indexPage, CO"+ODfileNameReference+"_OD_indexEntryNo};");
+	return true;
+}
+
+
 function generateCO_OD_H(){
 	var text = "ODH"+
 		"/*******************************************************************************\n"+
@@ -1380,6 +1450,7 @@ function generateCO_OD_H(){
 		"   OBJECT DICTIONARY\n"+
 		"*******************************************************************************/\n"+
 		"   #define CO"+ODfileNameReference+"_OD_NoOfElements             "+CO_OD_C_OD.length.toString()+"\n"+
+		"   #define CO"+ODfileNameReference+"_OD_INDEX_PAGES              "+CO_OD_indexPages.toString()+"\n"+
 		"\n"+
 		"\n"+
 		"/*******************************************************************************\n"+
@@ -1537,7 +1608,13 @@ function generateCO_OD_C(){
 		"*******************************************************************************/\n"+
 		"const CO_OD_entry_t CO"+ODfileNameReference+"_OD[CO"+ODfileNameReference+"_OD_NoOfElements] = {\n"+
 		CO_OD_C_OD.join("\n")+"\n"+
-		"};\n";
+		"};\n"+
+		"\n"+
+		"\n"+
+		"/*******************************************************************************\n"+
+		"   OBJECT DICTIONARY INDEX (used by CO_OD_find)\n"+
+		"*******************************************************************************/\n"+
+		CO_OD_C_index.join("\n")+"\n";
 
 		g_openerWindow.source.postMessage(text, "*");
 }
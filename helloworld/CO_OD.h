@@ -80,17 +80,18 @@
 *******************************************************************************/
    #define CO_NO_SYNC                     1   //Associated objects: 1005, 1006, 1007, 2103, 2104
    #define CO_NO_EMERGENCY                1   //Associated objects: 1014, 1015
-   #define CO_NO_SDO_SERVER               1   //Associated objects: 1200
+   #define CO_NO_SDO_SERVER               4   //Associated objects: 1200, 1201, 1202, 1203
    #define CO_NO_SDO_CLIENT               0
-   #define CO_NO_RPDO                     4   //Associated objects: 1400, 1401, 1402, 1403, 1600, 1601, 1602, 1603
-   #define CO_NO_TPDO                     4   //Associated objects: 1800, 1801, 1802, 1803, 1A00, 1A01, 1A02, 1A03
+   #define CO_NO_RPDO                     4   //Associated objects: 1400, 1401, 1402, 1403, 1600, 1601, 1602, 1603, 1FD0, 2105
+   #define CO_NO_TPDO                     4   //Associated objects: 1800, 1801, 1802, 1803, 1A00, 1A01, 1A02, 1A03, 1FA0
    #define CO_NO_NMT_MASTER               0
 
 
 /*******************************************************************************
    OBJECT DICTIONARY
 *******************************************************************************/
-   #define CO_OD_NoOfElements             54
+   #define CO_OD_NoOfElements             60
+   #define CO_OD_INDEX_PAGES              11
 
 
 /*******************************************************************************
@@ -104,10 +105,11 @@
                UNSIGNED32     serialNumber;
                }              OD_identity_t;
 
-/*1200[1]   */ typedef struct{
+/*1200[4]   */ typedef struct{
                UNSIGNED8      maxSubIndex;
                UNSIGNED32     COB_IDClientToServer;
                UNSIGNED32     COB_IDServerToClient;
+               UNSIGNED8      nodeIDOfSDOClient;
                }              OD_SDOServerParameter_t;
 
 /*1400[4]   */ typedef struct{
@@ -177,6 +179,7 @@ struct sCO_OD_RAM{
 /*2100      */ OCTET_STRING   errorStatusBits[10];
 /*2103      */ UNSIGNED16     SYNCCounter;
 /*2104      */ UNSIGNED16     SYNCTime;
+/*2105      */ UNSIGNED32     RPDOOverflowCounter[4];
 /*2107      */ UNSIGNED16     performance[5];
 /*2108      */ INTEGER16      temperature[1];
 /*2109      */ INTEGER16      voltage[1];
@@ -219,12 +222,14 @@ struct sCO_OD_ROM{
 /*1018      */ OD_identity_t  identity;
 /*1019      */ UNSIGNED8      synchronousCounterOverflowValue;
 /*1029      */ UNSIGNED8      errorBehavior[6];
-/*1200[1]   */ OD_SDOServerParameter_t SDOServerParameter[1];
+/*1200[4]   */ OD_SDOServerParameter_t SDOServerParameter[4];
 /*1400[4]   */ OD_RPDOCommunicationParameter_t RPDOCommunicationParameter[4];
 /*1600[4]   */ OD_RPDOMappingParameter_t RPDOMappingParameter[4];
 /*1800[4]   */ OD_TPDOCommunicationParameter_t TPDOCommunicationParameter[4];
 /*1A00[4]   */ OD_TPDOMappingParameter_t TPDOMappingParameter[4];
 /*1F80      */ UNSIGNED32     NMTStartup;
+/*1FA0      */ UNSIGNED32     objectScannerList[8];
+/*1FD0      */ UNSIGNED64     objectDispatcherList[8];
 /*2101      */ UNSIGNED8      CANNodeID;
 /*2102      */ UNSIGNED16     CANBitRate;
 /*2111      */ INTEGER32      variableROMInt32[16];
@@ -317,7 +322,7 @@ extern struct sCO_OD_ROM CO_OD_ROM;
       #define ODA_errorBehavior_deviceProfile            4
       #define ODA_errorBehavior_manufacturerSpecific     5
 
-/*1200[1], Data Type: OD_SDOServerParameter_t, Array[1] */
+/*1200[4], Data Type: OD_SDOServerParameter_t, Array[4] */
       #define OD_SDOServerParameter                      CO_OD_ROM.SDOServerParameter
 
 /*1400[4], Data Type: OD_RPDOCommunicationParameter_t, Array[4] */
@@ -335,6 +340,14 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 /*1F80, Data Type: UNSIGNED32 */
       #define OD_NMTStartup                              CO_OD_ROM.NMTStartup
 
+/*1FA0, Data Type: UNSIGNED32, Array[8] */
+      #define OD_objectScannerList                       CO_OD_ROM.objectScannerList
+      #define ODL_objectScannerList_arrayLength          8
+
+/*1FD0, Data Type: UNSIGNED64, Array[8] */
+      #define OD_objectDispatcherList                    CO_OD_ROM.objectDispatcherList
+      #define ODL_objectDispatcherList_arrayLength       8
+
 /*2100, Data Type: OCTET_STRING, Array[10] */
       #define OD_errorStatusBits                         CO_OD_RAM.errorStatusBits
       #define ODL_errorStatusBits_stringLength           10
@@ -351,6 +364,10 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 /*2104, Data Type: UNSIGNED16 */
       #define OD_SYNCTime                                CO_OD_RAM.SYNCTime
 
+/*2105, Data Type: UNSIGNED32, Array[4] */
+      #define OD_RPDOOverflowCounter                     CO_OD_RAM.RPDOOverflowCounter
+      #define ODL_RPDOOverflowCounter_arrayLength        4
+
 /*2106, Data Type: UNSIGNED32 */
       #define OD_powerOnCounter                          CO_OD_EEPROM.powerOnCounter
 
@@ -28,10 +28,391 @@
  */
 
 
+#define _GNU_SOURCE         /* recvmmsg */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
 #include "CO_driver.h"
 #include "CO_Emergency.h"
 
 
+/* Maximum number of CAN_RAW_FILTER entries, accepted by the kernel */
+#ifndef CAN_RAW_FILTER_MAX
+    #define CAN_RAW_FILTER_MAX  512U
+#endif
+
+/* Number of bytes, passed to the kernel for the frame */
+#ifdef CO_CAN_FD
+    #define CO_CAN_FRAME_MTU(frame) (((frame)->len > CAN_MAX_DLEN) ? CANFD_MTU : CAN_MTU)
+#else
+    #define CO_CAN_FRAME_MTU(frame) CAN_MTU
+#endif
+
+#if (CO_CAN_RX_RING_SIZE & (CO_CAN_RX_RING_SIZE - 1U)) != 0U
+    #error CO_CAN_RX_RING_SIZE must be power of two
+#endif
+
+/* Received and transmitted messages are exchanged with the kernel in place */
+_Static_assert(offsetof(CO_CANrxMsg_t, ident) == offsetof(CO_CANframe_t, can_id), "CO_CANrxMsg_t layout");
+_Static_assert(offsetof(CO_CANrxMsg_t, DLC) == offsetof(CO_CANframe_t, len), "CO_CANrxMsg_t layout");
+_Static_assert(offsetof(CO_CANrxMsg_t, data) == offsetof(CO_CANframe_t, data), "CO_CANrxMsg_t layout");
+_Static_assert(sizeof(((CO_CANrxMsg_t*)0)->data) == sizeof(((CO_CANframe_t*)0)->data), "CO_CANrxMsg_t layout");
+_Static_assert(offsetof(CO_CANtx_t, ident) == offsetof(CO_CANframe_t, can_id), "CO_CANtx_t layout");
+_Static_assert(offsetof(CO_CANtx_t, DLC) == offsetof(CO_CANframe_t, len), "CO_CANtx_t layout");
+_Static_assert(offsetof(CO_CANtx_t, data) == offsetof(CO_CANframe_t, data), "CO_CANtx_t layout");
+_Static_assert(sizeof(((CO_CANtx_t*)0)->data) == sizeof(((CO_CANframe_t*)0)->data), "CO_CANtx_t layout");
+
+
+int CO_CANsocket[4] = {-1, -1, -1, -1};
+int CO_CANtestMode = 0;
+
+
+/*
+ * Mark transmit object as ready in the scheduler. Its key must be set.
+ */
+static void CO_CANtxReadyInsert(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    uint16_t cls = buffer->syncFlag ? 1U : 0U;
+    uint16_t key = buffer->key;
+    uint32_t bit = 1UL << (key & 0x1FU);
+
+    if((CANmodule->txReady[cls][key >> 5] & bit) == 0U){
+        CANmodule->txReady[cls][key >> 5] |= bit;
+        CANmodule->txReadySummary[cls][key >> 10] |= 1UL << ((key >> 5) & 0x1FU);
+        buffer->next = CO_CAN_RX_INDEX_NONE;
+    }
+    else{
+        buffer->next = CANmodule->txReadyFirst[cls][key];
+    }
+    CANmodule->txReadyFirst[cls][key] = (uint16_t)(buffer - CANmodule->txArray);
+}
+
+
+/*
+ * Remove transmit object from the scheduler.
+ */
+static void CO_CANtxReadyRemove(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    uint16_t cls = buffer->syncFlag ? 1U : 0U;
+    uint16_t key = buffer->key;
+    uint16_t index = (uint16_t)(buffer - CANmodule->txArray);
+    uint16_t *link = &CANmodule->txReadyFirst[cls][key];
+
+    if((CANmodule->txReady[cls][key >> 5] & (1UL << (key & 0x1FU))) == 0U){
+        return;
+    }
+    while(*link != CO_CAN_RX_INDEX_NONE){
+        if(*link == index){
+            *link = buffer->next;
+            break;
+        }
+        link = &CANmodule->txArray[*link].next;
+    }
+    if(CANmodule->txReadyFirst[cls][key] == CO_CAN_RX_INDEX_NONE){
+        CANmodule->txReady[cls][key >> 5] &= ~(1UL << (key & 0x1FU));
+        if(CANmodule->txReady[cls][key >> 5] == 0U){
+            CANmodule->txReadySummary[cls][key >> 10] &= ~(1UL << ((key >> 5) & 0x1FU));
+        }
+    }
+}
+
+
+/*
+ * Find the lowest ready key of one class. Returns CO_CAN_TX_KEYS, if none.
+ */
+static uint16_t CO_CANtxReadyLowest(const CO_CANmodule_t *CANmodule, uint16_t cls){
+    uint16_t i;
+
+    for(i=0U; i<(CO_CAN_TX_KEYS / 1024U); i++){
+        uint32_t summary = CANmodule->txReadySummary[cls][i];
+        if(summary != 0U){
+            uint16_t word = (uint16_t)((i << 5) + (uint16_t)__builtin_ctz(summary));
+            return (uint16_t)((word << 5) + (uint16_t)__builtin_ctz(CANmodule->txReady[cls][word]));
+        }
+    }
+
+    return CO_CAN_TX_KEYS;
+}
+
+
+/*
+ * Discard queued messages of synchronous object, if they were purged by
+ * CO_CANclearPendingSyncPDOs().
+ */
+static void CO_CANtxSyncRevalidate(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    if(buffer->syncFlag && (buffer->epoch != CANmodule->txSyncEpoch)){
+        buffer->queueCount = 0U;
+        CO_FLAG_CLEAR(buffer->bufferFull);
+        buffer->epoch = CANmodule->txSyncEpoch;
+    }
+}
+
+
+/*
+ * Take the oldest message from the ready object with the lowest key. Returns
+ * NULL, if nothing is queued. _frame_ points into the object queue, where
+ * message stays until it is overwritten by CO_CANsend().
+ */
+static CO_CANtx_t *CO_CANtxPop(CO_CANmodule_t *CANmodule, CO_CANframe_t **frame){
+    uint16_t key0 = CO_CANtxReadyLowest(CANmodule, 0U);
+    uint16_t key1 = CO_CANtxReadyLowest(CANmodule, 1U);
+    uint16_t cls = (key1 < key0) ? 1U : 0U;
+    uint16_t key = (cls != 0U) ? key1 : key0;
+    CO_CANtx_t *buffer;
+
+    if(key >= CO_CAN_TX_KEYS){
+        return NULL;
+    }
+    buffer = &CANmodule->txArray[CANmodule->txReadyFirst[cls][key]];
+    *frame = &buffer->queue[buffer->queueFirst];
+    buffer->queueFirst = (uint8_t)((buffer->queueFirst + 1U) % CO_CAN_TX_DEPTH);
+    buffer->queueCount--;
+    CO_FLAG_CLEAR(buffer->bufferFull);
+    if(buffer->queueCount == 0U){
+        CO_CANtxReadyRemove(CANmodule, buffer);
+    }
+    CANmodule->CANtxCount--;
+    if(cls != 0U){
+        CANmodule->txSyncCount--;
+    }
+
+    return buffer;
+}
+
+
+/*
+ * Return message, which was not accepted by the kernel, to the front of its
+ * object queue. Message is still there, messages are returned in reverse
+ * order of CO_CANtxPop().
+ */
+static void CO_CANtxPushBack(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    if(buffer->queueCount == 0U){
+        CO_CANtxReadyInsert(CANmodule, buffer);
+    }
+    buffer->queueFirst = (uint8_t)((buffer->queueFirst + CO_CAN_TX_DEPTH - 1U) % CO_CAN_TX_DEPTH);
+    buffer->queueCount++;
+    if(buffer->queueCount >= buffer->queueDepth){
+        CO_FLAG_SET(buffer->bufferFull);
+    }
+    CANmodule->CANtxCount++;
+    if(buffer->syncFlag){
+        CANmodule->txSyncCount++;
+    }
+}
+
+
+#ifdef CO_CAN_FD
+/*
+ * Round number of data bytes up to the length, which can be encoded in CAN FD
+ * frame: 0 to 8, 12, 16, 20, 24, 32, 48 or 64.
+ */
+static uint8_t CO_CANfdLength(uint8_t len){
+    if(len <= 8U){
+        return len;
+    }
+    if(len <= 24U){
+        return (uint8_t)((len + 3U) & ~3U);
+    }
+    if(len <= 32U){
+        return 32U;
+    }
+    return (len <= 48U) ? 48U : 64U;
+}
+#endif
+
+
+/*
+ * Add filters for a run of consecutive identifiers. Run is split into the
+ * largest blocks, which are aligned to power of two, so each block is
+ * covered by single identifier and mask.
+ */
+static uint16_t CO_CANrxFilterAddRun(
+        struct can_filter      *filters,
+        uint16_t                count,
+        uint16_t                first,
+        uint16_t                last,
+        canid_t                 rtr)
+{
+    while(first <= last){
+        uint16_t size = 1U;
+
+        while(((first & ((size << 1) - 1U)) == 0U) && ((first + (size << 1) - 1U) <= last) && (size < 0x800U)){
+            size <<= 1;
+        }
+        if(count < CAN_RAW_FILTER_MAX){
+            filters[count].can_id = first | rtr;
+            filters[count].can_mask = (CAN_SFF_MASK & ~(canid_t)(size - 1U)) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+        }
+        count++;
+        first += size;
+    }
+
+    return count;
+}
+
+
+/*
+ * Build kernel filter from rxArray and own transmit identifiers (for loopback
+ * confirmation) and apply it with CAN_RAW_FILTER socket option. Exact
+ * identifiers are collected into bitmap, which sorts and merges them into
+ * runs. If there are more than CAN_RAW_FILTER_MAX filters, all messages are
+ * received.
+ */
+static void CO_CANrxFilterApply(CO_CANmodule_t *CANmodule){
+    struct can_filter filters[CAN_RAW_FILTER_MAX];  /* on stack, not shared by CAN modules */
+    uint32_t exact[2][CO_CAN_RX_INDEX_SIZE / 32U];  /* data and RTR identifiers */
+    uint16_t count = 0U;
+    uint16_t i;
+    int ret;
+
+    memset(exact, 0, sizeof(exact));
+    for(i=0U; i<CANmodule->rxSize; i++){
+        const CO_CANrx_t *buffer = &CANmodule->rxArray[i];
+
+        if(buffer->pFunct == NULL){
+            continue;
+        }
+        if((buffer->mask & 0x07FFU) == 0x07FFU){
+            uint16_t ident = buffer->ident & 0x07FFU;
+            exact[(buffer->ident >> 11) & 1U][ident >> 5] |= 1UL << (ident & 0x1FU);
+        }
+        else{
+            if(count < CAN_RAW_FILTER_MAX){
+                filters[count].can_id = (buffer->ident & 0x07FFU) | (((buffer->ident & 0x0800U) != 0U) ? CAN_RTR_FLAG : 0U);
+                filters[count].can_mask = (buffer->mask & 0x07FFU) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+            }
+            count++;
+        }
+    }
+    for(i=0U; i<CANmodule->txSize; i++){
+        uint16_t ident = (uint16_t)CANmodule->txArray[i].ident & CAN_SFF_MASK;
+        exact[((CANmodule->txArray[i].ident & CAN_RTR_FLAG) != 0U) ? 1U : 0U][ident >> 5] |= 1UL << (ident & 0x1FU);
+    }
+
+    for(i=0U; i<2U; i++){
+        uint16_t id = 0U;
+
+        while(id < CO_CAN_RX_INDEX_SIZE){
+            if((exact[i][id >> 5] & (1UL << (id & 0x1FU))) == 0U){
+                id++;
+            }
+            else{
+                uint16_t first = id;
+                while((id < CO_CAN_RX_INDEX_SIZE) && ((exact[i][id >> 5] & (1UL << (id & 0x1FU))) != 0U)){
+                    id++;
+                }
+                count = CO_CANrxFilterAddRun(filters, count, first, id - 1U, (i != 0U) ? CAN_RTR_FLAG : 0U);
+            }
+        }
+    }
+
+    if(count <= CAN_RAW_FILTER_MAX){
+        ret = setsockopt((int)CANmodule->CANbaseAddress, SOL_CAN_RAW, CAN_RAW_FILTER,
+                         filters, count * sizeof(struct can_filter));
+    }
+    else{
+        ret = -1;
+    }
+    if(ret < 0){
+        /* receive all messages with standard identifier, rxArray will filter them */
+        struct can_filter all;
+        all.can_id = 0U;
+        all.can_mask = CAN_EFF_FLAG;
+        (void)setsockopt((int)CANmodule->CANbaseAddress, SOL_CAN_RAW, CAN_RAW_FILTER, &all, sizeof(all));
+        count = 0U;
+    }
+    CANmodule->rxFilterCount = count;
+    CANmodule->rxFilterChanged = CO_false;
+}
+
+
+/*
+ * Get the head of the dispatch chain, where buffer with given ident and mask
+ * belongs.
+ */
+static uint16_t *CO_CANrxChainHead(CO_CANmodule_t *CANmodule, uint16_t ident, uint16_t mask){
+    uint16_t *head;
+
+    if((mask & 0x07FFU) == 0x07FFU){
+        head = &CANmodule->rxIndex[ident & 0x07FFU];
+    }
+    else{
+        head = &CANmodule->rxMaskedFirst;
+    }
+
+    return head;
+}
+
+
+/*
+ * Remove configured buffer from its dispatch chain.
+ */
+static void CO_CANrxChainRemove(CO_CANmodule_t *CANmodule, uint16_t index){
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t *link = CO_CANrxChainHead(CANmodule, buffer->ident, buffer->mask);
+
+    while(*link != CO_CAN_RX_INDEX_NONE){
+        if(*link == index){
+            *link = buffer->next;
+            break;
+        }
+        link = &CANmodule->rxArray[*link].next;
+    }
+    buffer->next = CO_CAN_RX_INDEX_NONE;
+}
+
+
+/*
+ * Insert buffer into its dispatch chain. Chain is kept sorted by index, so
+ * the buffer with the lowest index takes precedence, as in linear search.
+ */
+static void CO_CANrxChainInsert(CO_CANmodule_t *CANmodule, uint16_t index){
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t *link = CO_CANrxChainHead(CANmodule, buffer->ident, buffer->mask);
+
+    while((*link != CO_CAN_RX_INDEX_NONE) && (*link < index)){
+        link = &CANmodule->rxArray[*link].next;
+    }
+    buffer->next = *link;
+    *link = index;
+}
+
+
+/*
+ * Find buffer for received message. Buffers with exact identifier are looked
+ * up directly, buffers with other masks are verified after that. Both chains
+ * are sorted by index, so masked buffers are only verified up to the exact
+ * match and the buffer with the lowest index wins, as with the linear search.
+ */
+static CO_CANrx_t *CO_CANrxFind(CO_CANmodule_t *CANmodule, uint16_t rcvMsgIdent){
+    uint16_t found = CANmodule->rxIndex[rcvMsgIdent & 0x07FFU];
+    uint16_t index;
+
+    while(found != CO_CAN_RX_INDEX_NONE){
+        CO_CANrx_t *buffer = &CANmodule->rxArray[found];
+        if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
+            break;
+        }
+        found = buffer->next;
+    }
+
+    /* CO_CAN_RX_INDEX_NONE is larger than any index */
+    for(index = CANmodule->rxMaskedFirst; index < found; index = CANmodule->rxArray[index].next){
+        CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+        if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
+            return buffer;
+        }
+    }
+
+    return (found != CO_CAN_RX_INDEX_NONE) ? &CANmodule->rxArray[found] : NULL;
+}
+
+
 /******************************************************************************/
 void CO_CANsetConfigurationMode(uint16_t CANbaseAddress){
 }
@@ -60,23 +441,80 @@ CO_ReturnError_t CO_CANmodule_init(
     CANmodule->rxSize = rxSize;
     CANmodule->txArray = txArray;
     CANmodule->txSize = txSize;
-    CANmodule->useCANrxFilters = CO_false; // (rxSize <= 32U) ? CO_true : CO_false;/* microcontroller dependent */
+    CANmodule->useCANrxFilters = CO_CANtestMode ? CO_false : CO_true;  /* kernel CAN_RAW_FILTER */
+    CANmodule->rxFilterChanged = CO_true;
+    CANmodule->rxFilterCount = 0U;
     CANmodule->bufferInhibitFlag = CO_false;
     CANmodule->firstCANtxMessage = CO_true;
     CANmodule->CANtxCount = 0U;
     CANmodule->errOld = 0U;
     CANmodule->em = NULL;
+    atomic_store(&CANmodule->rxStatistics.calls, 0U);
+    atomic_store(&CANmodule->rxStatistics.frames, 0U);
+    atomic_store(&CANmodule->rxStatistics.batchMax, 0U);
+    for(i=0U; i<CO_CAN_RX_HIST_SIZE; i++){
+        atomic_store(&CANmodule->rxStatistics.batchHist[i], 0U);
+    }
+    atomic_store(&CANmodule->rxStatistics.errors, 0U);
+    atomic_store(&CANmodule->rxStatistics.overflow, 0U);
+    memset(CANmodule->txReady, 0, sizeof(CANmodule->txReady));
+    memset(CANmodule->txReadySummary, 0, sizeof(CANmodule->txReadySummary));
+    CANmodule->txSyncCount = 0U;
+    CANmodule->txSyncEpoch = 0U;
+    CANmodule->txUnconfirmed = 0U;
+    memset(&CANmodule->txStatistics, 0, sizeof(CANmodule->txStatistics));
+    atomic_store(&CANmodule->rxRingHead, 0U);
+    atomic_store(&CANmodule->rxRingTail, 0U);
+    for(i=0U; i<CO_CAN_RX_INDEX_SIZE; i++){
+        CANmodule->rxIndex[i] = CO_CAN_RX_INDEX_NONE;
+    }
+    CANmodule->rxMaskedFirst = CO_CAN_RX_INDEX_NONE;
 
     for(i=0U; i<rxSize; i++){
         rxArray[i].ident = 0U;
+        rxArray[i].next = CO_CAN_RX_INDEX_NONE;
         rxArray[i].pFunct = NULL;
     }
     for(i=0U; i<txSize; i++){
-        txArray[i].bufferFull = CO_false;
+        txArray[i].ident = 0U;
+        CO_FLAG_CLEAR(txArray[i].bufferFull);
+        txArray[i].syncFlag = CO_false;
+        txArray[i].queueDepth = CO_CAN_TX_DEPTH;
+        txArray[i].queueCount = 0U;
     }
 
 
     /* Configure CAN module registers */
+    /* Socket is non-blocking, so CO_CANreceive() and CO_CANtxFlush() never
+     * wait. Own messages are looped back to confirm transmission. */
+    {
+        int flags = fcntl((int)CANbaseAddress, F_GETFL);
+        int recvOwn = 1;
+        if((flags < 0) || (fcntl((int)CANbaseAddress, F_SETFL, flags | O_NONBLOCK) < 0)){
+            return CO_ERROR_ILLEGAL_ARGUMENT;
+        }
+        if(!CO_CANtestMode && setsockopt((int)CANbaseAddress, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &recvOwn, sizeof(recvOwn)) < 0){
+            return CO_ERROR_ILLEGAL_ARGUMENT;
+        }
+    }
+
+#ifdef CO_CAN_FD
+    /* Interface must support CAN FD */
+    {
+        int enableFD = 1;
+        if(!CO_CANtestMode && setsockopt((int)CANbaseAddress, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableFD, sizeof(enableFD)) < 0){
+            return CO_ERROR_ILLEGAL_ARGUMENT;
+        }
+    }
+#endif
+
+    /* Reception timestamps: software always, hardware if enabled on the
+     * interface. Not fatal, timestamps are 0 if not supported. */
+    {
+        int tsFlags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+                    | SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        (void)setsockopt((int)CANbaseAddress, SOL_SOCKET, SO_TIMESTAMPING, &tsFlags, sizeof(tsFlags));
+    }
 
 
     /* Configure CAN timing */
@@ -84,16 +522,12 @@ CO_ReturnError_t CO_CANmodule_init(
 
     /* Configure CAN module hardware filters */
     if(CANmodule->useCANrxFilters){
-        /* CAN module filters are used, they will be configured with */
-        /* CO_CANrxBufferInit() functions, called by separate CANopen */
-        /* init functions. */
-        /* Configure all masks so, that received message must match filter */
-    }
-    else{
-        /* CAN module filters are not used, all messages with standard 11-bit */
-        /* identifier will be received */
-        /* Configure mask 0 so, that all messages with standard identifier are accepted */
-
+        /* Kernel filters are used, they will be built from rxArray and txArray
+         * after CO_CANrxBufferInit() and CO_CANtxBufferInit() functions, called
+         * by separate CANopen init functions. Until then receive nothing. */
+        if(setsockopt((int)CANbaseAddress, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0) < 0){
+            return CO_ERROR_ILLEGAL_ARGUMENT;
+        }
     }
 
 
@@ -112,7 +546,36 @@ void CO_CANmodule_disable(CO_CANmodule_t *CANmodule){
 
 /******************************************************************************/
 uint16_t CO_CANrxMsg_readIdent(const CO_CANrxMsg_t *rxMsg){
-    return (uint16_t) rxMsg->ident;
+    return (uint16_t) rxMsg->ident & CAN_SFF_MASK;
+}
+
+
+/******************************************************************************/
+CO_bool_t CO_CANrxMsg_readRTR(const CO_CANrxMsg_t *rxMsg){
+    return ((rxMsg->ident & CAN_RTR_FLAG) != 0U) ? CO_true : CO_false;
+}
+
+
+/******************************************************************************/
+uint8_t CO_CANrxMsg_readDLC(const CO_CANrxMsg_t *rxMsg){
+    return rxMsg->DLC;
+}
+
+
+/******************************************************************************/
+uint64_t CO_CANrxMsg_readTimestamp(const CO_CANrxMsg_t *rxMsg){
+    return rxMsg->timestamp;
+}
+
+
+/******************************************************************************/
+uint64_t CO_CANtimestampNow(void){
+    struct timespec ts;
+
+    /* Not affected by changes of the system time. Kernel timestamps are
+     * converted to this clock in CO_CANrxRead(). */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
 }
 
 
@@ -132,6 +595,12 @@ CO_ReturnError_t CO_CANrxBufferInit(
         /* buffer, which will be configured */
         CO_CANrx_t *buffer = &CANmodule->rxArray[index];
 
+        CO_DISABLE_INTERRUPTS();
+        /* Buffer may be reconfigured, remove it from dispatch index first */
+        if(buffer->pFunct != NULL){
+            CO_CANrxChainRemove(CANmodule, index);
+        }
+
         /* Configure object variables */
         buffer->object = object;
         buffer->pFunct = pFunct;
@@ -143,10 +612,11 @@ CO_ReturnError_t CO_CANrxBufferInit(
         }
         buffer->mask = (mask & 0x07FFU) | 0x0800U;
 
-        /* Set CAN hardware module filter and mask. */
-        if(CANmodule->useCANrxFilters){
+        CO_CANrxChainInsert(CANmodule, index);
+        CO_ENABLE_INTERRUPTS();
 
-        }
+        /* Kernel filter will be updated by CO_CANprocess(). */
+        CANmodule->rxFilterChanged = CO_true;
     }
     else{
         ret = CO_ERROR_ILLEGAL_ARGUMENT;
@@ -171,14 +641,38 @@ CO_CANtx_t *CO_CANtxBufferInit(
         /* get specific buffer */
         buffer = &CANmodule->txArray[index];
 
-        /* CAN identifier, DLC and rtr, bit aligned with CAN module transmit buffer.
-         * Microcontroller specific. */
-        buffer->ident = ((uint32_t)ident & 0x07FFU)
-                      | ((uint32_t)(((uint32_t)noOfBytes & 0xFU) << 12U))
-                      | ((uint32_t)(rtr ? 0x8000U : 0U));
+        /* discard messages, queued with previous configuration */
+        CO_DISABLE_INTERRUPTS();
+        CO_CANtxSyncRevalidate(CANmodule, buffer);
+        if(buffer->queueCount != 0U){
+            CO_CANtxReadyRemove(CANmodule, buffer);
+            CANmodule->CANtxCount -= buffer->queueCount;
+            if(buffer->syncFlag){
+                CANmodule->txSyncCount -= buffer->queueCount;
+            }
+            buffer->queueCount = 0U;
+        }
+        CO_ENABLE_INTERRUPTS();
 
-        buffer->bufferFull = CO_false;
+        /* CAN identifier and rtr, bit aligned with CAN module transmit buffer.
+         * Microcontroller specific. */
+        buffer->ident = ((uint32_t)ident & CAN_SFF_MASK)
+                      | (rtr ? CAN_RTR_FLAG : 0U);
+        buffer->DLC = (noOfBytes <= CO_CAN_DATA_MAX) ? noOfBytes : CO_CAN_DATA_MAX;
+        buffer->flags = 0U;
+        buffer->reserved[0] = 0U;
+        buffer->reserved[1] = 0U;
+        /* padding bytes of CAN FD frame are zero */
+        memset(buffer->data, 0, sizeof(buffer->data));
+
+        CO_FLAG_CLEAR(buffer->bufferFull);
         buffer->syncFlag = syncFlag;
+        buffer->queueDepth = CO_CAN_TX_DEPTH;
+        buffer->queueFirst = 0U;
+        buffer->epoch = CANmodule->txSyncEpoch;
+
+        /* Own messages must pass kernel filter for transmit confirmation. */
+        CANmodule->rxFilterChanged = CO_true;
     }
 
     return buffer;
@@ -188,26 +682,49 @@ CO_CANtx_t *CO_CANtxBufferInit(
 /******************************************************************************/
 CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
     CO_ReturnError_t err = CO_ERROR_NO;
+    CO_CANframe_t *frame;
+
+    CO_DISABLE_INTERRUPTS();
+    CO_CANtxSyncRevalidate(CANmodule, buffer);
 
     /* Verify overflow */
-    if(buffer->bufferFull){
+    if(buffer->queueCount >= buffer->queueDepth){
         if(!CANmodule->firstCANtxMessage){
             /* don't set error, if bootup message is still on buffers */
             CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_TX_OVERFLOW, CO_EMC_CAN_OVERRUN, buffer->ident);
         }
         err = CO_ERROR_TX_OVERFLOW;
-    }
 
-    CO_DISABLE_INTERRUPTS();
-    /* if CAN TX buffer is free, copy message to it */
-    if(1 && CANmodule->CANtxCount == 0){
-        CANmodule->bufferInhibitFlag = buffer->syncFlag;
-        /* copy message and txRequest */
+        /* overwrite the newest message */
+        frame = &buffer->queue[(buffer->queueFirst + buffer->queueCount - 1U) % CO_CAN_TX_DEPTH];
     }
-    /* if no buffer is free, message will be sent by interrupt */
     else{
-        buffer->bufferFull = CO_true;
+        if(buffer->queueCount == 0U){
+            buffer->key = (uint16_t)(((buffer->ident & CAN_SFF_MASK) << 1) | (((buffer->ident & CAN_RTR_FLAG) != 0U) ? 1U : 0U));
+            CO_CANtxReadyInsert(CANmodule, buffer);
+        }
+        frame = &buffer->queue[(buffer->queueFirst + buffer->queueCount) % CO_CAN_TX_DEPTH];
+        buffer->queueCount++;
         CANmodule->CANtxCount++;
+        if(buffer->syncFlag){
+            CANmodule->txSyncCount++;
+        }
+    }
+
+    /* copy message, buffer begins with the frame */
+#ifdef CO_CAN_FD
+    buffer->flags = (buffer->DLC > CAN_MAX_DLEN) ? CO_CAN_FD_FLAGS : 0U;
+    memcpy(frame, buffer, sizeof(*frame));
+    frame->len = CO_CANfdLength(buffer->DLC);
+#else
+    memcpy(frame, buffer, sizeof(*frame));
+#endif
+
+    if(buffer->queueCount >= buffer->queueDepth){
+        CO_FLAG_SET(buffer->bufferFull);
+    }
+    else{
+        CO_FLAG_CLEAR(buffer->bufferFull);
     }
     CO_ENABLE_INTERRUPTS();
 
@@ -220,27 +737,16 @@ void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule){
     uint32_t tpdoDeleted = 0U;
 
     CO_DISABLE_INTERRUPTS();
-    /* Abort message from CAN module, if there is synchronous TPDO.
-     * Take special care with this functionality. */
-    if(/*messageIsOnCanBuffer && */CANmodule->bufferInhibitFlag){
-        /* clear TXREQ */
-        CANmodule->bufferInhibitFlag = CO_false;
-        tpdoDeleted = 1U;
-    }
-    /* delete also pending synchronous TPDOs in TX buffers */
-    if(CANmodule->CANtxCount != 0U){
-        uint16_t i;
-        CO_CANtx_t *buffer = &CANmodule->txArray[0];
-        for(i = CANmodule->txSize; i > 0U; i--){
-            if(buffer->bufferFull){
-                if(buffer->syncFlag){
-                    buffer->bufferFull = CO_false;
-                    CANmodule->CANtxCount--;
-                    tpdoDeleted = 2U;
-                }
-            }
-            buffer++;
-        }
+    /* Messages, already passed to the kernel, can not be aborted. Discard
+     * queued synchronous TPDOs: clear their scheduler class and invalidate
+     * their object queues with new epoch. */
+    if(CANmodule->txSyncCount != 0U){
+        CANmodule->CANtxCount -= CANmodule->txSyncCount;
+        CANmodule->txSyncCount = 0U;
+        CANmodule->txSyncEpoch++;
+        memset(CANmodule->txReady[1], 0, sizeof(CANmodule->txReady[1]));
+        memset(CANmodule->txReadySummary[1], 0, sizeof(CANmodule->txReadySummary[1]));
+        tpdoDeleted = 2U;
     }
     CO_ENABLE_INTERRUPTS();
 
@@ -257,11 +763,11 @@ void CO_CANverifyErrors(CO_CANmodule_t *CANmodule){
     CO_EM_t* em = (CO_EM_t*)CANmodule->em;
     uint32_t err;
 
-    /* get error counters from module. Id possible, function may use different way to
-     * determine errors. */
-    rxErrors = CANmodule->txSize;
-    txErrors = CANmodule->txSize;
-    overflow = CANmodule->txSize;
+    /* socketCAN reports bus errors only with error frames, which are not
+     * received here, so only overflow of the receive ring is verified. */
+    rxErrors = 0U;
+    txErrors = 0U;
+    overflow = (atomic_load_explicit(&CANmodule->rxStatistics.overflow, memory_order_relaxed) != 0U) ? 1U : 0U;
 
     err = ((uint32_t)txErrors << 16) | ((uint32_t)rxErrors << 8) | overflow;
 
@@ -312,172 +818,312 @@ void CO_CANverifyErrors(CO_CANmodule_t *CANmodule){
 
 /******************************************************************************/
 void CO_CANProcessRxFrame(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg){
+    uint32_t rcvMsgIdent;       /* identifier of the received message */
+    CO_CANrx_t *buffer = NULL;  /* receive message buffer from CO_CANmodule_t object. */
+    CO_bool_t msgMatched = CO_false;
+
+    /* Kernel filters only reduce number of received messages, they don't
+     * identify the buffer. Find the same CAN-ID in dispatch index from CANmodule. */
+    rcvMsgIdent = rcvMsg->ident & CAN_SFF_MASK;
+    if((rcvMsg->ident & CAN_RTR_FLAG) != 0U){
+        rcvMsgIdent |= 0x0800U;
+    }
+    buffer = CO_CANrxFind(CANmodule, (uint16_t)rcvMsgIdent);
+    if(buffer != NULL){
+        msgMatched = CO_true;
+    }
 
-    /* receive interrupt */
-    if(1){
-	//        CO_CANrxMsg_t *rcvMsg;      /* pointer to received message in CAN module */
-        uint16_t index;             /* index of received message */
-        uint32_t rcvMsgIdent;       /* identifier of the received message */
-        CO_CANrx_t *buffer = NULL;  /* receive message buffer from CO_CANmodule_t object. */
-        CO_bool_t msgMatched = CO_false;
-
-        // rcvMsg = 0; /* get message from module here */
-        rcvMsgIdent = rcvMsg->ident;
-        if(CANmodule->useCANrxFilters){
-            /* CAN module filters are used. Message with known 11-bit identifier has */
-            /* been received */
-            index = 0;  /* get index of the received message here. Or something similar */
-            if(index < CANmodule->rxSize){
-                buffer = &CANmodule->rxArray[index];
-                /* verify also RTR */
-                if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
-                    msgMatched = CO_true;
-                }
-            }
+    /* Call specific function, which will process the message */
+    if(msgMatched && (buffer != NULL) && (buffer->pFunct != NULL)){
+        buffer->pFunct(buffer->object, rcvMsg);
+    }
+}
+
+
+/*
+ * Read batch of messages from socket.
+ *
+ * Up to _count_ messages are read with single recvmmsg() call directly into
+ * _entries_, CO_CANrxMsg_t has the layout of the frame. Messages with extended
+ * identifier and error messages are skipped, following entries are moved
+ * down. Function is used by CO_CANreceive() and CO_CANrxThreadReceive().
+ *
+ * @return Number of entries or -1 on socket error.
+ */
+static int32_t CO_CANrxRead(CO_CANmodule_t *CANmodule, CO_CANrxRingEntry_t entries[], uint16_t count){
+    struct iovec iov[CO_CAN_RX_BATCH];
+    struct mmsghdr msgs[CO_CAN_RX_BATCH];
+    /* room for SCM_TIMESTAMPING control message */
+    union{
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(sizeof(struct scm_timestamping))];
+    }control[CO_CAN_RX_BATCH];
+    CO_CANrxStatistics_t *stat = &CANmodule->rxStatistics;
+    uint64_t realtimeOffset = 0U;
+    int n, i;
+    int32_t cnt = 0;
+
+    if(count > CO_CAN_RX_BATCH){
+        count = CO_CAN_RX_BATCH;
+    }
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for(i=0; i<(int)count; i++){
+        iov[i].iov_base = &entries[i].msg;
+        iov[i].iov_len = sizeof(CO_CANframe_t);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = &control[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+    }
+
+    n = recvmmsg((int)CANmodule->CANbaseAddress, msgs, count, MSG_DONTWAIT, NULL);
+    if(n < 0){
+        if((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)){
+            return 0;
         }
-        else{
-            /* CAN module filters are not used, message with any standard 11-bit identifier */
-            /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-            buffer = &CANmodule->rxArray[0];
-            for(index = CANmodule->rxSize; index > 0U; index--){
-                if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
-                    msgMatched = CO_true;
-                    break;
+        atomic_fetch_add_explicit(&stat->errors, 1U, memory_order_relaxed);
+        return -1;
+    }
+    if(n > 0){
+        unsigned batch = (unsigned)n;
+        uint16_t bucket = 0U;
+
+        /* Only this thread writes statistics, others may read them. */
+        atomic_fetch_add_explicit(&stat->calls, 1U, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stat->frames, batch, memory_order_relaxed);
+        if(batch > atomic_load_explicit(&stat->batchMax, memory_order_relaxed)){
+            atomic_store_explicit(&stat->batchMax, batch, memory_order_relaxed);
+        }
+        while(((batch >> 1) != 0U) && (bucket < (CO_CAN_RX_HIST_SIZE - 1U))){
+            batch >>= 1;
+            bucket++;
+        }
+        atomic_fetch_add_explicit(&stat->batchHist[bucket], 1U, memory_order_relaxed);
+
+        /* Kernel software timestamps are CLOCK_REALTIME. Difference to
+         * CLOCK_MONOTONIC is taken once per batch, messages are fresh. */
+        {
+            struct timespec rt, mt;
+            clock_gettime(CLOCK_REALTIME, &rt);
+            clock_gettime(CLOCK_MONOTONIC, &mt);
+            realtimeOffset = (((uint64_t)rt.tv_sec * 1000000000U) + (uint64_t)rt.tv_nsec)
+                           - (((uint64_t)mt.tv_sec * 1000000000U) + (uint64_t)mt.tv_nsec);
+        }
+    }
+
+    for(i=0; i<n; i++){
+        CO_CANrxRingEntry_t *entry = &entries[i];
+        struct cmsghdr *cmsg;
+
+        /* classic frame or (with CO_CAN_FD) CAN FD frame */
+        if(((msgs[i].msg_len != CAN_MTU) && (msgs[i].msg_len != sizeof(CO_CANframe_t)))
+            || ((entry->msg.ident & (CAN_EFF_FLAG | CAN_ERR_FLAG)) != 0U)){
+            continue;
+        }
+        entry->confirm = ((msgs[i].msg_hdr.msg_flags & MSG_CONFIRM) != 0) ? CO_true : CO_false;
+        if(entry->msg.DLC > CO_CAN_DATA_MAX){
+            entry->msg.DLC = CO_CAN_DATA_MAX;
+        }
+        entry->msg.timestamp = 0U;
+        entry->msg.timestampHw = 0U;
+        for(cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)){
+            if((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPING)){
+                struct scm_timestamping tss;
+                memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+                uint64_t timestamp = ((uint64_t)tss.ts[0].tv_sec * 1000000000U) + (uint64_t)tss.ts[0].tv_nsec;
+                if(timestamp > realtimeOffset){
+                    entry->msg.timestamp = timestamp - realtimeOffset;
                 }
-                buffer++;
+                entry->msg.timestampHw = ((uint64_t)tss.ts[2].tv_sec * 1000000000U) + (uint64_t)tss.ts[2].tv_nsec;
             }
         }
+        if(cnt != i){
+            entries[cnt] = *entry;
+        }
+        cnt++;
+    }
+
+    return cnt;
+}
+
 
-        /* Call specific function, which will process the message */
-        if(msgMatched && (buffer != NULL) && (buffer->pFunct != NULL)){
-            buffer->pFunct(buffer->object, rcvMsg);
+/*
+ * Process one received message in the processing thread.
+ */
+static void CO_CANrxDeliver(CO_CANmodule_t *CANmodule, const CO_CANrxRingEntry_t *entry){
+    if(entry->confirm){
+        /* Own message was transmitted. First CAN message (bootup) was sent
+         * successfully. Clear sync flag, if the kernel has no more messages. */
+        CANmodule->firstCANtxMessage = CO_false;
+        CANmodule->txStatistics.confirmed++;
+        if(CANmodule->txUnconfirmed > 0U){
+            CANmodule->txUnconfirmed--;
         }
+        if(CANmodule->txUnconfirmed == 0U){
+            CANmodule->bufferInhibitFlag = CO_false;
+        }
+    }
+    else{
+        CO_CANProcessRxFrame(CANmodule, &entry->msg);
+    }
+}
+
+
+/******************************************************************************/
+int32_t CO_CANreceive(CO_CANmodule_t *CANmodule){
+    CO_CANrxRingEntry_t entries[CO_CAN_RX_BATCH];
+    int32_t n, i;
+
+    n = CO_CANrxRead(CANmodule, entries, CO_CAN_RX_BATCH);
 
-        /* Clear interrupt flag */
+    /* process messages in order of reception */
+    for(i=0; i<n; i++){
+        CO_CANrxDeliver(CANmodule, &entries[i]);
     }
 
+    return n;
+}
 
-    /* transmit interrupt */
-    else if(0){
-        /* Clear interrupt flag */
 
-        /* First CAN message (bootup) was sent successfully */
-        CANmodule->firstCANtxMessage = CO_false;
-        /* clear flag from previous message */
-        CANmodule->bufferInhibitFlag = CO_false;
-        /* Are there any new messages waiting to be send */
-        if(CANmodule->CANtxCount > 0U){
-            uint16_t i;             /* index of transmitting message */
-
-            /* first buffer */
-            CO_CANtx_t *buffer = &CANmodule->txArray[0];
-            /* search through whole array of pointers to transmit message buffers. */
-            for(i = CANmodule->txSize; i > 0U; i--){
-                /* if message buffer is full, send it. */
-                if(buffer->bufferFull){
-                    buffer->bufferFull = CO_false;
-                    CANmodule->CANtxCount--;
-
-                    /* Copy message to CAN buffer */
-                    CANmodule->bufferInhibitFlag = buffer->syncFlag;
-                    /* canSend... */
-                    break;                      /* exit for loop */
-                }
-                buffer++;
-            }/* end of for loop */
+/******************************************************************************/
+int32_t CO_CANrxThreadReceive(CO_CANmodule_t *CANmodule){
+    unsigned head, tail, index, count;
+    int32_t n;
+
+    /* Only this thread writes _rxRingHead_. Acquire on _rxRingTail_ makes sure
+     * the processing thread finished reading the entries, which are reused. */
+    head = atomic_load_explicit(&CANmodule->rxRingHead, memory_order_relaxed);
+    tail = atomic_load_explicit(&CANmodule->rxRingTail, memory_order_acquire);
+
+    /* messages are received directly into free entries up to the end of the ring */
+    index = head & (CO_CAN_RX_RING_SIZE - 1U);
+    count = CO_CAN_RX_RING_SIZE - (head - tail);
+    if(count > (CO_CAN_RX_RING_SIZE - index)){
+        count = CO_CAN_RX_RING_SIZE - index;
+    }
+    if(count == 0U){
+        /* ring is full, drop messages */
+        CO_CANrxRingEntry_t entries[CO_CAN_RX_BATCH];
+
+        n = CO_CANrxRead(CANmodule, entries, CO_CAN_RX_BATCH);
+        if(n > 0){
+            atomic_fetch_add_explicit(&CANmodule->rxStatistics.overflow, (unsigned)n, memory_order_relaxed);
+            n = 0;
+        }
+        return n;
+    }
 
-            /* Clear counter if no more messages */
-            if(i == 0U){
-                CANmodule->CANtxCount = 0U;
-            }
+    n = CO_CANrxRead(CANmodule, &CANmodule->rxRing[index], (uint16_t)((count < CO_CAN_RX_BATCH) ? count : CO_CAN_RX_BATCH));
+    if(n <= 0){
+        return n;
+    }
+
+    /* publish entries */
+    atomic_store_explicit(&CANmodule->rxRingHead, head + (unsigned)n, memory_order_release);
+
+    return n;
+}
+
+
+/******************************************************************************/
+int32_t CO_CANrxRingProcess(CO_CANmodule_t *CANmodule){
+    unsigned head, tail;
+    int32_t n = 0;
+
+    tail = atomic_load_explicit(&CANmodule->rxRingTail, memory_order_relaxed);
+    head = atomic_load_explicit(&CANmodule->rxRingHead, memory_order_acquire);
+    while(tail != head){
+        /* process the entry in place and release it */
+        CO_CANrxDeliver(CANmodule, &CANmodule->rxRing[tail & (CO_CAN_RX_RING_SIZE - 1U)]);
+        tail++;
+        atomic_store_explicit(&CANmodule->rxRingTail, tail, memory_order_release);
+        n++;
+    }
+
+    return n;
+}
+
+
+/******************************************************************************/
+int32_t CO_CANtxFlush(CO_CANmodule_t *CANmodule){
+    CO_CANframe_t *frames[CO_CAN_TX_BATCH];
+    CO_CANtx_t *buffers[CO_CAN_TX_BATCH];
+    struct iovec iov[CO_CAN_TX_BATCH];
+    struct mmsghdr msgs[CO_CAN_TX_BATCH];
+    CO_CANtxStatistics_t *stat = &CANmodule->txStatistics;
+    uint16_t i, n = 0U;
+    int sent = 0;
+
+    CO_DISABLE_INTERRUPTS();
+    /* take messages in order of arbitration, they are passed to the kernel
+     * directly from object queues */
+    while(n < CO_CAN_TX_BATCH){
+        buffers[n] = CO_CANtxPop(CANmodule, &frames[n]);
+        if(buffers[n] == NULL){
+            break;
         }
+        n++;
     }
-    else{
-        /* some other interrupt reason */
-    }
-}
-void CO_CANTransmitFrame(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg){
-
-    /* receive interrupt */
-    if(1){
-	//        CO_CANrxMsg_t *rcvMsg;      /* pointer to received message in CAN module */
-        uint16_t index;             /* index of received message */
-        uint32_t rcvMsgIdent;       /* identifier of the received message */
-        CO_CANrx_t *buffer = NULL;  /* receive message buffer from CO_CANmodule_t object. */
-        CO_bool_t msgMatched = CO_false;
-
-        rcvMsg = 0; /* get message from module here */
-        rcvMsgIdent = rcvMsg->ident;
-        if(CANmodule->useCANrxFilters){
-            /* CAN module filters are used. Message with known 11-bit identifier has */
-            /* been received */
-            index = 0;  /* get index of the received message here. Or something similar */
-            if(index < CANmodule->rxSize){
-                buffer = &CANmodule->rxArray[index];
-                /* verify also RTR */
-                if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
-                    msgMatched = CO_true;
-                }
-            }
+
+    memset(msgs, 0, sizeof(msgs[0]) * n);
+    for(i = 0U; i < n; i++){
+        iov[i].iov_base = frames[i];
+        iov[i].iov_len = CO_CAN_FRAME_MTU(frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while(n > 0U){
+        sent = sendmmsg((int)CANmodule->CANbaseAddress, msgs, n, MSG_DONTWAIT);
+        if(sent >= 0){
+            break;
+        }
+        if(errno == EINTR){
+            continue;
+        }
+        if((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS)){
+            /* keep messages queued, retry in next cycle */
+            stat->backpressure++;
         }
         else{
-            /* CAN module filters are not used, message with any standard 11-bit identifier */
-            /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-            buffer = &CANmodule->rxArray[0];
-            for(index = CANmodule->rxSize; index > 0U; index--){
-                if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
-                    msgMatched = CO_true;
-                    break;
-                }
-                buffer++;
-            }
+            /* first message can not be sent, drop it */
+            stat->errors++;
+            buffers[0] = NULL;
         }
+        sent = 0;
+        break;
+    }
 
-        /* Call specific function, which will process the message */
-        if(msgMatched && (buffer != NULL) && (buffer->pFunct != NULL)){
-            buffer->pFunct(buffer->object, rcvMsg);
+    if(sent > 0){
+        if(CO_CANtestMode){
+            /* no loopback in test mode, message is transmitted */
+            CANmodule->firstCANtxMessage = CO_false;
         }
-
-        /* Clear interrupt flag */
+        else{
+            /* Message in the kernel is synchronous TPDO, until confirmed */
+            CANmodule->bufferInhibitFlag = buffers[sent - 1]->syncFlag;
+            CANmodule->txUnconfirmed += (uint32_t)sent;
+        }
+        stat->calls++;
+        stat->frames += (uint32_t)sent;
     }
 
+    /* return messages, which were not accepted, in reverse order */
+    for(i = n; i > (uint16_t)sent; i--){
+        if(buffers[i - 1U] != NULL){
+            CO_CANtxPushBack(CANmodule, buffers[i - 1U]);
+        }
+    }
+    CO_ENABLE_INTERRUPTS();
 
-    /* transmit interrupt */
-    else if(0){
-        /* Clear interrupt flag */
+    return sent;
+}
 
-        /* First CAN message (bootup) was sent successfully */
-        CANmodule->firstCANtxMessage = CO_false;
-        /* clear flag from previous message */
-        CANmodule->bufferInhibitFlag = CO_false;
-        /* Are there any new messages waiting to be send */
-        if(CANmodule->CANtxCount > 0U){
-            uint16_t i;             /* index of transmitting message */
-
-            /* first buffer */
-            CO_CANtx_t *buffer = &CANmodule->txArray[0];
-            /* search through whole array of pointers to transmit message buffers. */
-            for(i = CANmodule->txSize; i > 0U; i--){
-                /* if message buffer is full, send it. */
-                if(buffer->bufferFull){
-                    buffer->bufferFull = CO_false;
-                    CANmodule->CANtxCount--;
-
-                    /* Copy message to CAN buffer */
-                    CANmodule->bufferInhibitFlag = buffer->syncFlag;
-                    /* canSend... */
-                    break;                      /* exit for loop */
-                }
-                buffer++;
-            }/* end of for loop */
 
-            /* Clear counter if no more messages */
-            if(i == 0U){
-                CANmodule->CANtxCount = 0U;
-            }
-        }
-    }
-    else{
-        /* some other interrupt reason */
+/******************************************************************************/
+void CO_CANprocess(CO_CANmodule_t *CANmodule){
+    if(CANmodule->rxFilterChanged && CANmodule->useCANrxFilters){
+        CO_CANrxFilterApply(CANmodule);
     }
+    (void)CO_CANtxFlush(CANmodule);
 }
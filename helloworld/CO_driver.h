@@ -36,6 +36,8 @@
 #include <stddef.h>         /* for 'NULL' */
 #include <stdint.h>         /* for 'int8_t' to 'uint64_t' */
 #include <string.h>         /* memset */
+#include <stdatomic.h>      /* receive ring, CO_FLAG_SET() */
+#include <linux/can.h>      /* struct can_frame, struct canfd_frame */
 
 
 /**
@@ -117,10 +119,83 @@
 
 /**
  * @name CAN module base address
+ * On Linux, CAN module base address is file descriptor of the CAN_RAW socket,
+ * bound to the CAN interface. Sockets are opened by application before
+ * CANopen is initialized and stored into CO_CANsocket.
  * @{
  */
-    #define ADDR_CAN1   0   /**< Starting address of CAN module 1 registers */
-    #define ADDR_CAN2   1   /**< Starting address of CAN module 2 registers */
+    extern int CO_CANsocket[4];     /**< Sockets for CAN modules */
+    #define ADDR_CAN1   ((uint16_t)CO_CANsocket[0]) /**< Socket of CAN module 1 */
+    #define ADDR_CAN2   ((uint16_t)CO_CANsocket[1]) /**< Socket of CAN module 2 */
+    #define ADDR_CAN3   ((uint16_t)CO_CANsocket[2]) /**< Socket of CAN module 3 */
+    #define ADDR_CAN4   ((uint16_t)CO_CANsocket[3]) /**< Socket of CAN module 4 */
+/** @} */
+
+
+/**
+ * Test mode of the driver. If set to nonzero before CO_CANmodule_init(), CAN
+ * module base addresses may be AF_UNIX datagram sockets (for example one end
+ * of a socket pair), which carry CO_CANframe_t. CAN_RAW socket options are
+ * then not set and kernel filters are not used. Own messages are not looped
+ * back on such socket, so they are confirmed, when passed to the socket. Set
+ * by benchmarks, default is 0.
+ */
+extern int CO_CANtestMode;
+
+
+/**
+ * @name CAN FD
+ * If CO_CAN_FD is defined (make CO_CAN_FD=1), CAN_RAW_FD_FRAMES socket option
+ * is enabled and CAN messages may carry up to 64 data bytes. Messages with up
+ * to 8 data bytes are still transmitted as classic CAN frames.
+ * @{
+ */
+#ifdef CO_CAN_FD
+    /** Maximum number of data bytes in CAN message */
+    #define CO_CAN_DATA_MAX         CANFD_MAX_DLEN
+    #ifndef CO_CAN_FD_FLAGS
+    /** Flags of transmitted CAN FD frames, bit rate switch by default */
+    #define CO_CAN_FD_FLAGS         CANFD_BRS
+    #endif
+    /** Frame, exchanged with the kernel */
+    typedef struct canfd_frame      CO_CANframe_t;
+#else
+    #define CO_CAN_DATA_MAX         CAN_MAX_DLEN
+    typedef struct can_frame        CO_CANframe_t;
+#endif
+/** @} */
+
+
+/**
+ * @name Batched reception
+ * @{
+ */
+    /** Maximum number of messages read from socket by one CO_CANreceive() call */
+    #define CO_CAN_RX_BATCH         32U
+    /** Number of CO_CANrxStatistics_t::batchHist buckets, powers of two up to CO_CAN_RX_BATCH */
+    #define CO_CAN_RX_HIST_SIZE     6U
+    #ifndef CO_CAN_RX_RING_SIZE
+    /** Number of messages in receive ring between receive thread and
+      * processing thread, see CO_CANrxThreadReceive(). Must be power of two. */
+    #define CO_CAN_RX_RING_SIZE     1024U
+    #endif
+/** @} */
+
+
+/**
+ * @name Transmit scheduler
+ * Messages are transmitted in order of CAN identifier, lowest first, as they
+ * would win arbitration on the bus. Each CO_CANtx_t object has own queue.
+ * @{
+ */
+    #ifndef CO_CAN_TX_DEPTH
+    /** Maximum (and default) number of messages, queued in one CO_CANtx_t object */
+    #define CO_CAN_TX_DEPTH         4U
+    #endif
+    /** Maximum number of messages, passed to the kernel by one CO_CANtxFlush() call */
+    #define CO_CAN_TX_BATCH         32U
+    /** Number of scheduling keys: 11-bit identifier and RTR bit */
+    #define CO_CAN_TX_KEYS          0x1000U
 /** @} */
 
 
@@ -136,6 +211,28 @@
 /** @} */
 
 
+/**
+ * @name Synchronization of received messages
+ * Receive function of CANopen object (called from CO_CANProcessRxFrame())
+ * copies message data and then sets _CANrxNew_ flag. Processing function
+ * reads the flag, uses the data and then clears the flag. If both functions
+ * run in different threads, data must be visible before the flag changes:
+ * flag is atomic, it is set and cleared with release store and read with
+ * acquire load. The same macros are used for _bufferFull_ flag of CO_CANtx_t,
+ * which is written by the driver and read by CANopen objects.
+ * @{
+ */
+    /** Type of _CANrxNew_ and _bufferFull_ flags */
+    typedef atomic_bool CO_FLAG_t;
+    /** Read _CANrxNew_ flag, true if new message is available */
+    #define CO_FLAG_READ(rxNew)     atomic_load_explicit(&(rxNew), memory_order_acquire)
+    /** Set _CANrxNew_ flag, after message data are written */
+    #define CO_FLAG_SET(rxNew)      atomic_store_explicit(&(rxNew), CO_true, memory_order_release)
+    /** Clear _CANrxNew_ flag, after message data are used */
+    #define CO_FLAG_CLEAR(rxNew)    atomic_store_explicit(&(rxNew), CO_false, memory_order_release)
+/** @} */
+
+
 /**
  * @defgroup CO_dataTypes Data types
  * @{
@@ -182,21 +279,58 @@ typedef enum{
 /**
  * CAN receive message structure as aligned in CAN module. It is different in
  * different microcontrollers. It usually contains other variables.
+ *
+ * On Linux the beginning of the structure has the same layout as
+ * CO_CANframe_t (struct can_frame or struct canfd_frame), so the kernel
+ * writes received frames directly into it, see CO_CANrxThreadReceive().
  */
 typedef struct{
-    /** CAN identifier. It must be read through CO_CANrxMsg_readIdent() function. */
+    /** CAN identifier with flags, _can_id_ of struct can_frame. It must be
+      * read through CO_CANrxMsg_readIdent() and CO_CANrxMsg_readRTR() functions. */
     uint32_t            ident;
-    uint8_t             DLC ;           /**< Length of CAN message */
-    uint8_t             data[8];        /**< 8 data bytes */
+    /** Length of CAN message, it may be read through CO_CANrxMsg_readDLC() */
+    uint8_t             DLC ;
+    uint8_t             flags;          /**< CAN FD flags or padding */
+    uint8_t             reserved[2];    /**< Reserved bytes of the frame */
+    /** Data bytes, see CO_CAN_DATA_MAX */
+    uint8_t             data[CO_CAN_DATA_MAX] __attribute__((aligned(8)));
+    /** Reception time, kernel software timestamp converted to
+      * CLOCK_MONOTONIC, in [nanoseconds], 0 if not available. It must be read
+      * through CO_CANrxMsg_readTimestamp() function. */
+    uint64_t            timestamp;
+    /** Reception time, raw hardware timestamp of the CAN controller in
+      * [nanoseconds], 0 if not available. */
+    uint64_t            timestampHw;
 }CO_CANrxMsg_t;
 
 
+/**
+ * CO_CANrxMsg_t contains reception time. If defined, CANopen objects record
+ * reception time of SYNC, RPDO and Heartbeat messages, see
+ * CO_CANrxMsg_readTimestamp() and CO_CANtimestampNow().
+ */
+#define CO_CAN_RX_TIMESTAMP
+
+
+/**
+ * @name Receive dispatch index
+ * Received messages are matched against _rxArray_ through a table, which is
+ * directly indexed by 11-bit CAN identifier. See CO_CANmodule_t.
+ * @{
+ */
+    #define CO_CAN_RX_INDEX_SIZE    0x800U  /**< Number of entries in dispatch index */
+    #define CO_CAN_RX_INDEX_NONE    0xFFFFU /**< Empty entry or end of chain */
+/** @} */
+
+
 /**
  * Received message object
  */
 typedef struct{
     uint16_t            ident;          /**< Standard CAN Identifier (bits 0..10) + RTR (bit 11) */
     uint16_t            mask;           /**< Standard Identifier mask with same alignment as ident */
+    /** Index of next buffer in the same dispatch chain or CO_CAN_RX_INDEX_NONE */
+    uint16_t            next;
     void               *object;         /**< From CO_CANrxBufferInit() */
     void              (*pFunct)(void *object, const CO_CANrxMsg_t *message);  /**< From CO_CANrxBufferInit() */
 }CO_CANrx_t;
@@ -204,21 +338,84 @@ typedef struct{
 
 /**
  * Transmit message object.
+ *
+ * The beginning of the structure has the same layout as CO_CANframe_t, so
+ * CO_CANsend() queues the message with a single copy of the frame.
  */
 typedef struct{
-    uint32_t            ident;          /**< CAN identifier as aligned in CAN module */
-    uint8_t             data[8];        /**< 8 data bytes */
-    volatile CO_bool_t  bufferFull;     /**< True if previous message is still in buffer */
+    /** CAN identifier (bits 0..10) + CAN_RTR_FLAG, _can_id_ of struct can_frame */
+    uint32_t            ident;
+    /** Number of data bytes, up to CO_CAN_DATA_MAX. It may be changed before
+      * CO_CANsend(). CAN FD frame is padded with data bytes to the next valid length. */
+    uint8_t             DLC;
+    uint8_t             flags;          /**< CAN FD flags or padding, set by CO_CANsend() */
+    uint8_t             reserved[2];    /**< Reserved bytes of the frame, zero */
+    /** Data bytes, see CO_CAN_DATA_MAX */
+    uint8_t             data[CO_CAN_DATA_MAX] __attribute__((aligned(8)));
+    /** True if object queue is full. Next CO_CANsend() will overwrite the newest message. */
+    CO_FLAG_t           bufferFull;
     /** Synchronous PDO messages has this flag set. It prevents them to be sent outside the synchronous window */
     volatile CO_bool_t  syncFlag;
+    /** Messages waiting for transmission, copied by CO_CANsend() */
+    CO_CANframe_t       queue[CO_CAN_TX_DEPTH];
+    /** Queue depth, set to CO_CAN_TX_DEPTH by CO_CANtxBufferInit(). It may be
+      * lowered afterwards, 1 keeps only the latest message. */
+    uint8_t             queueDepth;
+    uint8_t             queueFirst;     /**< Index of the oldest message in _queue_ */
+    uint8_t             queueCount;     /**< Number of messages in _queue_ */
+    uint16_t            key;            /**< Scheduling key of queued messages */
+    uint16_t            next;           /**< Next object with the same key or CO_CAN_RX_INDEX_NONE */
+    uint32_t            epoch;          /**< CO_CANmodule_t::txSyncEpoch, when synchronous message was queued */
 }CO_CANtx_t;
 
 
+/**
+ * Statistics of batched reception, see CO_CANreceive(). They are cleared by
+ * CO_CANmodule_init().
+ *
+ * Counters are written by the thread, which receives messages (see
+ * CO_CANrxThreadReceive()), and may be read by any other thread, so they are
+ * atomic. Read them with atomic_load_explicit(), memory_order_relaxed.
+ */
+typedef struct{
+    atomic_uint         calls;          /**< Number of recvmmsg() calls, which returned messages */
+    atomic_uint         frames;         /**< Number of received messages */
+    atomic_uint         batchMax;       /**< Largest number of messages, returned by one call */
+    /** Histogram of batch sizes. Bucket _i_ counts batches of 2^i to 2^(i+1)-1 messages. */
+    atomic_uint         batchHist[CO_CAN_RX_HIST_SIZE];
+    atomic_uint         errors;         /**< Number of failed recvmmsg() calls */
+    atomic_uint         overflow;       /**< Number of messages dropped, because receive ring was full */
+}CO_CANrxStatistics_t;
+
+
+/**
+ * Entry of the receive ring, see CO_CANrxThreadReceive().
+ */
+typedef struct{
+    CO_CANrxMsg_t       msg;            /**< Received message */
+    /** True, if message is own transmitted message (CAN_RAW_RECV_OWN_MSGS) */
+    CO_bool_t           confirm;
+}CO_CANrxRingEntry_t;
+
+
+/**
+ * Statistics of transmission, see CO_CANtxFlush(). They are cleared by
+ * CO_CANmodule_init().
+ */
+typedef struct{
+    uint32_t            calls;          /**< Number of sendmmsg() calls, which sent messages */
+    uint32_t            frames;         /**< Number of messages, passed to the kernel */
+    uint32_t            confirmed;      /**< Number of messages, confirmed by loopback */
+    uint32_t            backpressure;   /**< Number of sendmmsg() calls, refused with EAGAIN or ENOBUFS */
+    uint32_t            errors;         /**< Number of messages dropped because of other errors */
+}CO_CANtxStatistics_t;
+
+
 /**
  * CAN module object. It may be different in different microcontrollers.
  */
 typedef struct{
-    uint16_t            CANbaseAddress; /**< From CO_CANmodule_init() */
+    uint16_t            CANbaseAddress; /**< From CO_CANmodule_init(), socket file descriptor */
     CO_CANrx_t         *rxArray;        /**< From CO_CANmodule_init() */
     uint16_t            rxSize;         /**< From CO_CANmodule_init() */
     CO_CANtx_t         *txArray;        /**< From CO_CANmodule_init() */
@@ -226,7 +423,8 @@ typedef struct{
     /** Value different than zero indicates, that CAN module hardware filters
       * are used for CAN reception. If there is not enough hardware filters,
       * they won't be used. In this case will be *all* received CAN messages
-      * processed by software. */
+      * processed by software. On Linux these are kernel CAN_RAW_FILTER filters.
+      * Received messages are always dispatched through _rxIndex_. */
     volatile CO_bool_t  useCANrxFilters;
     /** If flag is true, then message in transmitt buffer is synchronous PDO
       * message, which will be aborted, if CO_clearPendingSyncPDOs() function
@@ -235,10 +433,48 @@ typedef struct{
     volatile CO_bool_t  bufferInhibitFlag;
     /** Equal to 1, when the first transmitted message (bootup message) is in CAN TX buffers */
     volatile CO_bool_t  firstCANtxMessage;
-    /** Number of messages in transmit buffer, which are waiting to be copied to the CAN module */
+    /** Number of messages in transmit queues, which are waiting to be passed to the kernel */
     volatile uint16_t   CANtxCount;
     uint32_t            errOld;         /**< Previous state of CAN errors */
     void               *em;             /**< Emergency object */
+    /** Receive dispatch index, maintained by CO_CANrxBufferInit(). For each
+      * 11-bit CAN identifier it holds index of the first buffer from _rxArray_
+      * with exact (0x7FF) mask. Further buffers with the same identifier (RTR or
+      * duplicates) are chained in ascending order through CO_CANrx_t::next. */
+    uint16_t            rxIndex[CO_CAN_RX_INDEX_SIZE];
+    /** First buffer from _rxArray_ with mask different than 0x7FF. Those
+      * buffers are chained the same way and are verified, if there is no
+      * match in _rxIndex_. */
+    uint16_t            rxMaskedFirst;
+    /** True, if kernel receive filter must be rebuilt by CO_CANprocess() */
+    volatile CO_bool_t  rxFilterChanged;
+    /** Number of CAN_RAW_FILTER entries applied to socket, 0 if all messages are received */
+    uint16_t            rxFilterCount;
+    CO_CANrxStatistics_t rxStatistics;  /**< Statistics of batched reception */
+    /** Transmit scheduler: bitmaps of scheduling keys with queued messages,
+      * separate for ordinary [0] and synchronous [1] messages. */
+    uint32_t            txReady[2][CO_CAN_TX_KEYS / 32U];
+    /** Summary of _txReady_, one bit for each nonzero word */
+    uint32_t            txReadySummary[2][CO_CAN_TX_KEYS / 1024U];
+    /** First object from _txArray_ for each key, valid if bit in _txReady_ is set.
+      * Objects with the same key are chained through CO_CANtx_t::next. */
+    uint16_t            txReadyFirst[2][CO_CAN_TX_KEYS];
+    /** Number of queued synchronous messages */
+    uint16_t            txSyncCount;
+    /** Incremented by CO_CANclearPendingSyncPDOs(). Queues of synchronous
+      * objects with older epoch are discarded. */
+    uint32_t            txSyncEpoch;
+    /** Number of messages passed to the kernel and not yet confirmed by
+      * CAN_RAW_RECV_OWN_MSGS loopback */
+    uint32_t            txUnconfirmed;
+    CO_CANtxStatistics_t txStatistics;  /**< Statistics of transmission */
+    /** Single producer, single consumer receive ring. It is written by
+      * CO_CANrxThreadReceive() and read by CO_CANrxRingProcess(). */
+    CO_CANrxRingEntry_t rxRing[CO_CAN_RX_RING_SIZE];
+    /** Number of messages ever written into _rxRing_, stored by receive thread */
+    atomic_uint         rxRingHead;
+    /** Number of messages ever read from _rxRing_, stored by processing thread */
+    atomic_uint         rxRingTail;
 }CO_CANmodule_t;
 
 
@@ -311,6 +547,42 @@ void CO_CANmodule_disable(CO_CANmodule_t *CANmodule);
 uint16_t CO_CANrxMsg_readIdent(const CO_CANrxMsg_t *rxMsg);
 
 
+/**
+ * Read RTR bit from received message
+ *
+ * @param rxMsg Pointer to received message
+ * @return True for remote transmission request.
+ */
+CO_bool_t CO_CANrxMsg_readRTR(const CO_CANrxMsg_t *rxMsg);
+
+
+/**
+ * Read number of data bytes from received message
+ *
+ * @param rxMsg Pointer to received message
+ * @return Number of data bytes, up to CO_CAN_DATA_MAX.
+ */
+uint8_t CO_CANrxMsg_readDLC(const CO_CANrxMsg_t *rxMsg);
+
+
+/**
+ * Read reception time from received message.
+ *
+ * @param rxMsg Pointer to received message
+ * @return Reception time in [nanoseconds], in the same time base as
+ * CO_CANtimestampNow(), or 0 if not available.
+ */
+uint64_t CO_CANrxMsg_readTimestamp(const CO_CANrxMsg_t *rxMsg);
+
+
+/**
+ * Get current time in the time base of CO_CANrxMsg_readTimestamp().
+ *
+ * @return Current time (CLOCK_MONOTONIC) in [nanoseconds].
+ */
+uint64_t CO_CANtimestampNow(void);
+
+
 /**
  * Configure CAN message receive buffer.
  *
@@ -374,6 +646,11 @@ CO_CANtx_t *CO_CANtxBufferInit(
 /**
  * Send CAN message.
  *
+ * On Linux message is copied into queue of the transmit object, from where
+ * it is passed to the kernel by CO_CANtxFlush(), lowest CAN identifier first.
+ * If object queue becomes full, _bufferFull_ flag is set. If it is already
+ * full, the newest queued message is overwritten and overflow is reported.
+ *
  * @param CANmodule This object.
  * @param buffer Pointer to transmit buffer, returned by CO_CANtxBufferInit().
  * Data bytes must be written in buffer before function call.
@@ -396,6 +673,9 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
  * when it is called. Function should be called by the stack in the moment,
  * when SYNC time was just passed out of synchronous window.
  *
+ * On Linux all queued synchronous messages are discarded in constant time.
+ * Messages, already passed to the kernel, can not be aborted.
+ *
  * @param CANmodule This object.
  */
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule);
@@ -421,7 +701,106 @@ void CO_CANverifyErrors(CO_CANmodule_t *CANmodule);
 void CO_CANinterrupt(CO_CANmodule_t *CANmodule);
 
 
+/**
+ * Process received CAN message.
+ *
+ * Function finds matching buffer from _rxArray_ and calls its callback.
+ *
+ * @param CANmodule This object.
+ * @param rcvMsg Received message.
+ */
 void CO_CANProcessRxFrame(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg);
 
+
+/**
+ * Pass queued CAN messages to the kernel.
+ *
+ * Function takes up to #CO_CAN_TX_BATCH queued messages in order of CAN
+ * identifier (lowest first, data before RTR) and writes them to socket with
+ * single sendmmsg() call. If the socket or the interface queue is full
+ * (EAGAIN or ENOBUFS), messages, which were not accepted, are returned to
+ * their queues for the next call. Priority inversion is so limited to the
+ * interface queue of the kernel (txqueuelen). Function is called once per
+ * processing cycle from CO_CANprocess().
+ *
+ * @param CANmodule This object.
+ *
+ * @return Number of messages passed to the kernel.
+ */
+int32_t CO_CANtxFlush(CO_CANmodule_t *CANmodule);
+
+
+/**
+ * Process CAN module.
+ *
+ * Function must be called once per cycle of the main loop, after CANopen
+ * objects were processed. If receive buffers or transmit buffers were
+ * (re)configured, function rebuilds kernel filter for the socket. Identifiers
+ * of _rxArray_ and own transmitted identifiers (for loopback confirmation) are
+ * merged into aligned ranges and applied with CAN_RAW_FILTER. If more than
+ * CAN_RAW_FILTER_MAX filters would be needed, all messages are received. After
+ * that function calls CO_CANtxFlush().
+ *
+ * @param CANmodule This object.
+ */
+void CO_CANprocess(CO_CANmodule_t *CANmodule);
+
+
+/**
+ * Receive CAN messages from socket.
+ *
+ * Function reads up to #CO_CAN_RX_BATCH messages from non-blocking socket with
+ * single recvmmsg() call and processes them with CO_CANProcessRxFrame() in
+ * order of reception. Messages with extended identifier and error messages
+ * are ignored. Reception time is taken from SO_TIMESTAMPING control message.
+ * Own messages, received through CAN_RAW_RECV_OWN_MSGS loopback, confirm
+ * successful transmission: they clear _firstCANtxMessage_ and, if no other
+ * message is pending in the kernel, _bufferInhibitFlag_.
+ * Function should be called, when socket is readable. If more
+ * messages are waiting, socket remains readable.
+ *
+ * @param CANmodule This object.
+ *
+ * @return Number of received messages, 0 if no message was waiting or -1 on
+ * socket error (errno is set).
+ */
+int32_t CO_CANreceive(CO_CANmodule_t *CANmodule);
+
+
+/**
+ * Receive CAN messages from socket into receive ring.
+ *
+ * Function is used instead of CO_CANreceive(), if separate receive thread is
+ * used. It must be called only from that thread, when socket is readable. It
+ * reads messages the same way as CO_CANreceive(), but only stores them into
+ * _rxRing_ without processing. Receive thread touches no other CANopen object,
+ * so slow processing (SDO transfer, application callbacks) doesn't delay
+ * reception. If ring is full, messages are dropped and counted in
+ * CO_CANrxStatistics_t::overflow.
+ *
+ * Receive thread must not run during CO_CANmodule_init().
+ *
+ * @param CANmodule This object.
+ *
+ * @return Number of messages stored into ring, 0 if no message was waiting
+ * or -1 on socket error (errno is set).
+ */
+int32_t CO_CANrxThreadReceive(CO_CANmodule_t *CANmodule);
+
+
+/**
+ * Process CAN messages from receive ring.
+ *
+ * Function must be called from processing thread (the thread, which calls
+ * CO_process() and CO_CANprocess()), after CO_CANrxThreadReceive() stored
+ * messages. Messages are processed in order of reception, the same way as
+ * by CO_CANreceive().
+ *
+ * @param CANmodule This object.
+ *
+ * @return Number of processed messages.
+ */
+int32_t CO_CANrxRingProcess(CO_CANmodule_t *CANmodule);
+
 /** @} */
 #endif
@@ -0,0 +1,121 @@
+/*
+ * Common functions for CANopenNode benchmarks on Linux socketCAN.
+ *
+ * @file        bench.c
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#include "CO_driver.h"
+#include "bench.h"
+
+
+/******************************************************************************/
+uint64_t bench_now(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/* Open raw CAN socket bound to interface */
+static int bench_CANraw(unsigned ifIndex){
+    struct sockaddr_can addr;
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    if(fd < 0){
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)ifIndex;
+    if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0){
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/******************************************************************************/
+int bench_CANsocket(const char *ifName, int *peer){
+    int sv[2];
+    int bufSize = 4 * 1024 * 1024;
+
+    if(ifName != NULL){
+        unsigned ifIndex = if_nametoindex(ifName);
+
+        if(ifIndex == 0U){
+            fprintf(stderr, "bench: unknown CAN interface %s\n", ifName);
+            return -1;
+        }
+        sv[0] = bench_CANraw(ifIndex);
+        sv[1] = bench_CANraw(ifIndex);
+        if((sv[0] < 0) || (sv[1] < 0)){
+            perror("bench: CAN socket");
+            return -1;
+        }
+#ifdef CO_CAN_FD
+        {
+            int enableFD = 1;
+            (void)setsockopt(sv[1], SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableFD, sizeof(enableFD));
+        }
+#endif
+    }
+    else if(socketpair(AF_UNIX, SOCK_DGRAM, 0, sv) < 0){
+        perror("bench: socketpair");
+        return -1;
+    }
+    else{
+        /* socket pair has no CAN_RAW socket options */
+        CO_CANtestMode = 1;
+    }
+
+    /* Large buffers, benchmarks send bursts of frames */
+    (void)setsockopt(sv[0], SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    (void)setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+    (void)setsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    (void)setsockopt(sv[1], SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+
+    *peer = sv[1];
+    return sv[0];
+}
+
+
+/******************************************************************************/
+void bench_report(const char *name, uint64_t count, const char *unit, uint64_t ns){
+    double s = (double)ns / 1e9;
+
+    printf("%-40s %12llu %-8s %8.3f s %14.0f %s/s\n", name, (unsigned long long)count,
+           unit, s, (s > 0.0) ? ((double)count / s) : 0.0, unit);
+}
@@ -0,0 +1,68 @@
+/**
+ * Common functions for CANopenNode benchmarks on Linux socketCAN.
+ *
+ * @file        bench.h
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+
+/**
+ * Get monotonic time.
+ *
+ * @return Time in nanoseconds.
+ */
+uint64_t bench_now(void);
+
+
+/**
+ * Open socket for CANopenNode driver.
+ *
+ * If _ifName_ is given (for example "vcan0"), socketCAN raw socket is bound to
+ * that interface and _peer_ is second raw socket on the same interface.
+ * Otherwise _peer_ is the other end of an AF_UNIX datagram socket pair, which
+ * carries struct can_frame (or canfd_frame with CO_CAN_FD) as the interface
+ * would. Socket pair sets CO_CANtestMode, so driver doesn't set CAN_RAW socket
+ * options and benchmarks also run without CAN support in the kernel.
+ *
+ * @param ifName CAN interface name or NULL for socket pair.
+ * @param peer Returned socket for other side of the bus.
+ *
+ * @return Socket for CO_CANmodule_init() or -1 on error.
+ */
+int bench_CANsocket(const char *ifName, int *peer);
+
+
+/**
+ * Print result line.
+ *
+ * @param name Name of the measurement.
+ * @param count Number of processed units.
+ * @param unit Name of the unit, for example "frames".
+ * @param ns Elapsed time in nanoseconds.
+ */
+void bench_report(const char *name, uint64_t count, const char *unit, uint64_t ns);
+
+
+#endif
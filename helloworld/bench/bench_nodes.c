@@ -0,0 +1,220 @@
+/*
+ * Benchmark for many CANopen nodes in one process.
+ *
+ * Nodes are created with CO_initInstance() as virtual nodes of
+ * main_socketcan.c (option -n). They share EEPROM and ROM images of the
+ * Object dictionary, which are configured for bus load: heartbeat producer
+ * 100 ms, TPDO1 event timer 10 ms, four heartbeat consumers. All nodes are
+ * started with NMT and run for given time in 1 ms steps, as fast as
+ * possible.
+ *
+ * Without CAN interface each node has own socket pair and this program
+ * forwards each transmitted frame to all other nodes, as the bus would.
+ * With CAN interface (option -i) all nodes are on that interface.
+ *
+ * Result is number of frames on the bus and number of frames received by
+ * the nodes per second of real time.
+ *
+ * Usage: bench_nodes [-n nodes] [-t simulated ms] [-i CAN interface]
+ *
+ * @file        bench_nodes.c
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include "CANopen.h"
+#include "bench.h"
+
+#if CO_NO_CAN_MODULES != 1
+#error bench_nodes supports one CAN module
+#endif
+
+
+typedef struct{
+    CO_t               *CO;
+    CO_config_t         config;
+    struct sCO_OD_RAM   ODRAM;          /* EEPROM and ROM images are shared */
+    int                 peer;           /* other side of the socket pair */
+}node_t;
+
+static node_t *nodes;
+static int nodesCount = 127;
+
+
+/* Forward frames, transmitted by nodes, to all other nodes */
+static uint32_t forward(void){
+    CO_CANframe_t frame;
+    uint32_t count = 0U;
+    int i, j;
+
+    for(i=0; i<nodesCount; i++){
+        while(recv(nodes[i].peer, &frame, sizeof(frame), MSG_DONTWAIT) > 0){
+            for(j=0; j<nodesCount; j++){
+                if((j != i) && (send(nodes[j].peer, &frame, sizeof(frame), 0) < 0)){
+                    perror("send");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+/* Send frame to all nodes */
+static void broadcast(int fd, const CO_CANframe_t *frame){
+    int i;
+
+    if(fd >= 0){
+        (void)send(fd, frame, sizeof(*frame), 0);
+        return;
+    }
+    for(i=0; i<nodesCount; i++){
+        (void)send(nodes[i].peer, frame, sizeof(*frame), 0);
+    }
+}
+
+
+/******************************************************************************/
+int main(int argc, char *argv[]){
+    const char *ifName = NULL;
+    uint32_t simTime = 2000U, ms;
+    uint64_t busFrames = 0U, rxFrames = 0U, t;
+    CO_CANframe_t frame;
+    int i, opt, busPeer = -1;
+
+    while((opt = getopt(argc, argv, "n:t:i:")) != -1){
+        switch(opt){
+            case 'n': nodesCount = atoi(optarg); break;
+            case 't': simTime = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': ifName = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n nodes] [-t simulated ms] [-i CAN interface]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if((nodesCount < 1) || (nodesCount > 127)){
+        fprintf(stderr, "Number of nodes must be 1 to 127\n");
+        return EXIT_FAILURE;
+    }
+
+    /* configuration, shared by all nodes */
+    OD_producerHeartbeatTime = 100U;
+    OD_TPDOCommunicationParameter[0].eventTimer = 10U;
+    for(i=0; i<4; i++){
+        OD_consumerHeartbeatTime[i] = ((uint32_t)(i + 1) << 16) | 500U;
+    }
+
+    nodes = calloc((size_t)nodesCount, sizeof(*nodes));
+    if(nodes == NULL){
+        return EXIT_FAILURE;
+    }
+    for(i=0; i<nodesCount; i++){
+        node_t *node = &nodes[i];
+        int fd = bench_CANsocket(ifName, &node->peer);
+
+        if(fd < 0){
+            return EXIT_FAILURE;
+        }
+        if(ifName != NULL){
+            /* nodes are connected by the interface */
+            if(busPeer < 0){
+                busPeer = node->peer;
+            }
+            else{
+                close(node->peer);
+            }
+            node->peer = -1;
+        }
+        node->config.nodeId = (uint8_t)(i + 1);
+        node->config.CANbitRate[0] = 1000U;
+        node->config.CANbaseAddress[0] = (uint16_t)fd;
+        node->config.ODRAM = &node->ODRAM;
+        if(CO_initInstance(&node->CO, &node->config) != CO_ERROR_NO){
+            fprintf(stderr, "CANopen init of node %d failed\n", i + 1);
+            return EXIT_FAILURE;
+        }
+        CO_CANsetNormalMode(node->config.CANbaseAddress[0]);
+        CO_CANprocess(node->CO->CANmodule[0]);
+    }
+    printf("%d nodes, memory per node=%u bytes (CO_t objects and RAM image)\n",
+           nodesCount, (unsigned)(nodes[0].CO->memoryUsed + sizeof(nodes[0].ODRAM)));
+
+    t = bench_now();
+    for(ms=0U; ms<simTime; ms++){
+        if(ms == 10U){
+            /* NMT: start all nodes after bootup */
+            memset(&frame, 0, sizeof(frame));
+            frame.can_id = CO_CAN_ID_NMT_SERVICE;
+            frame.len = 2U;
+            frame.data[0] = CO_NMT_ENTER_OPERATIONAL;
+            broadcast(busPeer, &frame);
+        }
+        for(i=0; i<nodesCount; i++){
+            CO_t *CO = nodes[i].CO;
+            int32_t n;
+
+            while((n = CO_CANreceive(CO->CANmodule[0])) > 0){
+                rxFrames += (uint64_t)n;
+            }
+            (void)CO_process(CO, 1U);
+            CO_process_RPDO(CO);
+            CO_process_TPDO(CO);
+            CO_CANprocess(CO->CANmodule[0]);
+        }
+        if(ifName == NULL){
+            busFrames += forward();
+        }
+    }
+    t = bench_now() - t;
+
+    if(ifName != NULL){
+        /* frames on the bus are counted by the nodes */
+        for(i=0; i<nodesCount; i++){
+            busFrames += nodes[i].CO->CANmodule[0]->txStatistics.frames;
+        }
+    }
+    for(i=0; i<nodesCount; i++){
+        if(nodes[i].CO->NMT->operatingState != CO_NMT_OPERATIONAL){
+            fprintf(stderr, "Node %d is not operational (%d)\n", i + 1, nodes[i].CO->NMT->operatingState);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("simulated %u ms in %.3f s, %.1f x real time\n", simTime, (double)t / 1e9,
+           ((double)simTime / 1e3) / ((double)t / 1e9));
+    bench_report("frames on the bus", busFrames, "frames", t);
+    bench_report("frames received by all nodes", rxFrames, "frames", t);
+
+    for(i=0; i<nodesCount; i++){
+        CO_deleteInstance(&nodes[i].CO);
+    }
+    free(nodes);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/*
+ * Benchmark for processing of PDOs, which call OD extensions.
+ *
+ * RPDO1 maps eight objects 6200,01 to 6200,08 and TPDO1 maps eight objects
+ * 6000,01 to 6000,08. Each PDO is processed:
+ *  - without extension functions,
+ *  - with extension functions on 6000 and 6200, which are called through
+ *    the list, resolved by CO_RPDOconfigMap() and CO_TPDOconfigMap(),
+ *  - with the same extension functions, called after CO_OD_find() and other
+ *    lookups for each mapped object on each PDO, as done before the list.
+ *
+ * RPDO is received with CO_CANProcessRxFrame() and processed with
+ * CO_RPDO_process(). TPDO is sent with CO_TPDOsend(), transmit queue is
+ * flushed to the socket after each CO_CAN_TX_DEPTH PDOs.
+ *
+ * Extensions are called only, if stack is built with RPDO_CALLS_EXTENSION
+ * and TPDO_CALLS_EXTENSION (make PDO_CALLS_EXTENSION=1 bench). Benchmark
+ * fails, if extension is not called for each mapped object or if RPDO data
+ * don't reach Object Dictionary.
+ *
+ * Usage: bench_pdo [-n PDOs] [-i CAN interface]
+ *
+ * @file        bench_pdo.c
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include "CANopen.h"
+#include "bench.h"
+
+#if defined(RPDO_CALLS_EXTENSION) && defined(TPDO_CALLS_EXTENSION)
+#define EXT_CALLS_PER_PDO   8U
+#else
+#define EXT_CALLS_PER_PDO   0U
+#endif
+
+static CO_t *node;             /* created by CO_initInstance() */
+static CO_config_t config;
+static int peer;
+static uint64_t extCalls;
+
+
+/* OD extension function for mapped objects */
+static CO_SDO_abortCode_t benchODF(CO_ODF_arg_t *ODF_arg){
+    (void)ODF_arg;
+    extCalls++;
+
+    return CO_SDO_AB_NONE;
+}
+
+
+/* Register or remove extension functions of mapped objects */
+static void extConfigure(CO_bool_t enable){
+    CO_SDO_abortCode_t (*pODFunc)(CO_ODF_arg_t *ODF_arg) = enable ? benchODF : NULL;
+
+    CO_OD_configure(node->SDO[0], 0x6000, pODFunc, NULL, NULL, 0);
+    CO_OD_configure(node->SDO[0], 0x6200, pODFunc, NULL, NULL, 0);
+}
+
+
+/* Call extensions of mapped objects with lookups on each PDO, as done
+ * before mapped objects were resolved by CO_R(T)PDOconfigMap() */
+static void lookupCallExt(CO_SDO_t *SDO, const uint32_t *pMap, uint8_t count, CO_bool_t reading){
+    uint8_t i;
+
+    for(i=count; i>0; i--){
+        uint32_t map = *(pMap++);
+        uint16_t index = (uint16_t)(map>>16);
+        uint8_t subIndex = (uint8_t)(map>>8);
+        uint16_t entryNo = CO_OD_find(SDO, index);
+        CO_OD_extension_t *ext = &SDO->ODExtensions[entryNo];
+        CO_ODF_arg_t ODF_arg;
+
+        memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
+        ODF_arg.reading = reading;
+        ODF_arg.index = index;
+        ODF_arg.subIndex = subIndex;
+        ODF_arg.object = ext->object;
+        ODF_arg.attribute = CO_OD_getAttribute(SDO, entryNo, subIndex);
+        ODF_arg.pFlags = CO_OD_getFlagsPointer(SDO, entryNo, subIndex);
+        ODF_arg.data = CO_OD_getDataPointer(SDO, entryNo, subIndex);
+        ODF_arg.dataLength = CO_OD_getLength(SDO, entryNo, subIndex);
+        benchODF(&ODF_arg);
+    }
+}
+
+
+/* Receive and process RPDOs, returns elapsed time */
+static uint64_t rpdoRun(uint64_t pdos, CO_bool_t lookup){
+    CO_RPDO_t *RPDO = node->RPDO[0];
+    CO_CANrxMsg_t msg;
+    uint64_t i, t;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.ident = 0x200U + config.nodeId;
+    msg.DLC = 8U;
+
+    t = bench_now();
+    for(i=0U; i<pdos; i++){
+        msg.data[0] = (uint8_t)i;
+        msg.data[7] = (uint8_t)~i;
+        CO_CANProcessRxFrame(node->CANmodule[0], &msg);
+        CO_RPDO_process(RPDO, CO_false);
+        if(lookup){
+            lookupCallExt(RPDO->SDO, &RPDO->RPDOMapPar->mappedObject1,
+                          RPDO->RPDOMapPar->numberOfMappedObjects, CO_false);
+        }
+    }
+    t = bench_now() - t;
+
+    /* the last PDO must be in Object Dictionary */
+    if((OD_writeOutput8Bit[0] != msg.data[0]) || (OD_writeOutput8Bit[7] != msg.data[7])){
+        fprintf(stderr, "RPDO data were not written to Object Dictionary\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return t;
+}
+
+
+/* Send TPDOs, returns elapsed time */
+static uint64_t tpdoRun(uint64_t pdos, CO_bool_t lookup){
+    CO_TPDO_t *TPDO = node->TPDO[0];
+    CO_CANframe_t frame;
+    uint64_t i, t;
+
+    t = bench_now();
+    for(i=0U; i<pdos; i++){
+        if(lookup){
+            lookupCallExt(TPDO->SDO, &TPDO->TPDOMapPar->mappedObject1,
+                          TPDO->TPDOMapPar->numberOfMappedObjects, CO_true);
+        }
+        (void)CO_TPDOsend(TPDO);
+        if(((i + 1U) % CO_CAN_TX_DEPTH) == 0U){
+            (void)CO_CANtxFlush(node->CANmodule[0]);
+        }
+        /* discard frames, before socket buffer fills */
+        if(((i + 1U) % 256U) == 0U){
+            while(recv(peer, &frame, sizeof(frame), MSG_DONTWAIT) > 0){
+            }
+        }
+    }
+    (void)CO_CANtxFlush(node->CANmodule[0]);
+    t = bench_now() - t;
+    while(recv(peer, &frame, sizeof(frame), MSG_DONTWAIT) > 0){
+    }
+
+    return t;
+}
+
+
+/* Run benchmark and verify number of extension calls */
+static void run(const char *name, uint64_t (*runFunct)(uint64_t pdos, CO_bool_t lookup),
+                uint64_t pdos, CO_bool_t ext, CO_bool_t lookup)
+{
+    uint64_t expected = 0U, t;
+
+    extConfigure(ext && !lookup);
+    extCalls = 0U;
+    t = runFunct(pdos, lookup);
+    if(lookup){
+        expected = pdos * 8U;
+    }
+    else if(ext){
+        expected = pdos * EXT_CALLS_PER_PDO;
+    }
+    if(extCalls != expected){
+        fprintf(stderr, "%s: %llu extension calls, expected %llu\n", name,
+                (unsigned long long)extCalls, (unsigned long long)expected);
+        exit(EXIT_FAILURE);
+    }
+    bench_report(name, pdos, "PDOs", t);
+}
+
+
+/******************************************************************************/
+int main(int argc, char *argv[]){
+    uint64_t pdos = 1000000U;
+    const char *ifName = NULL;
+    uint32_t *map;
+    int fd, opt, i, m;
+
+    while((opt = getopt(argc, argv, "n:i:")) != -1){
+        switch(opt){
+            case 'n': pdos = strtoull(optarg, NULL, 0); break;
+            case 'i': ifName = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n PDOs] [-i CAN interface]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    /* eight 8-bit objects in RPDO1 and TPDO1 */
+    OD_RPDOMappingParameter[0].numberOfMappedObjects = 8U;
+    OD_TPDOMappingParameter[0].numberOfMappedObjects = 8U;
+    for(i=0; i<8; i++){
+        map = &OD_RPDOMappingParameter[0].mappedObject1;
+        map[i] = 0x62000008UL | ((uint32_t)(i + 1) << 8);
+        map = &OD_TPDOMappingParameter[0].mappedObject1;
+        map[i] = 0x60000008UL | ((uint32_t)(i + 1) << 8);
+    }
+
+    fd = bench_CANsocket(ifName, &peer);
+    if(fd < 0){
+        return EXIT_FAILURE;
+    }
+    config.nodeId = 1U;
+    config.CANbitRate[0] = 1000U;
+    config.CANbaseAddress[0] = (uint16_t)fd;
+    /* other CAN modules get own sockets, which are not used by benchmark */
+    for(m=1; m<CO_NO_CAN_MODULES; m++){
+        int idlePeer;
+        int idle = bench_CANsocket(ifName, &idlePeer);
+
+        if(idle < 0){
+            return EXIT_FAILURE;
+        }
+        config.CANbitRate[m] = 1000U;
+        config.CANbaseAddress[m] = (uint16_t)idle;
+    }
+    if(CO_initInstance(&node, &config) != CO_ERROR_NO){
+        fprintf(stderr, "CANopen init failed\n");
+        return EXIT_FAILURE;
+    }
+    CO_CANsetNormalMode(config.CANbaseAddress[0]);
+    CO_CANprocess(node->CANmodule[0]);
+    node->NMT->operatingState = CO_NMT_OPERATIONAL;
+    if(!node->RPDO[0]->valid || !node->TPDO[0]->valid){
+        fprintf(stderr, "PDO mapping is not valid\n");
+        return EXIT_FAILURE;
+    }
+    if(EXT_CALLS_PER_PDO == 0U){
+        printf("OD extensions are not called from PDOs, build with: make PDO_CALLS_EXTENSION=1 bench\n");
+    }
+
+    run("RPDO, no extensions", rpdoRun, pdos, CO_false, CO_false);
+    run("RPDO, 8 extensions, resolved at mapping", rpdoRun, pdos, CO_true, CO_false);
+    run("RPDO, 8 extensions, CO_OD_find per PDO", rpdoRun, pdos, CO_true, CO_true);
+    run("TPDO, no extensions", tpdoRun, pdos, CO_false, CO_false);
+    run("TPDO, 8 extensions, resolved at mapping", tpdoRun, pdos, CO_true, CO_false);
+    run("TPDO, 8 extensions, CO_OD_find per PDO", tpdoRun, pdos, CO_true, CO_true);
+
+    CO_deleteInstance(&node);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/*
+ * Benchmark for dispatching of received CAN frames.
+ *
+ * Receive buffers are configured as on a busy node: NMT, one buffer with a
+ * mask, 512 RPDOs (most of them disabled on COB-ID 0) and 127 heartbeat
+ * consumers. Frames with all 2048 identifiers are dispatched with:
+ *  - linear search of rxArray, as done before the dispatch index,
+ *  - CO_CANProcessRxFrame() with the dispatch index,
+ *  - CO_CANreceive() from the socket (socket pair or CAN interface).
+ *
+ * Linear search and dispatch index must select the same buffer for every
+ * identifier, otherwise benchmark fails.
+ *
+ * Usage: bench_rx [-n frames] [-i CAN interface]
+ *
+ * @file        bench_rx.c
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include "CO_driver.h"
+#include "bench.h"
+
+
+#define RX_SIZE     641U
+#define RX_MASKED   1U      /* index of the buffer with mask */
+
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[RX_SIZE];
+static CO_CANtx_t txArray[1];
+static uint16_t rxIndexOf[RX_SIZE];
+static volatile uint16_t lastIndex;
+static uint64_t received;
+
+
+/* Receive function for all buffers, object is index of the buffer */
+static void rxFunct(void *object, const CO_CANrxMsg_t *msg){
+    (void)msg;
+    lastIndex = *(uint16_t *)object;
+    received++;
+}
+
+
+/* Linear search of rxArray, as in the driver without dispatch index */
+static void linearProcessRxFrame(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg){
+    uint32_t rcvMsgIdent = rcvMsg->ident & CAN_SFF_MASK;
+    CO_CANrx_t *buffer = &CANmodule->rxArray[0];
+    uint16_t index;
+
+    if((rcvMsg->ident & CAN_RTR_FLAG) != 0U){
+        rcvMsgIdent |= 0x0800U;
+    }
+    for(index = CANmodule->rxSize; index > 0U; index--){
+        if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
+            if(buffer->pFunct != NULL){
+                buffer->pFunct(buffer->object, rcvMsg);
+            }
+            break;
+        }
+        buffer++;
+    }
+}
+
+
+/* Configure receive buffers */
+static void rxConfigure(void){
+    uint16_t i;
+
+    for(i=0U; i<RX_SIZE; i++){
+        uint16_t ident, mask = 0x7FFU;
+
+        if(i == 0U){
+            ident = 0x000U;                         /* NMT */
+        }
+        else if(i == RX_MASKED){
+            ident = 0x200U; mask = 0x7F0U;          /* overlaps first RPDOs */
+        }
+        else if(i < 514U){
+            ident = (i < 66U) ? (0x200U + i - 2U) : 0x000U;   /* RPDOs */
+        }
+        else{
+            ident = 0x700U + i - 513U;              /* heartbeat consumers */
+        }
+        rxIndexOf[i] = i;
+        CO_CANrxBufferInit(&CANmodule, i, ident, mask, CO_false, &rxIndexOf[i], rxFunct);
+    }
+}
+
+
+/* Both searches must select the same buffer */
+static int rxVerify(void){
+    CO_CANrxMsg_t msg;
+    uint32_t id;
+
+    memset(&msg, 0, sizeof(msg));
+    for(id=0U; id<0x1000U; id++){
+        uint16_t linear, indexed;
+
+        msg.ident = (id & 0x7FFU) | (((id & 0x800U) != 0U) ? CAN_RTR_FLAG : 0U);
+        lastIndex = 0xFFFFU;
+        linearProcessRxFrame(&CANmodule, &msg);
+        linear = lastIndex;
+        lastIndex = 0xFFFFU;
+        CO_CANProcessRxFrame(&CANmodule, &msg);
+        indexed = lastIndex;
+        if(linear != indexed){
+            fprintf(stderr, "ident 0x%03X: linear buffer %u, indexed buffer %u\n",
+                    (unsigned)id, linear, indexed);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+int main(int argc, char *argv[]){
+    uint64_t frames = 10000000U;
+    const char *ifName = NULL;
+    CO_CANrxMsg_t msg;
+    uint64_t i, t;
+    int fd, peer, opt;
+
+    while((opt = getopt(argc, argv, "n:i:")) != -1){
+        switch(opt){
+            case 'n': frames = strtoull(optarg, NULL, 0); break;
+            case 'i': ifName = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n frames] [-i CAN interface]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    fd = bench_CANsocket(ifName, &peer);
+    if((fd < 0) || (CO_CANmodule_init(&CANmodule, (uint16_t)fd, rxArray, RX_SIZE, txArray, 1U, 125U) != CO_ERROR_NO)){
+        fprintf(stderr, "CAN module initialization failed\n");
+        return EXIT_FAILURE;
+    }
+    rxConfigure();
+    CO_CANprocess(&CANmodule);  /* kernel filters on CAN interface */
+    if(rxVerify() != 0){
+        return EXIT_FAILURE;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.DLC = 8U;
+
+    /* Linear search is slow, use fewer frames */
+    t = bench_now();
+    for(i=0U; i<frames/20U; i++){
+        msg.ident = (uint32_t)(i * 7U) & CAN_SFF_MASK;
+        linearProcessRxFrame(&CANmodule, &msg);
+    }
+    bench_report("dispatch, linear search", frames/20U, "frames", bench_now() - t);
+
+    t = bench_now();
+    for(i=0U; i<frames; i++){
+        msg.ident = (uint32_t)(i * 7U) & CAN_SFF_MASK;
+        CO_CANProcessRxFrame(&CANmodule, &msg);
+    }
+    bench_report("dispatch, CO_CANProcessRxFrame()", frames, "frames", bench_now() - t);
+
+    /* Through the socket, in bursts which fit into the socket buffer */
+    {
+        CO_CANframe_t frame;
+        uint64_t sent = 0U, sockFrames = frames / 10U;
+
+        memset(&frame, 0, sizeof(frame));
+        frame.len = 8U;
+        received = 0U;
+        t = bench_now();
+        while(received < sockFrames){
+            uint64_t burst = received + 256U;
+
+            while((sent < sockFrames) && (sent < burst)){
+                frame.can_id = (canid_t)(0x701U + (sent % 127U));
+                if(send(peer, &frame, sizeof(frame), 0) < 0){
+                    perror("send");
+                    return EXIT_FAILURE;
+                }
+                sent++;
+            }
+            if(CO_CANreceive(&CANmodule) < 0){
+                perror("CO_CANreceive");
+                return EXIT_FAILURE;
+            }
+        }
+        bench_report("socket, CO_CANreceive()", received, "frames", bench_now() - t);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,233 @@
+/*
+ * Stress test and benchmark for the receive thread and the receive ring.
+ *
+ * Threads are used as in main_socketcan.c with option -r:
+ *  - sender thread sends frames as fast as possible. Each frame carries a
+ *    sequence number and its complement, identifier is derived from the
+ *    sequence number.
+ *  - receive thread waits on the socket with epoll, stores frames into the
+ *    receive ring with CO_CANrxThreadReceive() and signals eventfd.
+ *  - main thread waits on eventfd and processes the ring with
+ *    CO_CANrxRingProcess(). Option -d slows it down, so ring overflows.
+ *
+ * Test fails, if any frame is torn (data or identifier don't match the
+ * sequence number), if frames are reordered or if number of processed
+ * and dropped frames doesn't match the number of sent frames (socket pair
+ * only, CAN interface may drop frames itself).
+ *
+ * Usage: bench_rxring [-n frames] [-d delay us per ring batch] [-i CAN interface]
+ *
+ * @file        bench_rxring.c
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include "CO_driver.h"
+#include "bench.h"
+
+
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[1];
+static CO_CANtx_t txArray[1];
+static int peer;
+static int rxEventfd;
+static uint32_t frames = 2000000U;
+static atomic_int senderDone;
+static atomic_int rxThreadStop;
+
+/* written by main thread only */
+static uint32_t processed;
+static uint32_t lastSeq;
+static uint32_t torn;
+static uint32_t reordered;
+
+
+/* Identifier of the frame with given sequence number, never 0 */
+static uint32_t seqIdent(uint32_t seq){
+    return (seq % 0x7FEU) + 1U;
+}
+
+
+/* Receive function, verifies the frame */
+static void rxFunct(void *object, const CO_CANrxMsg_t *msg){
+    uint32_t seq, inv;
+
+    (void)object;
+    memcpy(&seq, &msg->data[0], sizeof(seq));
+    memcpy(&inv, &msg->data[4], sizeof(inv));
+    if((inv != ~seq) || (msg->ident != seqIdent(seq)) || (msg->DLC != 8U)){
+        torn++;
+    }
+    if((processed != 0U) && (seq <= lastSeq)){
+        reordered++;
+    }
+    lastSeq = seq;
+    processed++;
+}
+
+
+/* Sender thread */
+static void *sender(void *arg){
+    CO_CANframe_t frame;
+    uint32_t seq;
+
+    (void)arg;
+    memset(&frame, 0, sizeof(frame));
+    frame.len = 8U;
+    for(seq=1U; seq<=frames; seq++){
+        uint32_t inv = ~seq;
+
+        frame.can_id = (canid_t)seqIdent(seq);
+        memcpy(&frame.data[0], &seq, sizeof(seq));
+        memcpy(&frame.data[4], &inv, sizeof(inv));
+        while(send(peer, &frame, sizeof(frame), 0) < 0){
+            /* CAN interface: transmit queue full */
+            usleep(100);
+        }
+    }
+    atomic_store(&senderDone, 1);
+
+    return NULL;
+}
+
+
+/* Receive thread, as rx_thread() in main_socketcan.c */
+static void *receiver(void *arg){
+    struct epoll_event ev;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    (void)arg;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &CANmodule;
+    if((epfd < 0) || (epoll_ctl(epfd, EPOLL_CTL_ADD, (int)CANmodule.CANbaseAddress, &ev) < 0)){
+        perror("epoll");
+        exit(EXIT_FAILURE);
+    }
+
+    while(!atomic_load_explicit(&rxThreadStop, memory_order_relaxed)){
+        if(epoll_wait(epfd, &ev, 1, 100) > 0){
+            int32_t r = CO_CANrxThreadReceive(&CANmodule);
+
+            if(r < 0){
+                perror("recvmmsg");
+            }
+            else if(r > 0){
+                uint64_t one = 1U;
+                if(write(rxEventfd, &one, sizeof(one)) < 0){
+                    perror("write eventfd");
+                }
+            }
+        }
+    }
+    close(epfd);
+
+    return NULL;
+}
+
+
+/******************************************************************************/
+int main(int argc, char *argv[]){
+    const char *ifName = NULL;
+    unsigned delay = 0U;
+    unsigned overflow;
+    pthread_t senderId, receiverId;
+    uint64_t t, idle = 0U;
+    int fd, opt, fail;
+
+    while((opt = getopt(argc, argv, "n:d:i:")) != -1){
+        switch(opt){
+            case 'n': frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': delay = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'i': ifName = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n frames] [-d delay us per ring batch] [-i CAN interface]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    fd = bench_CANsocket(ifName, &peer);
+    if((fd < 0) || (CO_CANmodule_init(&CANmodule, (uint16_t)fd, rxArray, 1U, txArray, 1U, 125U) != CO_ERROR_NO)){
+        fprintf(stderr, "CAN module initialization failed\n");
+        return EXIT_FAILURE;
+    }
+    /* all standard identifiers */
+    CO_CANrxBufferInit(&CANmodule, 0U, 0U, 0U, CO_false, &CANmodule, rxFunct);
+    CO_CANprocess(&CANmodule);
+    if((rxEventfd = eventfd(0, EFD_NONBLOCK)) < 0){
+        perror("eventfd");
+        return EXIT_FAILURE;
+    }
+
+    t = bench_now();
+    pthread_create(&receiverId, NULL, receiver, NULL);
+    pthread_create(&senderId, NULL, sender, NULL);
+
+    /* processing thread */
+    for(;;){
+        struct pollfd pfd = {rxEventfd, POLLIN, 0};
+        uint64_t count;
+
+        overflow = atomic_load_explicit(&CANmodule.rxStatistics.overflow, memory_order_relaxed);
+        if(atomic_load(&senderDone) && ((processed + overflow) >= frames)){
+            break;
+        }
+        if(poll(&pfd, 1, 10) <= 0){
+            /* CAN interface may lose frames, stop when idle */
+            if(atomic_load(&senderDone) && (++idle > 100U)){
+                break;
+            }
+            continue;
+        }
+        idle = 0U;
+        if(read(rxEventfd, &count, sizeof(count)) < 0){
+            continue;
+        }
+        if(delay != 0U){
+            usleep(delay);
+        }
+        CO_CANrxRingProcess(&CANmodule);
+    }
+    t = bench_now() - t;
+
+    atomic_store(&rxThreadStop, 1);
+    pthread_join(senderId, NULL);
+    pthread_join(receiverId, NULL);
+
+    overflow = atomic_load_explicit(&CANmodule.rxStatistics.overflow, memory_order_relaxed);
+    bench_report("receive thread, ring, eventfd", processed, "frames", t);
+    printf("sent=%u processed=%u ring overflow=%u torn=%u reordered=%u\n",
+           frames, processed, overflow, torn, reordered);
+
+    fail = (torn != 0U) || (reordered != 0U)
+        || ((ifName == NULL) && ((processed + overflow) != frames));
+
+    return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,455 @@
+/*
+ * Benchmark for SDO transfer of a large domain.
+ *
+ * Domain 2120,05 is configured as stream object with CO_OD_configureStream()
+ * and transferred by this program, which acts as SDO client on the other side
+ * of the bus. Domain is uploaded and downloaded with segmented and with block
+ * transfer. Each transfer is verified: data, size, CRC of block transfers and
+ * call of stream function pFunctFinished. Benchmark fails, if any of them
+ * doesn't match.
+ *
+ * SDO server is processed by CO_process_SDO(), each time client waits for a
+ * response. Block download uses sub-blocks as large as the SDO buffer
+ * allows, see CO_SDO_BUFFER_SIZE (make CO_SDO_BUFFER_SIZE=889 bench).
+ *
+ * Usage: bench_sdo [-n domain bytes] [-i CAN interface]
+ *
+ * @file        bench_sdo.c
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include "CANopen.h"
+#include "crc16-ccitt.h"
+#include "bench.h"
+
+#define DOMAIN_INDEX        0x2120U
+#define DOMAIN_SUBINDEX     5U
+#define BLKSIZE_UPLOAD      127U
+#define RESPONSE_TIMEOUT_NS 1000000000U
+
+static CO_t *node;             /* created by CO_initInstance() */
+static CO_config_t config;
+static int peer;
+static CO_SDO_stream_t stream;
+static uint32_t finished[2];    /* calls of pFunctFinished for upload, download */
+
+
+/* Stream function, called at the end of each transfer */
+static CO_SDO_abortCode_t streamFinished(void *object, CO_bool_t writing){
+    (void)object;
+    finished[writing ? 1 : 0]++;
+
+    return CO_SDO_AB_NONE;
+}
+
+
+/* Exit with error message */
+static void fail(const char *transfer, const char *error, uint32_t value){
+    fprintf(stderr, "%s: %s (0x%08X)\n", transfer, error, (unsigned)value);
+    exit(EXIT_FAILURE);
+}
+
+
+/* Process SDO server and pass its responses to the bus */
+static void serverProcess(void){
+    (void)CO_CANreceive(node->CANmodule[0]);
+    (void)CO_process_SDO(node);
+    (void)CO_CANtxFlush(node->CANmodule[0]);
+}
+
+
+/* Send SDO request (eight data bytes) to the server */
+static void clientSend(const uint8_t data[8]){
+    CO_CANframe_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = CO_CAN_ID_RSDO + config.nodeId;
+    frame.len = 8U;
+    memcpy(frame.data, data, 8U);
+    if(send(peer, &frame, sizeof(frame), 0) < 0){
+        perror("send");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/* Receive SDO response (eight data bytes), fail on timeout or abort */
+static void clientReceive(const char *transfer, uint8_t data[8]){
+    uint64_t start = bench_now();
+    CO_CANframe_t frame;
+
+    for(;;){
+        while(recv(peer, &frame, sizeof(frame), MSG_DONTWAIT) > 0){
+            if(frame.can_id == (canid_t)(CO_CAN_ID_TSDO + config.nodeId)){
+                memcpy(data, frame.data, 8U);
+                if(data[0] == 0x80U){
+                    fail(transfer, "SDO abort", CO_getUint32(&data[4]));
+                }
+                return;
+            }
+        }
+        if((bench_now() - start) > RESPONSE_TIMEOUT_NS){
+            fail(transfer, "no response from SDO server", 0U);
+        }
+        serverProcess();
+    }
+}
+
+
+/* Fill request with command specifier, index and sub-index */
+static void clientInitiate(uint8_t data[8], uint8_t command){
+    memset(data, 0, 8U);
+    data[0] = command;
+    data[1] = (uint8_t)DOMAIN_INDEX;
+    data[2] = (uint8_t)(DOMAIN_INDEX >> 8);
+    data[3] = DOMAIN_SUBINDEX;
+}
+
+
+/* Segmented SDO upload, returns size of data */
+static uint32_t segmentedUpload(uint8_t *buf, uint32_t bufSize){
+    const char *transfer = "segmented upload";
+    uint8_t data[8];
+    uint8_t toggle = 0U;
+    uint32_t size = 0U;
+
+    clientInitiate(data, 0x40U);
+    clientSend(data);
+    clientReceive(transfer, data);
+    if((data[0] & 0xE2U) != 0x40U){
+        fail(transfer, "wrong initiate response", data[0]);
+    }
+
+    for(;;){
+        uint32_t len;
+
+        memset(data, 0, 8U);
+        data[0] = 0x60U | toggle;
+        clientSend(data);
+        clientReceive(transfer, data);
+        if((data[0] & 0xF0U) != toggle){
+            fail(transfer, "wrong segment", data[0]);
+        }
+        len = 7U - ((data[0] >> 1) & 0x07U);
+        if((size + len) > bufSize){
+            fail(transfer, "data too long", size + len);
+        }
+        memcpy(&buf[size], &data[1], len);
+        size += len;
+        toggle ^= 0x10U;
+        if((data[0] & 0x01U) != 0U){
+            return size;
+        }
+    }
+}
+
+
+/* Segmented SDO download */
+static void segmentedDownload(const uint8_t *buf, uint32_t size){
+    const char *transfer = "segmented download";
+    uint8_t data[8];
+    uint8_t toggle = 0U;
+    uint32_t offset = 0U;
+
+    clientInitiate(data, 0x21U);
+    CO_setUint32(&data[4], size);
+    clientSend(data);
+    clientReceive(transfer, data);
+    if(data[0] != 0x60U){
+        fail(transfer, "wrong initiate response", data[0]);
+    }
+
+    while(offset < size){
+        uint32_t len = ((size - offset) > 7U) ? 7U : (size - offset);
+
+        memset(data, 0, 8U);
+        data[0] = toggle | (uint8_t)((7U - len) << 1);
+        if((offset + len) == size){
+            data[0] |= 0x01U;
+        }
+        memcpy(&data[1], &buf[offset], len);
+        offset += len;
+        clientSend(data);
+        clientReceive(transfer, data);
+        if(data[0] != (0x20U | toggle)){
+            fail(transfer, "wrong segment response", data[0]);
+        }
+        toggle ^= 0x10U;
+    }
+}
+
+
+/* SDO block upload with CRC, returns size of data */
+static uint32_t blockUpload(uint8_t *buf, uint32_t bufSize){
+    const char *transfer = "block upload";
+    uint8_t data[8];
+    uint32_t size = 0U;
+    uint16_t crc;
+
+    clientInitiate(data, 0xA4U);
+    data[4] = BLKSIZE_UPLOAD;
+    clientSend(data);
+    clientReceive(transfer, data);
+    if((data[0] & 0xF9U) != 0xC0U){
+        fail(transfer, "wrong initiate response", data[0]);
+    }
+    memset(data, 0, 8U);
+    data[0] = 0xA3U;
+    clientSend(data);
+
+    /* sub-blocks */
+    for(;;){
+        CO_bool_t last = CO_false;
+        uint8_t seqno = 0U;
+
+        while((seqno < BLKSIZE_UPLOAD) && !last){
+            clientReceive(transfer, data);
+            if((data[0] & 0x7FU) != (seqno + 1U)){
+                fail(transfer, "wrong sequence number", data[0]);
+            }
+            seqno++;
+            last = ((data[0] & 0x80U) != 0U) ? CO_true : CO_false;
+            if(size >= bufSize){
+                fail(transfer, "data too long", size + 7U);
+            }
+            memcpy(&buf[size], &data[1], 7U);
+            size += 7U;
+        }
+        memset(data, 0, 8U);
+        data[0] = 0xA2U;
+        data[1] = seqno;
+        data[2] = BLKSIZE_UPLOAD;
+        clientSend(data);
+        if(last){
+            break;
+        }
+    }
+
+    /* end, bytes in the last segment, which contain no data, and CRC */
+    clientReceive(transfer, data);
+    if((data[0] & 0xE3U) != 0xC1U){
+        fail(transfer, "wrong end response", data[0]);
+    }
+    size -= (data[0] >> 2) & 0x07U;
+    crc = crc16_ccitt(buf, size, 0U);
+    if(crc != CO_getUint16(&data[1])){
+        fail(transfer, "CRC mismatch", crc);
+    }
+    memset(data, 0, 8U);
+    data[0] = 0xA1U;
+    clientSend(data);
+    serverProcess();
+
+    return size;
+}
+
+
+/* SDO block download with CRC */
+static void blockDownload(const uint8_t *buf, uint32_t size){
+    const char *transfer = "block download";
+    uint8_t data[8];
+    uint32_t offset = 0U;
+    uint8_t blksize;
+    uint16_t crc;
+
+    clientInitiate(data, 0xC6U);
+    CO_setUint32(&data[4], size);
+    clientSend(data);
+    clientReceive(transfer, data);
+    if((data[0] & 0xFBU) != 0xA0U){
+        fail(transfer, "wrong initiate response", data[0]);
+    }
+    blksize = data[4];
+
+    /* sub-blocks */
+    while(offset < size){
+        uint8_t seqno = 0U;
+
+        while((seqno < blksize) && (offset < size)){
+            uint32_t len = ((size - offset) > 7U) ? 7U : (size - offset);
+
+            memset(data, 0, 8U);
+            seqno++;
+            data[0] = seqno;
+            memcpy(&data[1], &buf[offset], len);
+            offset += len;
+            if(offset == size){
+                data[0] |= 0x80U;
+            }
+            clientSend(data);
+        }
+        clientReceive(transfer, data);
+        if((data[0] != 0xA2U) || (data[1] != seqno)){
+            fail(transfer, "wrong sub-block response", CO_getUint16(&data[0]));
+        }
+        blksize = data[2];
+    }
+
+    /* end with CRC */
+    crc = crc16_ccitt(buf, size, 0U);
+    memset(data, 0, 8U);
+    data[0] = 0xC1U | (uint8_t)(((7U - (size % 7U)) % 7U) << 2);
+    CO_setUint16(&data[1], crc);
+    clientSend(data);
+    clientReceive(transfer, data);
+    if(data[0] != 0xA1U){
+        fail(transfer, "wrong end response", data[0]);
+    }
+}
+
+
+/* Verify uploaded or downloaded data and size */
+static void verify(const char *transfer, const uint8_t *a, const uint8_t *b,
+                   uint32_t sizeA, uint32_t sizeB, uint32_t finishedCount)
+{
+    if(sizeA != sizeB){
+        fail(transfer, "size mismatch", sizeA);
+    }
+    if(memcmp(a, b, sizeA) != 0){
+        fail(transfer, "data mismatch", 0U);
+    }
+    if(finishedCount != 1U){
+        fail(transfer, "transfer not finished by stream", finishedCount);
+    }
+}
+
+
+/******************************************************************************/
+int main(int argc, char *argv[]){
+    uint32_t size = 10U * 1024U * 1024U;
+    const char *ifName = NULL;
+    uint8_t *domain, *client, *source;
+    CO_CANframe_t frame;
+    uint32_t i, len;
+    uint64_t t;
+    int fd, opt, m;
+
+    while((opt = getopt(argc, argv, "n:i:")) != -1){
+        switch(opt){
+            case 'n': size = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': ifName = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n domain bytes] [-i CAN interface]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(size <= 4U){
+        fprintf(stderr, "Domain must be longer than four bytes\n");
+        return EXIT_FAILURE;
+    }
+
+    /* domain of the server, data of the client, one more segment for block upload */
+    domain = malloc(size);
+    client = malloc(size + 7U);
+    source = malloc(size);
+    if((domain == NULL) || (client == NULL) || (source == NULL)){
+        return EXIT_FAILURE;
+    }
+    for(i=0U; i<size; i++){
+        domain[i] = (uint8_t)(i * 7U + i / 251U);
+        source[i] = (uint8_t)(i * 13U + 5U);
+    }
+
+    fd = bench_CANsocket(ifName, &peer);
+    if(fd < 0){
+        return EXIT_FAILURE;
+    }
+    config.nodeId = 1U;
+    config.CANbitRate[0] = 1000U;
+    config.CANbaseAddress[0] = (uint16_t)fd;
+    /* other CAN modules get own sockets, which are not used by benchmark */
+    for(m=1; m<CO_NO_CAN_MODULES; m++){
+        int idlePeer;
+        int idle = bench_CANsocket(ifName, &idlePeer);
+
+        if(idle < 0){
+            return EXIT_FAILURE;
+        }
+        config.CANbitRate[m] = 1000U;
+        config.CANbaseAddress[m] = (uint16_t)idle;
+    }
+    if(CO_initInstance(&node, &config) != CO_ERROR_NO){
+        fprintf(stderr, "CANopen init failed\n");
+        return EXIT_FAILURE;
+    }
+    CO_CANsetNormalMode(config.CANbaseAddress[0]);
+    CO_CANprocess(node->CANmodule[0]);
+
+    /* bootup into pre-operational, discard bootup message */
+    (void)CO_process(node, 1U);
+    (void)CO_CANtxFlush(node->CANmodule[0]);
+    while(recv(peer, &frame, sizeof(frame), MSG_DONTWAIT) > 0){
+    }
+
+    stream.data = domain;
+    stream.size = size;
+    stream.capacity = size;
+    stream.pFunctFinished = streamFinished;
+    CO_OD_configureStream(node->SDO[0], DOMAIN_INDEX, DOMAIN_SUBINDEX, &stream);
+    printf("domain %u bytes, SDO buffer %u bytes\n", (unsigned)size, (unsigned)CO_SDO_BUFFER_SIZE);
+
+    /* uploads */
+    memset(finished, 0, sizeof(finished));
+    t = bench_now();
+    len = segmentedUpload(client, size);
+    t = bench_now() - t;
+    verify("segmented upload", client, domain, len, size, finished[0]);
+    bench_report("segmented upload", len, "bytes", t);
+
+    memset(finished, 0, sizeof(finished));
+    memset(client, 0, size);
+    t = bench_now();
+    len = blockUpload(client, size);
+    t = bench_now() - t;
+    verify("block upload", client, domain, len, size, finished[0]);
+    bench_report("block upload", len, "bytes", t);
+
+    /* downloads */
+    memset(finished, 0, sizeof(finished));
+    t = bench_now();
+    segmentedDownload(source, size);
+    t = bench_now() - t;
+    verify("segmented download", domain, source, stream.size, size, finished[1]);
+    bench_report("segmented download", size, "bytes", t);
+
+    memset(finished, 0, sizeof(finished));
+    memset(domain, 0, size);
+    stream.size = 0U;
+    t = bench_now();
+    blockDownload(source, size);
+    t = bench_now() - t;
+    verify("block download", domain, source, stream.size, size, finished[1]);
+    bench_report("block download", size, "bytes", t);
+
+    CO_OD_configureStream(node->SDO[0], DOMAIN_INDEX, DOMAIN_SUBINDEX, NULL);
+    CO_deleteInstance(&node);
+    free(domain);
+    free(client);
+    free(source);
+
+    return EXIT_SUCCESS;
+}
@@ -1,17 +1,22 @@
 #include "CANopen.h"
 #include "app_socketcan.h"
-#include <sys/poll.h>
-#include <sys/poll.h>
+#include <sys/epoll.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <getopt.h>
 #include <signal.h>
 #include <sys/signalfd.h>
 #include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdatomic.h>
 #include <string.h>
+#include <errno.h>
 #include <sched.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <net/if.h>
 #include <linux/can.h>
 #include <linux/can/raw.h>
 
@@ -20,11 +25,55 @@ typedef void (*sa_sigaction_t)(int, siginfo_t *, void *);
 #define TIMER_MS 1
 
 int debug = 0;
-const char *interface = "vcan0";
+const char *interfaces[CO_NO_CAN_MODULES];
 const char *progname = "";
 uint64_t tick = 0;
 int sighdlr = 1;
-int nfd = 3;
+int rxthread = 0;
+int nodes = 1;
+
+/* Additional CANopen devices, simulated in this process. Each has own
+ * sockets and own copy of RAM variables of Object dictionary. EEPROM and ROM
+ * variables (configuration) are shared by all nodes, so parameters written
+ * over SDO to one node apply to all of them. */
+typedef struct {
+    CO_t *CO;
+    int cansocket[CO_NO_CAN_MODULES];
+    CO_config_t config;
+    struct sCO_OD_RAM ODRAM;
+} vnode_t;
+
+static vnode_t *vnodes;
+
+/* Sources of epoll events, epoll_event.data.ptr points to one of them */
+typedef enum {
+    EV_TIMER,
+    EV_SIGNAL,
+    EV_RXRING,		// eventfd of receive thread
+    EV_CAN		// socket of CAN module
+} evtype_t;
+
+typedef struct {
+    evtype_t type;
+    int fd;
+    CO_t **CO;		// EV_CAN: CANopen device and
+    int module;		// index of its CAN module
+} evsrc_t;
+
+/* receive thread, see CO_CANrxThreadReceive() */
+static pthread_t rx_thread_id;
+static atomic_int rx_thread_stop;
+static int rx_eventfd = -1;
+
+/* SDO servers, which received request since they were processed, see
+ * sdo_signal(). Index 0 is CO, index i + 1 is vnodes[i]. */
+static uint8_t *sdo_pending;
+static int sdo_pending_any;
+
+/* TPDOs with transmission type 253, which received RTR, see rtr_signal().
+ * Indexed as sdo_pending. */
+static uint8_t *rtr_pending;
+static int rtr_pending_any;
 
 void /* interrupt */ CO_TimerInterruptHandler(void);
 
@@ -102,6 +151,259 @@ int setup_signals(const sa_sigaction_t handler, ...)
     return signalfd(-1, &sigmask, 0);
 }
 
+/* Receive thread reads CAN sockets into receive rings and wakes up the
+ * processing thread (main loop) through eventfd. It touches no other
+ * CANopen object, so slow processing doesn't cause dropped messages. */
+static void *rx_thread(void *arg)
+{
+    CO_t *co = arg;
+    struct epoll_event ev[CO_NO_CAN_MODULES];
+    int epfd, i, n;
+
+    if ((epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+	perror("epoll_create1");
+	return NULL;
+    }
+    for (i = 0; i < CO_NO_CAN_MODULES; i++) {
+	ev[i].events = EPOLLIN;
+	ev[i].data.ptr = co->CANmodule[i];
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, co->CANmodule[i]->CANbaseAddress, &ev[i]) < 0)
+	    perror("epoll_ctl");
+    }
+
+    while (!atomic_load_explicit(&rx_thread_stop, memory_order_relaxed)) {
+	int32_t received = 0;
+
+	// wake up periodically to check for stop request
+	n = epoll_wait(epfd, ev, CO_NO_CAN_MODULES, 100);
+	for (i = 0; i < n; i++) {
+	    int32_t r = CO_CANrxThreadReceive(ev[i].data.ptr);
+	    if (r < 0)
+		perror("recvmmsg");
+	    else
+		received += r;
+	}
+	if (received > 0) {
+	    uint64_t one = 1;
+	    if (write(rx_eventfd, &one, sizeof(one)) < 0)
+		perror("write eventfd");
+	}
+    }
+    close(epfd);
+    return NULL;
+}
+
+/* CO_SDO_t::pFunctSignal. Frames are received and passed to the CANopen
+ * objects in this thread, so node is only marked for process_sdo(). */
+static void sdo_signal(uint32_t arg)
+{
+    sdo_pending[arg] = 1;
+    sdo_pending_any = 1;
+}
+
+/* all SDO server channels of the node signal the same index */
+static void sdo_signal_init(CO_t *co, int idx)
+{
+    int i;
+
+    for (i = 0; i < CO_NO_SDO_SERVER; i++) {
+	co->SDO[i]->pFunctSignal = sdo_signal;
+	co->SDO[i]->functArg = (uint32_t)idx;
+    }
+}
+
+/* Process SDO servers of one node. Sub-block of block upload is sent as
+ * the transmit queue of SDO server gets free space, so node stays pending
+ * and continues on next wakeup (transmit confirmation or timer). */
+static void process_sdo_node(CO_t *co, int idx)
+{
+    int i;
+
+    sdo_pending[idx] = 0;
+    CO_process_SDO(co);
+    for (i = 0; i < CO_NO_SDO_SERVER; i++) {
+	if (co->SDO[i]->state == CO_SDO_ST_UPLOAD_BL_SUBBLOCK)
+	    sdo_signal((uint32_t)idx);
+    }
+}
+
+/* advance SDO servers with new request immediately, so transfer is not
+ * limited by timer tick. Timeouts are still processed by process_tick(). */
+static void process_sdo(void)
+{
+    int i;
+
+    if (!sdo_pending_any)
+	return;
+    sdo_pending_any = 0;
+    if (sdo_pending[0])
+	process_sdo_node(CO, 0);
+    for (i = 0; i < nodes - 1; i++) {
+	if (sdo_pending[i + 1])
+	    process_sdo_node(vnodes[i].CO, i + 1);
+    }
+}
+
+/* CO_TPDO_t::pFunctSignal, node is marked for process_rtr() */
+static void rtr_signal(uint32_t arg)
+{
+    rtr_pending[arg] = 1;
+    rtr_pending_any = 1;
+}
+
+static void rtr_signal_init(CO_t *co, int idx)
+{
+    int i;
+
+    for (i = 0; i < CO_NO_TPDO; i++) {
+	co->TPDO[i]->pFunctSignal = rtr_signal;
+	co->TPDO[i]->functArg = (uint32_t)idx;
+    }
+}
+
+/* answer Remote Transmission Requests right after reception, not on
+ * next timer tick */
+static void process_rtr(void)
+{
+    int i;
+
+    if (!rtr_pending_any)
+	return;
+    rtr_pending_any = 0;
+    if (rtr_pending[0]) {
+	rtr_pending[0] = 0;
+	CO_process_TPDO_RTR(CO);
+    }
+    for (i = 0; i < nodes - 1; i++) {
+	if (rtr_pending[i + 1]) {
+	    rtr_pending[i + 1] = 0;
+	    CO_process_TPDO_RTR(vnodes[i].CO);
+	}
+    }
+}
+
+// rx statistics are written by the receive thread
+#define RXSTAT(stat, name) atomic_load_explicit(&(stat)->name, memory_order_relaxed)
+
+static void print_statistics(const char *ifname, const CO_CANmodule_t *CANmodule)
+{
+    const CO_CANrxStatistics_t *stat = &CANmodule->rxStatistics;
+    const CO_CANtxStatistics_t *txstat = &CANmodule->txStatistics;
+    unsigned i, frames = RXSTAT(stat, frames), calls = RXSTAT(stat, calls);
+
+    fprintf(stderr, "%s: %s: rx frames=%u calls=%u avg batch=%.2f max batch=%u errors=%u overflow=%u\n",
+	    progname, ifname, frames, calls,
+	    calls ? (double)frames / calls : 0.0,
+	    RXSTAT(stat, batchMax), RXSTAT(stat, errors), RXSTAT(stat, overflow));
+    fprintf(stderr, "%s: %s: rx batch histogram:", progname, ifname);
+    for (i = 0; i < CO_CAN_RX_HIST_SIZE; i++)
+	fprintf(stderr, " %u+:%u", 1U << i, RXSTAT(stat, batchHist[i]));
+    fprintf(stderr, "\n");
+    fprintf(stderr, "%s: %s: tx frames=%u calls=%u confirmed=%u queued=%u backpressure=%u errors=%u\n",
+	    progname, ifname, txstat->frames, txstat->calls, txstat->confirmed,
+	    CANmodule->CANtxCount, txstat->backpressure, txstat->errors);
+}
+
+static void print_vnode_statistics(void)
+{
+    uint32_t rx = 0, tx = 0;
+    int i, m;
+
+    for (i = 0; i < nodes - 1; i++) {
+	for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+	    rx += RXSTAT(&vnodes[i].CO->CANmodule[m]->rxStatistics, frames);
+	    tx += vnodes[i].CO->CANmodule[m]->txStatistics.frames;
+	}
+    }
+    fprintf(stderr, "%s: %d virtual nodes, memory per node=%u bytes, rx frames=%u tx frames=%u\n",
+	    progname, nodes - 1,
+	    (unsigned)(vnodes[0].CO->memoryUsed + sizeof(vnodes[0].ODRAM)),
+	    rx, tx);
+}
+
+/* (re)initialize virtual node, it starts in communication reset */
+static int vnode_init(vnode_t *vn)
+{
+    int m;
+    CO_ReturnError_t err = CO_initInstance(&vn->CO, &vn->config);
+    if (err != CO_ERROR_NO) {
+	LOG("CANopen init of node %d failed: %d", vn->config.nodeId, err);
+	return -1;
+    }
+    sdo_signal_init(vn->CO, (int)(vn - vnodes) + 1);
+    rtr_signal_init(vn->CO, (int)(vn - vnodes) + 1);
+    for (m = 0; m < CO_NO_CAN_MODULES; m++)
+	CO_CANsetNormalMode(vn->config.CANbaseAddress[m]);
+    return 0;
+}
+
+static int add_source(int epfd, evsrc_t *src)
+{
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = src;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, src->fd, &ev) < 0) {
+	perror("epoll_ctl");
+	return -1;
+    }
+    return 0;
+}
+
+static void print_all_statistics(void)
+{
+    int m;
+
+    for (m = 0; m < CO_NO_CAN_MODULES; m++)
+	print_statistics(interfaces[m], CO->CANmodule[m]);
+    if (nodes > 1)
+	print_vnode_statistics();
+}
+
+/* timer expired, run CANopen processing of all nodes */
+static void process_tick(uint16_t timer1msDiff, CO_NMT_reset_cmd_t *reset)
+{
+    int i;
+
+    /* Application interface */
+    programAsync(timer1msDiff);
+    /* CANopen process */
+    *reset = CO_process(CO, timer1msDiff);
+    /* Process EEPROM */
+
+    /* 1 ms task, PDOs */
+    CO_TimerInterruptHandler();
+
+    /* virtual nodes are reset on any reset command */
+    for (i = 0; i < nodes - 1; i++) {
+	vnode_t *vn = &vnodes[i];
+	if (CO_process(vn->CO, timer1msDiff) != CO_RESET_NOT) {
+	    if (vnode_init(vn) < 0)
+		exit(1);
+	    continue;
+	}
+	CO_process_RPDO(vn->CO);
+	CO_process_TPDO(vn->CO);
+    }
+}
+
+static void process_signal(int fd, CO_NMT_reset_cmd_t *reset)
+{
+    struct signalfd_siginfo fdsi;
+
+    if (read(fd, &fdsi, sizeof(fdsi)) != sizeof(fdsi)) {
+	perror("read signalfd");
+	return;
+    }
+    if (fdsi.ssi_signo == SIGUSR1) {
+	print_all_statistics();
+	return;
+    }
+    LOG("signal %d - '%s' received",
+	fdsi.ssi_signo, strsignal(fdsi.ssi_signo));
+    *reset = CO_RESET_APP;
+}
+
 void  dumpframe(const char *tag, const CO_CANrxMsg_t *cf)
 {
     int i;
@@ -111,27 +413,36 @@ void  dumpframe(const char *tag, const CO_CANrxMsg_t *cf)
     fprintf(stderr, "\n");
 }
 
-static const char *option_string = "dG";
+static const char *option_string = "dGTn:";
 static struct option long_options[] = {
     {"debug", no_argument, 0, 'd'},
     {"nosighdlr",   no_argument,    0, 'G'},
+    {"rxthread",    no_argument,    0, 'T'},
+    {"nodes",       required_argument, 0, 'n'},
     {0,0,0,0}
 };
 
 static void usage(const char *name)
 {
-    printf("Usage:  %s [options]\n", name);
+    printf("Usage:  %s [options] [interface ...]\n", name);
+    printf("Up to %d CAN interfaces, default vcan0, vcan1, ...\n", CO_NO_CAN_MODULES);
     printf("Options are:\n"
 	   "-d or --debug\n"
 	   "    log to stderr"
 	   "-G or --nosighdlr\n"
-	   "    do not set up signal handlers (for debugging under gdb)\n");
+	   "    do not set up signal handlers (for debugging under gdb)\n"
+	   "-T or --rxthread\n"
+	   "    receive CAN messages in separate thread\n"
+	   "-n <count> or --nodes <count>\n"
+	   "    run <count> CANopen nodes with consecutive node-IDs\n");
 }
 
 int main (const int argc, char **argv)
 {
-    struct pollfd pfd[3];
-    int cansocket, retval, opt, signal_fd, timer_fd;
+    struct epoll_event *events;
+    evsrc_t *sources;
+    int nsrc = 0, epfd, retval, opt, signal_fd, timer_fd, i, m;
+    char defaultif[CO_NO_CAN_MODULES][IFNAMSIZ];
     progname = argv[0];
     while ((opt = getopt_long(argc, argv, option_string,
 			      long_options, NULL)) != -1) {
@@ -141,13 +452,30 @@ int main (const int argc, char **argv)
 	    break;
 	case 'G':
 	    sighdlr = 0;
-	    nfd = 2;
+	    break;
+	case 'T':
+	    rxthread = 1;
+	    break;
+	case 'n':
+	    nodes = atoi(optarg);
 	    break;
 	default:
 	    usage(progname);
 	    exit(0);
 	}
     }
+    if (argc - optind > CO_NO_CAN_MODULES) {
+	usage(progname);
+	exit(1);
+    }
+    for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+	if (optind + m < argc) {
+	    interfaces[m] = argv[optind + m];
+	} else {
+	    snprintf(defaultif[m], IFNAMSIZ, "vcan%d", m);
+	    interfaces[m] = defaultif[m];
+	}
+    }
 
     CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
 
@@ -158,21 +486,94 @@ int main (const int argc, char **argv)
     /* initialize EEPROM */
 
     /* Application interface */
-    if ((cansocket = programStart(interface)) < 0)
+    for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+	if ((CO_CANsocket[m] = programStart(interfaces[m])) < 0)
+	    exit(1);
+    }
+
+    if (nodes < 1 || OD_CANNodeID + nodes - 1 > 127) {
+	LOG("invalid number of nodes: %d", nodes);
 	exit(1);
+    }
 
-    timer_fd = get_timerfd(milliseconds);
+    // all file descriptors are multiplexed by one epoll instance
+    if ((epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+	perror("epoll_create1");
+	exit(1);
+    }
+    sources = calloc(3 + nodes * CO_NO_CAN_MODULES, sizeof(*sources));
+    events = calloc(3 + nodes * CO_NO_CAN_MODULES, sizeof(*events));
+
+    sdo_pending = calloc(nodes, sizeof(*sdo_pending));
+    rtr_pending = calloc(nodes, sizeof(*rtr_pending));
+    if (nodes > 1)
+	vnodes = calloc(nodes - 1, sizeof(*vnodes));
+    for (i = 0; i < nodes - 1; i++) {
+	vnode_t *vn = &vnodes[i];
+
+	vn->config.nodeId = OD_CANNodeID + i + 1;
+	for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+	    if ((vn->cansocket[m] = programStart(interfaces[m])) < 0)
+		exit(1);
+	    vn->config.CANbitRate[m] = OD_CANBitRate;
+	    vn->config.CANbaseAddress[m] = vn->cansocket[m];
+	}
+#if CO_NO_CAN_MODULES >= 2
+	// same as CO_init()
+	for (m = 4; m < CO_NO_RPDO; m++)
+	    vn->config.RPDOCANmodule[m] = 1;
+#endif
+	// EEPROM and ROM images are shared (NULL)
+	vn->config.ODRAM = &vn->ODRAM;
+	if (vnode_init(vn) < 0)
+	    exit(1);
+	for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+	    evsrc_t *src = &sources[nsrc++];
+	    src->type = EV_CAN;
+	    src->fd = vn->cansocket[m];
+	    src->CO = &vn->CO;
+	    src->module = m;
+	    if (add_source(epfd, src) < 0)
+		exit(1);
+	}
+    }
+    if (debug && nodes > 1)
+	print_vnode_statistics();
 
-    pfd[0].fd = cansocket;
-    pfd[0].events = POLLIN;
+    if (rxthread) {
+	// sockets are read by receive thread, which signals through eventfd
+	if ((rx_eventfd = eventfd(0, EFD_NONBLOCK)) < 0) {
+	    perror("eventfd");
+	    exit(1);
+	}
+	sources[nsrc].type = EV_RXRING;
+	sources[nsrc].fd = rx_eventfd;
+	if (add_source(epfd, &sources[nsrc++]) < 0)
+	    exit(1);
+    } else {
+	for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+	    evsrc_t *src = &sources[nsrc++];
+	    src->type = EV_CAN;
+	    src->fd = CO_CANsocket[m];
+	    src->CO = &CO;
+	    src->module = m;
+	    if (add_source(epfd, src) < 0)
+		exit(1);
+	}
+    }
 
-    pfd[1].fd = timer_fd;
-    pfd[1].events = POLLIN;
+    timer_fd = get_timerfd(milliseconds);
+    sources[nsrc].type = EV_TIMER;
+    sources[nsrc].fd = timer_fd;
+    if (add_source(epfd, &sources[nsrc++]) < 0)
+	exit(1);
 
     if (sighdlr) {
-	signal_fd = setup_signals(sigaction_handler, SIGINT, SIGQUIT, SIGKILL, SIGTERM, -1);
-	pfd[2].fd = signal_fd;
-	pfd[2].events = POLLIN;
+	signal_fd = setup_signals(sigaction_handler, SIGINT, SIGQUIT, SIGKILL, SIGTERM, SIGUSR1, -1);
+	sources[nsrc].type = EV_SIGNAL;
+	sources[nsrc].fd = signal_fd;
+	if (add_source(epfd, &sources[nsrc++]) < 0)
+	    exit(1);
     }
 
     /* increase variable each startup. Variable is stored in EEPROM. */
@@ -196,68 +597,79 @@ int main (const int argc, char **argv)
         /* initialize variables */
 
         reset = CO_RESET_NOT;
+        /* SDO server is processed on reception of request, see process_sdo() */
+        sdo_signal_init(CO, 0);
+        /* TPDO is sent on reception of RTR, see process_rtr() */
+        rtr_signal_init(CO, 0);
         /* Configure Timer interrupt function for execution every 1 millisecond */
         /* Configure CAN transmit and receive interrupt */
         /* Application interface */
         communicationReset();
         /* start CAN and enable interrupts */
-        CO_CANsetNormalMode(ADDR_CAN1);
+        for (m = 0; m < CO_NO_CAN_MODULES; m++)
+	    CO_CANsetNormalMode(CO->CANmodule[m]->CANbaseAddress);
+        if (rxthread) {
+	    atomic_store(&rx_thread_stop, 0);
+	    retval = pthread_create(&rx_thread_id, NULL, rx_thread, CO);
+	    if (retval != 0) {
+		LOG("pthread_create: %s", strerror(retval));
+		exit(1);
+	    }
+        }
 
         while (reset == CO_RESET_NOT) {
 
-	    retval = poll(pfd, nfd, -1);
-	    if (!retval)
+	    retval = epoll_wait(epfd, events, nsrc, -1);
+	    if (retval < 0) {
+		if (errno != EINTR)
+		    perror("epoll_wait");
 		continue;
+	    }
 
-	    // LOG("poll: %d", retval);
+	    for (i = 0; i < retval; i++) {
+		evsrc_t *src = events[i].data.ptr;
+		uint64_t count = 0;
+
+		switch (src->type) {
+		case EV_TIMER:
+		    if (read(src->fd, &count, sizeof(count)) < 0) {
+			perror("read timerfd:");
+			break;
+		    }
+		    tick += count;
+		    process_tick((uint16_t) count, &reset);
+		    break;
 
-	    if (pfd[1].revents & POLLIN) {
-		// LOG("tick");
-		// a timer event is pending
-		uint64_t expirations = 0;
-		int res = read(pfd[1].fd, &expirations, sizeof(expirations));
-		if(res < 0) {
-		    perror("read timerfd:");
+		case EV_SIGNAL:
+		    process_signal(src->fd, &reset);
 		    break;
-		}
-		tick += expirations;
-		uint16_t timer1msDiff = (uint16_t) expirations;
-
-		/* Application interface */
-		programAsync(timer1msDiff);
-		/* CANopen process */
-		reset = CO_process(CO, timer1msDiff);
-		/* Process EEPROM */
-	    }
 
-	    if (sighdlr && (pfd[2].revents & POLLIN)) {
-		// a signal is pending
-		struct signalfd_siginfo fdsi;
-		ssize_t s;
+		case EV_RXRING:
+		    // receive thread stored frames into rings
+		    if (read(src->fd, &count, sizeof(count)) < 0)
+			perror("read eventfd");
+		    for (m = 0; m < CO_NO_CAN_MODULES; m++)
+			CO_CANrxRingProcess(CO->CANmodule[m]);
+		    break;
 
-		s = read(pfd[2].fd, &fdsi, sizeof(struct signalfd_siginfo));
-		if (s != sizeof(struct signalfd_siginfo)) {
-		    perror("read signalfd");
-		}
-		switch (fdsi.ssi_signo) {
-		default:
-		    LOG("signal %d - '%s' received",
-			fdsi.ssi_signo,strsignal(fdsi.ssi_signo));
+		case EV_CAN:
+		    // frames are pending, read a batch of them
+		    if (CO_CANreceive((*src->CO)->CANmodule[src->module]) < 0)
+			perror("recvmmsg");
+		    break;
 		}
-		reset = CO_RESET_APP;
-		continue;
 	    }
 
-	    if (pfd[0].revents & POLLIN) {
-		// a socket frame is pending
-		CO_CANrxMsg_t inframe;
-		size_t fs = read(pfd[0].fd, &inframe, sizeof(inframe));
-		if(fs && debug)
-		    dumpframe("received: ", &inframe);
+	    process_sdo();
+	    process_rtr();
 
-		CO_CANProcessRxFrame(CO->CANmodule[0], &inframe);
+	    /* update kernel filters and pass messages, produced in this cycle,
+	     * to the kernel, one batch per CAN interface */
+	    for (m = 0; m < CO_NO_CAN_MODULES; m++) {
+		CO_CANprocess(CO->CANmodule[m]);
+		for (i = 0; i < nodes - 1; i++)
+		    CO_CANprocess(vnodes[i].CO->CANmodule[m]);
 	    }
-	    // CO_TimerInterruptHandler();
 
 	    /* loop for normal program execution */
             // uint16_t timer1msDiff = timestamp_ms() - timer1msPrevious;
@@ -273,13 +685,33 @@ int main (const int argc, char **argv)
             /* reset = CO_process(CO, timer1msDiff); */
             /* Process EEPROM */
         }
+
+        /* stop receive thread before CANopen objects are initialized again */
+        if (rxthread) {
+	    atomic_store(&rx_thread_stop, 1);
+	    pthread_join(rx_thread_id, NULL);
+        }
     }
 
 
     /* program exit ***************************************************************/
     CO_DISABLE_INTERRUPTS();
+    if (debug)
+	print_all_statistics();
+    for (i = 0; i < nodes - 1; i++) {
+	CO_deleteInstance(&vnodes[i].CO);
+	for (m = 0; m < CO_NO_CAN_MODULES; m++)
+	    close(vnodes[i].cansocket[m]);
+    }
+    free(vnodes);
+    free(sdo_pending);
+    free(rtr_pending);
+    free(sources);
+    free(events);
+    close(epfd);
     /* Application interface */
-    programEnd(cansocket);
+    for (m = 0; m < CO_NO_CAN_MODULES; m++)
+	programEnd(CO_CANsocket[m]);
     /* delete objects from memory */
     CO_delete();
     /* reset */